@@ -0,0 +1,65 @@
+/*****************************************************************************\
+ *                                                                           *\
+ *  This file is part of the Verificarlo project,                            *\
+ *  under the Apache License v2.0 with LLVM Exceptions.                      *\
+ *  SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception.                 *\
+ *  See https://llvm.org/LICENSE.txt for license information.                *\
+ *                                                                           *\
+ *  Copyright (c) 2019-2023                                                  *\
+ *     Verificarlo Contributors                                              *\
+ *                                                                           *\
+ ****************************************************************************/
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "call_sites.h"
+
+__thread const void *ieee_site_caller
+    __attribute__((tls_model("initial-exec"))) = NULL;
+
+ieee_site_t *ieee_site_lookup(ieee_site_table_t *table, uint64_t key) {
+  /* Fibonacci hashing, the low bits of addresses are poorly distributed */
+  const uint64_t hash = (key * 0x9e3779b97f4a7c15ULL) >> 52;
+  for (unsigned i = 0; i < IEEE_SITES_MAX; i++) {
+    ieee_site_t *site = &table->sites[(hash + i) % IEEE_SITES_MAX];
+    uint64_t current = __atomic_load_n(&site->key, __ATOMIC_ACQUIRE);
+    if (current == key)
+      return site;
+    if (current == 0) {
+      if (__atomic_compare_exchange_n(&site->key, &current, key, false,
+                                      __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE) ||
+          current == key)
+        return site;
+    }
+  }
+  return &table->overflow;
+}
+
+static int compare_sites(const void *a, const void *b) {
+  const uint64_t na = (*(ieee_site_t *const *)a)->counters[0];
+  const uint64_t nb = (*(ieee_site_t *const *)b)->counters[0];
+  return (na < nb) - (na > nb);
+}
+
+size_t ieee_site_sort(ieee_site_table_t *table, ieee_site_t **sites) {
+  size_t n = 0;
+  for (unsigned i = 0; i < IEEE_SITES_MAX; i++) {
+    /* entries reset by ieee_site_reset keep their key */
+    if (__atomic_load_n(&table->sites[i].key, __ATOMIC_ACQUIRE) != 0 &&
+        __atomic_load_n(&table->sites[i].counters[0], __ATOMIC_RELAXED) != 0)
+      sites[n++] = &table->sites[i];
+  }
+  if (table->overflow.counters[0] != 0)
+    sites[n++] = &table->overflow;
+  qsort(sites, n, sizeof(*sites), compare_sites);
+  return n;
+}
+
+void ieee_site_reset(ieee_site_table_t *table) {
+  for (unsigned i = 0; i <= IEEE_SITES_MAX; i++) {
+    ieee_site_t *site =
+        (i < IEEE_SITES_MAX) ? &table->sites[i] : &table->overflow;
+    for (int c = 0; c < IEEE_SITE_COUNTERS; c++)
+      __atomic_store_n(&site->counters[c], 0, __ATOMIC_RELAXED);
+  }
+}
@@ -0,0 +1,112 @@
+/*****************************************************************************\
+ *                                                                           *\
+ *  This file is part of the Verificarlo project,                            *\
+ *  under the Apache License v2.0 with LLVM Exceptions.                      *\
+ *  SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception.                 *\
+ *  See https://llvm.org/LICENSE.txt for license information.                *\
+ *                                                                           *\
+ *  Copyright (c) 2019-2023                                                  *\
+ *     Verificarlo Contributors                                              *\
+ *                                                                           *\
+ ****************************************************************************/
+#ifndef __CALL_SITES_H__
+#define __CALL_SITES_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Per call site counters of the profiling options                          */
+/* A table maps a call site, the address the backend entry point returns  */
+/* to, and an operation to IEEE_SITE_COUNTERS counters whose meaning is    */
+/* up to the option using the table. Entries are inserted lock-free with a */
+/* compare-and-swap on the key and counters are updated with relaxed      */
+/* atomic adds, so any thread can update any entry. Entries are never      */
+/* removed; once the table is full, new sites share the overflow entry.  */
+
+#define IEEE_SITES_MAX 4096
+#define IEEE_SITE_COUNTERS 8
+
+typedef struct {
+  uint64_t key; /* ieee_site_key, 0 for a free entry */
+  uint64_t counters[IEEE_SITE_COUNTERS];
+} ieee_site_t;
+
+typedef struct ieee_site_table {
+  ieee_site_t sites[IEEE_SITES_MAX];
+  ieee_site_t overflow; /* sites not in the table, key 0 */
+} ieee_site_table_t;
+
+/* Counters of the call site table of --vector-coverage */
+typedef enum {
+  IEEE_COVERAGE_OPS = 0, /* operations, i.e. lanes */
+  IEEE_COVERAGE_SCALAR,  /* calls of the scalar entry points */
+  IEEE_COVERAGE_VECTOR_1, /* calls of the vbackend kernels of 1 to 16 lanes */
+  IEEE_COVERAGE_VECTOR_4,
+  IEEE_COVERAGE_VECTOR_8,
+  IEEE_COVERAGE_VECTOR_16,
+} ieee_coverage_counter_t;
+
+/* Counters of the call site table of --subnormal-profile */
+typedef enum {
+  IEEE_SUBNORMAL_OPS = 0, /* operations, i.e. lanes, with a subnormal */
+  IEEE_SUBNORMAL_INPUTS,  /* ... operand */
+  IEEE_SUBNORMAL_OUTPUTS, /* ... result */
+  IEEE_SUBNORMAL_CALLS,   /* calls with a subnormal operand or result */
+  IEEE_SUBNORMAL_SAMPLES, /* replays of those calls */
+  IEEE_SUBNORMAL_CYCLES,  /* cycles of the replays with the operands */
+  IEEE_SUBNORMAL_REFERENCE_CYCLES, /* ... with normal operands */
+} ieee_subnormal_counter_t;
+
+/* Call site of the wrapper running the entry point, set by the wrappers  */
+/* which do not tail-call it (--overhead-profile), NULL otherwise         */
+extern __thread const void *ieee_site_caller
+    __attribute__((tls_model("initial-exec")));
+
+static inline const void *ieee_call_site(const void *return_address) {
+  const void *caller = ieee_site_caller;
+  return (caller != NULL) ? caller : return_address;
+}
+
+/* Return address of the running backend entry point, to be used in the  */
+/* entry point itself and not in a helper which may not be inlined        */
+#define IEEE_RETURN_ADDRESS()                                                  \
+  __builtin_extract_return_addr(__builtin_return_address(0))
+
+/* Call site of the running backend entry point, same restriction */
+#define IEEE_CALL_SITE() ieee_call_site(IEEE_RETURN_ADDRESS())
+
+/* Key of operation <opcode> (ieee_trace_opcode_t) in <precision>          */
+/* (ieee_trace_precision_t) at <site>. User space addresses fit 56 bits.   */
+static inline uint64_t ieee_site_key(const void *site, unsigned opcode,
+                                     unsigned precision) {
+  return ((uint64_t)(uintptr_t)site << 8) | (opcode << 1) | precision;
+}
+
+static inline void *ieee_site_address(uint64_t key) {
+  return (void *)(uintptr_t)(key >> 8);
+}
+
+static inline unsigned ieee_site_opcode(uint64_t key) {
+  return (key & 0xff) >> 1;
+}
+
+static inline unsigned ieee_site_precision(uint64_t key) { return key & 1; }
+
+/* Returns the entry of <key>, inserting it if needed, the overflow entry */
+/* if the table is full                                                   */
+ieee_site_t *ieee_site_lookup(ieee_site_table_t *table, uint64_t key);
+
+static inline void ieee_site_add(ieee_site_t *site, unsigned counter,
+                                 uint64_t value) {
+  __atomic_add_fetch(&site->counters[counter], value, __ATOMIC_RELAXED);
+}
+
+/* Fills <sites> with the entries in use, by decreasing counter 0, and    */
+/* returns their number. <sites> holds IEEE_SITES_MAX + 1 pointers, the   */
+/* overflow entry is included if it was used                              */
+size_t ieee_site_sort(ieee_site_table_t *table, ieee_site_t **sites);
+/* Zeroes the counters of every entry, the entries stay in the table. */
+/* Updates running concurrently may be lost or kept                   */
+void ieee_site_reset(ieee_site_table_t *table);
+
+#endif /* __CALL_SITES_H__ */
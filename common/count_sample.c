@@ -0,0 +1,127 @@
+/*****************************************************************************\
+ *                                                                           *\
+ *  This file is part of the Verificarlo project,                            *\
+ *  under the Apache License v2.0 with LLVM Exceptions.                      *\
+ *  SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception.                 *\
+ *  See https://llvm.org/LICENSE.txt for license information.                *\
+ *                                                                           *\
+ *  Copyright (c) 2019-2023                                                  *\
+ *     Verificarlo Contributors                                              *\
+ *                                                                           *\
+ ****************************************************************************/
+#include <string.h>
+
+#include "count_sample.h"
+
+__thread uint32_t ieee_count_sample_countdown
+    __attribute__((tls_model("initial-exec"))) = 0;
+
+/* State of the generator of the thread, 0 before its seeding */
+static __thread uint64_t ieee_count_sample_state
+    __attribute__((tls_model("initial-exec"))) = 0;
+
+/* Seeds of the threads, so that two threads draw different gaps */
+static uint64_t ieee_count_sample_seed = 0;
+
+/* log(1 - 1/period), 0 when every operation is counted. Loaded and */
+/* stored atomically, --live-config may change the period           */
+static double ieee_count_sample_log_q = 0;
+
+#define LN2 0.693147180559945309417232121458176568
+#define SQRT2 1.41421356237309504880168872420969808
+
+/* Natural logarithm of a positive normal <x>. The gaps need no more    */
+/* than a few digits, so a short series replaces the libm call per gap */
+static double _count_sample_log(double x) {
+  uint64_t bits;
+  memcpy(&bits, &x, sizeof(bits));
+  int exponent = (int)((bits >> 52) & 0x7ff) - 1023;
+  bits = (bits & 0xfffffffffffffULL) | 0x3ff0000000000000ULL;
+  double m;
+  memcpy(&m, &bits, sizeof(m));
+  if (m > SQRT2) {
+    m /= 2;
+    exponent++;
+  }
+  /* log(m) = 2 atanh(s), |s| < 0.172 */
+  const double s = (m - 1) / (m + 1);
+  const double s2 = s * s;
+  double sum = 0, power = s;
+  for (int k = 1; k < 20; k += 2) {
+    sum += power / k;
+    power *= s2;
+  }
+  return 2 * sum + exponent * LN2;
+}
+
+/* Square root of <x> >= 0 by Newton's method, for the reports */
+static double _count_sample_sqrt(double x) {
+  if (x <= 0)
+    return 0;
+  double y = x > 1 ? x : 1;
+  for (int i = 0; i < 2048; i++) {
+    const double next = (y + x / y) / 2;
+    if (next >= y)
+      break;
+    y = next;
+  }
+  return y;
+}
+
+/* xorshift64* generator of the thread */
+static uint64_t _count_sample_random(void) {
+  uint64_t x = ieee_count_sample_state;
+  if (x == 0) {
+    /* splitmix64 of the sequence of the threads */
+    x = __atomic_add_fetch(&ieee_count_sample_seed, 0x9e3779b97f4a7c15ULL,
+                           __ATOMIC_RELAXED);
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    if (x == 0)
+      x = 1;
+  }
+  x ^= x >> 12;
+  x ^= x << 25;
+  x ^= x >> 27;
+  ieee_count_sample_state = x;
+  return x * 0x2545f4914f6cdd1dULL;
+}
+
+/* Gap to the next counted operation, geometric of mean the period */
+static uint32_t _count_sample_gap(void) {
+  double log_q;
+  __atomic_load(&ieee_count_sample_log_q, &log_q, __ATOMIC_RELAXED);
+  if (log_q == 0)
+    return 1;
+  /* u uniform in (0, 1] */
+  const double u = ((_count_sample_random() >> 11) + 1) * 0x1p-53;
+  const double gap = 1 + _count_sample_log(u) / log_q;
+  return gap < UINT32_MAX ? (uint32_t)gap : UINT32_MAX;
+}
+
+void ieee_count_sample_start(uint64_t period) {
+  double log_q = period > 1 ? _count_sample_log(1 - 1.0 / period) : 0;
+  __atomic_store(&ieee_count_sample_log_q, &log_q, __ATOMIC_RELAXED);
+}
+
+bool ieee_count_sample_next(void) {
+  if (ieee_count_sample_countdown == 0) {
+    /* First operation of the thread, the gap is counted from it */
+    const uint32_t gap = _count_sample_gap();
+    if (gap > 1) {
+      ieee_count_sample_countdown = gap - 1;
+      return false;
+    }
+  }
+  ieee_count_sample_countdown = _count_sample_gap();
+  return true;
+}
+
+uint64_t ieee_count_sample_interval(uint64_t count, uint64_t period) {
+  /* The samples s are binomial of probability p = 1/period, the estimate */
+  /* s / p has the variance s (1 - p) / p^2 = s period (period - 1)        */
+  const double samples = (double)count / period;
+  const double variance = samples * period * (period - 1.0);
+  return (uint64_t)(IEEE_COUNT_SAMPLE_Z * _count_sample_sqrt(variance) + 0.5);
+}
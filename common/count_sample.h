@@ -0,0 +1,56 @@
+/*****************************************************************************\
+ *                                                                           *\
+ *  This file is part of the Verificarlo project,                            *\
+ *  under the Apache License v2.0 with LLVM Exceptions.                      *\
+ *  SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception.                 *\
+ *  See https://llvm.org/LICENSE.txt for license information.                *\
+ *                                                                           *\
+ *  Copyright (c) 2019-2023                                                  *\
+ *     Verificarlo Contributors                                              *\
+ *                                                                           *\
+ ****************************************************************************/
+#ifndef __COUNT_SAMPLE_H__
+#define __COUNT_SAMPLE_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Sampled operation count (--count-sample=N)                               */
+/* Each operation of a thread is counted with probability 1/N, independently */
+/* of the others: the gaps between two counted operations are drawn from a  */
+/* geometric distribution of mean N, so the samples do not follow the       */
+/* strides of loops as a fixed period would. A counted operation adds N to  */
+/* its counter, which is then an unbiased estimate of the number of         */
+/* operations. The other operations only pay the decrement of a            */
+/* thread-local countdown.                                                   */
+
+/* Normal quantile of the two-sided 95% confidence intervals */
+#define IEEE_COUNT_SAMPLE_Z 1.96
+
+/* Operations left before the next counted one of the thread, 0 before the */
+/* first draw. Initial-exec, as ieee_overhead_countdown (overhead.h)        */
+extern __thread uint32_t ieee_count_sample_countdown
+    __attribute__((tls_model("initial-exec")));
+
+/* Sets the mean gap <period>, at most UINT32_MAX, between two counted  */
+/* operations, also while operations run (--live-config): the gaps      */
+/* already drawn are kept                                               */
+void ieee_count_sample_start(uint64_t period);
+/* Draws the next gap of the thread, returns true if the current */
+/* operation is counted                                          */
+bool ieee_count_sample_next(void);
+
+/* Returns true if the current operation of the thread is counted */
+static inline bool ieee_count_sample(void) {
+  if (__builtin_expect(ieee_count_sample_countdown > 1, 1)) {
+    ieee_count_sample_countdown--;
+    return false;
+  }
+  return ieee_count_sample_next();
+}
+
+/* Half-width of the 95% confidence interval of the estimated <count>, */
+/* counted with the mean gap <period>                                  */
+uint64_t ieee_count_sample_interval(uint64_t count, uint64_t period);
+
+#endif /* __COUNT_SAMPLE_H__ */
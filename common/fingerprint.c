@@ -0,0 +1,131 @@
+/*****************************************************************************\
+ *                                                                           *\
+ *  This file is part of the Verificarlo project,                            *\
+ *  under the Apache License v2.0 with LLVM Exceptions.                      *\
+ *  SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception.                 *\
+ *  See https://llvm.org/LICENSE.txt for license information.                *\
+ *                                                                           *\
+ *  Copyright (c) 2019-2023                                                  *\
+ *     Verificarlo Contributors                                              *\
+ *                                                                           *\
+ ****************************************************************************/
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "fingerprint.h"
+#include "interflop/interflop_stdlib.h"
+
+__thread ieee_fingerprint_thread_t *ieee_fingerprint_thread
+    __attribute__((tls_model("initial-exec"))) = NULL;
+
+static int fingerprint_fd = -1;
+static uint64_t fingerprint_interval = IEEE_FINGERPRINT_DEFAULT_INTERVAL;
+/* Every thread state, for the final flush */
+static ieee_fingerprint_thread_t *threads = NULL;
+static uint32_t n_threads = 0;
+/* Records which could not be written, reported at close */
+static uint64_t lost_records = 0;
+
+int ieee_fingerprint_open(const char *path, uint64_t interval) {
+  /* Records are single O_APPEND writes, threads need no lock */
+  const int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+  if (fd == -1)
+    return -1;
+  ieee_fingerprint_header_t header;
+  memset(&header, 0, sizeof(header));
+  header.magic = IEEE_FINGERPRINT_MAGIC;
+  header.version = IEEE_FINGERPRINT_VERSION;
+  header.header_size = sizeof(ieee_fingerprint_header_t);
+  header.record_size = sizeof(ieee_fingerprint_record_t);
+  header.n_streams = IEEE_STREAMS;
+  header.interval = interval;
+  if (write(fd, &header, sizeof(header)) != sizeof(header)) {
+    const int error = errno;
+    close(fd);
+    errno = error;
+    return -1;
+  }
+  fingerprint_interval = interval;
+  fingerprint_fd = fd;
+  return 0;
+}
+
+ieee_fingerprint_thread_t *ieee_fingerprint_attach(void) {
+  ieee_fingerprint_thread_t *thread = NULL;
+  if (posix_memalign((void **)&thread, 64, sizeof(*thread)) != 0) {
+    interflop_panic("fingerprint: cannot allocate the thread state\n");
+  }
+  memset(thread, 0, sizeof(*thread));
+  for (unsigned s = 0; s < IEEE_STREAMS; s++) {
+    for (int l = 0; l < IEEE_FINGERPRINT_MAX_LANES; l++)
+      thread->streams[s].lanes[l] = IEEE_FINGERPRINT_SEED;
+    thread->streams[s].next = fingerprint_interval;
+  }
+  thread->index = __atomic_fetch_add(&n_threads, 1, __ATOMIC_RELAXED);
+  thread->next = __atomic_load_n(&threads, __ATOMIC_RELAXED);
+  while (!__atomic_compare_exchange_n(&threads, &thread->next, thread, true,
+                                      __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+    ;
+  ieee_fingerprint_thread = thread;
+  return thread;
+}
+
+/* Folds the lanes of <s> and its count into one well-mixed word */
+static uint64_t digest(const ieee_fingerprint_stream_t *s, unsigned lanes) {
+  uint64_t h = IEEE_FINGERPRINT_SEED;
+  for (unsigned l = 0; l < (lanes ? lanes : 1); l++)
+    h = (h ^ s->lanes[l]) * IEEE_FINGERPRINT_MULTIPLIER;
+  h ^= s->ops;
+  /* Finalizer of MurmurHash3 */
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+static void append(ieee_fingerprint_thread_t *thread, unsigned stream,
+                   bool last) {
+  ieee_fingerprint_stream_t *s = &thread->streams[stream];
+  ieee_fingerprint_record_t record = {
+      .thread = thread->index,
+      .stream = stream,
+      .last = last,
+      .checkpoint = s->checkpoint++,
+      .ops = s->ops,
+      .digest = digest(s, ieee_stream_lanes(stream)),
+  };
+  s->recorded = s->ops;
+  if (write(fingerprint_fd, &record, sizeof(record)) != sizeof(record))
+    __atomic_add_fetch(&lost_records, 1, __ATOMIC_RELAXED);
+}
+
+void ieee_fingerprint_checkpoint(ieee_fingerprint_thread_t *thread,
+                                 unsigned stream) {
+  ieee_fingerprint_stream_t *s = &thread->streams[stream];
+  append(thread, stream, false);
+  /* A vector kernel may jump over several boundaries */
+  while (s->next <= s->ops)
+    s->next += fingerprint_interval;
+}
+
+uint64_t ieee_fingerprint_close(void) {
+  if (fingerprint_fd == -1)
+    return 0;
+  for (ieee_fingerprint_thread_t *thread =
+           __atomic_load_n(&threads, __ATOMIC_ACQUIRE);
+       thread != NULL; thread = thread->next) {
+    for (unsigned s = 0; s < IEEE_STREAMS; s++) {
+      if (thread->streams[s].ops != thread->streams[s].recorded)
+        append(thread, s, true);
+    }
+  }
+  close(fingerprint_fd);
+  fingerprint_fd = -1;
+  return lost_records;
+}
@@ -0,0 +1,124 @@
+/*****************************************************************************\
+ *                                                                           *\
+ *  This file is part of the Verificarlo project,                            *\
+ *  under the Apache License v2.0 with LLVM Exceptions.                      *\
+ *  SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception.                 *\
+ *  See https://llvm.org/LICENSE.txt for license information.                *\
+ *                                                                           *\
+ *  Copyright (c) 2019-2023                                                  *\
+ *     Verificarlo Contributors                                              *\
+ *                                                                           *\
+ ****************************************************************************/
+#ifndef __FINGERPRINT_H__
+#define __FINGERPRINT_H__
+
+#include <stdint.h>
+
+#include "streams.h"
+
+/* Result fingerprints of the --fingerprint=<file> option                   */
+/*                                                                          */
+/* Each thread keeps, per operation stream (streams.h), a rolling hash of   */
+/* the bit patterns of the results: h = (h ^ result) * M, with one hash per */
+/* lane for the vector kernels so that they are updated with SIMD          */
+/* instructions. For a fixed sequence of later results, an odd M makes the  */
+/* update a bijection of h, so a difference in any result is never lost.   */
+/* Every <interval> operations of a stream, a record with the digest of    */
+/* the lanes is appended to the file; at finalize the last partial window  */
+/* of each stream is flushed. Comparing the records of two runs gives the  */
+/* first window where a stream diverged (tools/fingerprint_compare.c).      */
+/*                                                                          */
+/*   offset 0                 ieee_fingerprint_header_t (64 bytes)          */
+/*   offset 64 + i * 32       ieee_fingerprint_record_t                     */
+/*                                                                          */
+/* Records of different threads are interleaved. Threads are numbered in   */
+/* the order of their first operation, the numbering only matches between  */
+/* runs if threads start computing in the same order.                      */
+
+#define IEEE_FINGERPRINT_MAGIC 0x5452504645454549ULL /* "IEEEFPRT" */
+#define IEEE_FINGERPRINT_VERSION 1
+#define IEEE_FINGERPRINT_DEFAULT_INTERVAL (1ULL << 20)
+
+#define IEEE_FINGERPRINT_SEED 0xcbf29ce484222325ULL
+#define IEEE_FINGERPRINT_MULTIPLIER 0x9e3779b97f4a7c15ULL
+#define IEEE_FINGERPRINT_MAX_LANES 16
+
+typedef struct {
+  uint64_t magic;       /* IEEE_FINGERPRINT_MAGIC */
+  uint32_t version;     /* IEEE_FINGERPRINT_VERSION */
+  uint32_t header_size; /* sizeof(ieee_fingerprint_header_t) */
+  uint32_t record_size; /* sizeof(ieee_fingerprint_record_t) */
+  uint32_t n_streams;   /* IEEE_STREAMS */
+  uint64_t interval;    /* operations per window */
+  uint8_t reserved[32];
+} ieee_fingerprint_header_t;
+
+typedef struct {
+  uint32_t thread;     /* number of the thread */
+  uint16_t stream;     /* see streams.h */
+  uint16_t last;       /* 1 for the partial window flushed at finalize */
+  uint64_t checkpoint; /* index of the window in the stream of the thread */
+  uint64_t ops;        /* operations of the stream up to the window end */
+  uint64_t digest;
+} ieee_fingerprint_record_t;
+
+_Static_assert(sizeof(ieee_fingerprint_header_t) == 64, "header layout");
+_Static_assert(sizeof(ieee_fingerprint_record_t) == 32, "record layout");
+
+/* Backend side */
+
+typedef struct {
+  uint64_t lanes[IEEE_FINGERPRINT_MAX_LANES]; /* one hash per lane */
+  uint64_t ops;
+  uint64_t next;     /* ops of the next checkpoint */
+  uint64_t recorded; /* ops of the last record */
+  uint64_t checkpoint;
+} __attribute__((aligned(64))) ieee_fingerprint_stream_t;
+
+typedef struct ieee_fingerprint_thread {
+  ieee_fingerprint_stream_t streams[IEEE_STREAMS];
+  struct ieee_fingerprint_thread *next;
+  uint32_t index;
+} ieee_fingerprint_thread_t;
+
+extern __thread ieee_fingerprint_thread_t *ieee_fingerprint_thread
+    __attribute__((tls_model("initial-exec")));
+
+/* Creates <path>, returns 0 on success, -1 with errno set */
+int ieee_fingerprint_open(const char *path, uint64_t interval);
+/* Allocates the state of the calling thread */
+ieee_fingerprint_thread_t *ieee_fingerprint_attach(void);
+/* Appends the record of the window ending now in <stream> */
+void ieee_fingerprint_checkpoint(ieee_fingerprint_thread_t *thread,
+                                 unsigned stream);
+/* Flushes the partial windows of every thread and closes the file,   */
+/* returns the number of records which could not be written           */
+uint64_t ieee_fingerprint_close(void);
+
+static inline ieee_fingerprint_stream_t *
+ieee_fingerprint_stream(ieee_fingerprint_thread_t **thread, unsigned stream) {
+  ieee_fingerprint_thread_t *t = ieee_fingerprint_thread;
+  if (__builtin_expect(t == NULL, 0))
+    t = ieee_fingerprint_attach();
+  *thread = t;
+  return &t->streams[stream];
+}
+
+/* Adds <n> operations to <stream>, whose lanes are already updated */
+static inline void ieee_fingerprint_count(ieee_fingerprint_thread_t *thread,
+                                          unsigned stream, uint64_t n) {
+  ieee_fingerprint_stream_t *s = &thread->streams[stream];
+  s->ops += n;
+  if (__builtin_expect(s->ops >= s->next, 0))
+    ieee_fingerprint_checkpoint(thread, stream);
+}
+
+/* Hashes the result <bits> of a scalar operation */
+static inline void ieee_fingerprint_scalar(unsigned stream, uint64_t bits) {
+  ieee_fingerprint_thread_t *thread;
+  ieee_fingerprint_stream_t *s = ieee_fingerprint_stream(&thread, stream);
+  s->lanes[0] = (s->lanes[0] ^ bits) * IEEE_FINGERPRINT_MULTIPLIER;
+  ieee_fingerprint_count(thread, stream, 1);
+}
+
+#endif /* __FINGERPRINT_H__ */
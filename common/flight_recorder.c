@@ -0,0 +1,188 @@
+/*****************************************************************************\
+ *                                                                           *\
+ *  This file is part of the Verificarlo project,                            *\
+ *  under the Apache License v2.0 with LLVM Exceptions.                      *\
+ *  SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception.                 *\
+ *  See https://llvm.org/LICENSE.txt for license information.                *\
+ *                                                                           *\
+ *  Copyright (c) 2019-2023                                                  *\
+ *     Verificarlo Contributors                                              *\
+ *                                                                           *\
+ ****************************************************************************/
+#include <limits.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "flight_recorder.h"
+#include "signal_output.h"
+
+#define FLIGHT_SIGNALS 3
+#define FLIGHT_LINE_MAX (PATH_MAX + 256)
+/* 2^30 records of 48 bytes, per thread */
+#define FLIGHT_CAPACITY_MAX (1ULL << 30)
+
+__thread ieee_flight_ring_t *ieee_flight_thread_ring
+    __attribute__((tls_model("initial-exec"))) = NULL;
+int ieee_flight_nan_seen = 0;
+/* set once a ring cannot be allocated, not to try again on each operation */
+static __thread int flight_no_ring __attribute__((tls_model("initial-exec"))) =
+    0;
+/* set by the first fatal signal, the rings are printed once */
+static int flight_signal_dumped = 0;
+
+static const int flight_signals[FLIGHT_SIGNALS] = {SIGSEGV, SIGABRT, SIGFPE};
+static const char *const flight_signal_names[FLIGHT_SIGNALS] = {
+    "SIGSEGV", "SIGABRT", "SIGFPE"};
+static struct sigaction flight_previous[FLIGHT_SIGNALS];
+
+static uint64_t flight_capacity = 0;
+static ieee_flight_ring_t *flight_rings = NULL;
+
+ieee_flight_ring_t *ieee_flight_new_ring(void) {
+  if (flight_no_ring)
+    return NULL;
+  ieee_flight_ring_t *ring = calloc(1, sizeof(ieee_flight_ring_t));
+  if (ring != NULL) {
+    ring->records = calloc(flight_capacity, sizeof(ieee_flight_record_t));
+    if (ring->records == NULL) {
+      free(ring);
+      ring = NULL;
+    }
+  }
+  if (ring == NULL) {
+    flight_no_ring = 1;
+    return NULL;
+  }
+  ring->mask = flight_capacity - 1;
+  ring->tid = syscall(SYS_gettid);
+  ring->next = __atomic_load_n(&flight_rings, __ATOMIC_RELAXED);
+  while (!__atomic_compare_exchange_n(&flight_rings, &ring->next, ring, 1,
+                                      __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+    ;
+  ieee_flight_thread_ring = ring;
+  return ring;
+}
+
+static char *put_value(char *out, uint64_t bits, int is_float) {
+  if (is_float) {
+    const uint32_t u = bits;
+    float x;
+    memcpy(&x, &u, sizeof(x));
+    return ieee_format_hex_float(out, x, 0);
+  }
+  double x;
+  memcpy(&x, &bits, sizeof(x));
+  return ieee_format_hex_double(out, x, 0);
+}
+
+/* Writes operation <seq> of a thread, as                         */
+/* "#<seq> <op> <precision> <operands> -> <result> at <site>"     */
+static char *put_record(char *out, uint64_t seq,
+                        const ieee_flight_record_t *rec) {
+  const ieee_trace_record_t *op = &rec->op;
+  const int is_float = op->precision == IEEE_TRACE_FLOAT;
+  const int n_operands = (op->opcode == IEEE_TRACE_CAST)  ? 1
+                         : (op->opcode == IEEE_TRACE_FMA) ? 3
+                                                          : 2;
+  out = ieee_put_str(out, "\t#");
+  out = ieee_format_uint(out, seq);
+  *out++ = ' ';
+  out = ieee_put_str(out, (op->opcode < IEEE_TRACE_N_OPCODES)
+                              ? ieee_trace_opcode_names[op->opcode]
+                              : "?");
+  out = ieee_put_str(out, is_float ? " float" : " double");
+  if (op->opcode == IEEE_TRACE_CMP) {
+    out = ieee_put_str(out, " p");
+    out = ieee_format_uint(out, op->predicate);
+  }
+  for (int i = 0; i < n_operands; i++) {
+    *out++ = ' ';
+    out = put_value(out, op->operands[i], is_float);
+  }
+  out = ieee_put_str(out, " -> ");
+  if (op->opcode == IEEE_TRACE_CMP) {
+    out = ieee_format_uint(out, op->result);
+  } else {
+    out = put_value(out, op->result,
+                    is_float || op->opcode == IEEE_TRACE_CAST);
+  }
+  out = ieee_put_str(out, " at ");
+  out = ieee_put_hex(out, (uintptr_t)rec->site);
+  *out++ = '\n';
+  return out;
+}
+
+void ieee_flight_dump(const char *reason) {
+  char line[FLIGHT_LINE_MAX];
+  char *out = ieee_put_str(line, "flight recorder, ");
+  out = ieee_put_str(out, reason);
+  out = ieee_put_str(out, ":\n");
+  ieee_write_line(line, out);
+
+  for (const ieee_flight_ring_t *ring =
+           __atomic_load_n(&flight_rings, __ATOMIC_ACQUIRE);
+       ring != NULL; ring = ring->next) {
+    const uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    const uint64_t n = (head < ring->mask + 1) ? head : ring->mask + 1;
+    out = ieee_put_str(line, "thread ");
+    out = ieee_format_uint(out, ring->tid);
+    out = ieee_put_str(out, ", last ");
+    out = ieee_format_uint(out, n);
+    out = ieee_put_str(out, " of ");
+    out = ieee_format_uint(out, head);
+    out = ieee_put_str(out, " operations:\n");
+    ieee_write_line(line, out);
+    for (uint64_t seq = head - n; seq < head; seq++) {
+      out = put_record(line, seq, &ring->records[seq & ring->mask]);
+      ieee_write_line(line, out);
+    }
+  }
+  ieee_write_maps("  map ");
+}
+
+void ieee_flight_nan(void) {
+  if (__atomic_exchange_n(&ieee_flight_nan_seen, 1, __ATOMIC_RELAXED) == 0)
+    ieee_flight_dump("first NaN");
+}
+
+static void flight_handler(int sig, siginfo_t *info, void *context) {
+  int i = 0;
+  while (i < FLIGHT_SIGNALS - 1 && flight_signals[i] != sig)
+    i++;
+
+  /* A handler of the application may recover from the signal: the rings */
+  /* are only printed when the signal kills the process                  */
+  const struct sigaction *previous = &flight_previous[i];
+  if (ieee_signal_forward(previous, sig, info, context))
+    return;
+  /* Ignored signals are only fatal when raised by a fault */
+  if (previous->sa_handler == SIG_IGN && info->si_code <= 0)
+    return;
+  if (__atomic_exchange_n(&flight_signal_dumped, 1, __ATOMIC_RELAXED) == 0)
+    ieee_flight_dump(flight_signal_names[i]);
+
+  /* A fault is raised again by the instruction on return, signals */
+  /* sent by kill or abort are raised again explicitly             */
+  sigaction(sig, previous, NULL);
+  if (info->si_code <= 0)
+    raise(sig);
+}
+
+int ieee_flight_start(uint64_t n) {
+  flight_capacity = 1;
+  while (flight_capacity < n && flight_capacity < FLIGHT_CAPACITY_MAX)
+    flight_capacity *= 2;
+
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_sigaction = flight_handler;
+  action.sa_flags = SA_SIGINFO;
+  sigemptyset(&action.sa_mask);
+  for (int i = 0; i < FLIGHT_SIGNALS; i++) {
+    if (sigaction(flight_signals[i], &action, &flight_previous[i]) != 0)
+      return -1;
+  }
+  return 0;
+}
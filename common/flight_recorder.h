@@ -0,0 +1,99 @@
+/*****************************************************************************\
+ *                                                                           *\
+ *  This file is part of the Verificarlo project,                            *\
+ *  under the Apache License v2.0 with LLVM Exceptions.                      *\
+ *  SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception.                 *\
+ *  See https://llvm.org/LICENSE.txt for license information.                *\
+ *                                                                           *\
+ *  Copyright (c) 2019-2023                                                  *\
+ *     Verificarlo Contributors                                              *\
+ *                                                                           *\
+ ****************************************************************************/
+#ifndef __FLIGHT_RECORDER_H__
+#define __FLIGHT_RECORDER_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "trace.h"
+
+/* In-memory flight recorder of the --flight-recorder option               */
+/* Each thread keeps its last operations in a ring of records allocated on */
+/* its first operation and linked lock-free to the list of rings. Records  */
+/* are written with plain stores and no I/O; the rings are only printed   */
+/* once on a fatal SIGSEGV, SIGABRT or SIGFPE, on the first NaN result and */
+/* at the end of the execution. The ring size is rounded up to a power of */
+/* two, so that the slot is the operation count masked. Rings of exited    */
+/* threads are kept and printed with the others.                           */
+
+typedef struct {
+  ieee_trace_record_t op;
+  const void *site; /* address the entry point returns to */
+} ieee_flight_record_t;
+
+typedef struct ieee_flight_ring {
+  struct ieee_flight_ring *next;
+  ieee_flight_record_t *records;
+  uint64_t mask;
+  uint64_t head; /* operations recorded */
+  int32_t tid;
+} ieee_flight_ring_t;
+
+/* Installs the signal handlers, which run the previous handlers and    */
+/* print the rings when there are none. Rings keep the last <n>          */
+/* operations or more. Returns 0 on success                              */
+int ieee_flight_start(uint64_t n);
+/* Allocates the ring of the calling thread, NULL if out of memory, */
+/* then on each later call from the thread                          */
+ieee_flight_ring_t *ieee_flight_new_ring(void);
+/* Prints the rings of every thread on stderr, with the title <reason>, */
+/* then the executable mappings to resolve the raw call sites, only     */
+/* with async-signal-safe functions                                     */
+void ieee_flight_dump(const char *reason);
+/* Prints the rings the first time a NaN result is recorded */
+void ieee_flight_nan(void);
+
+extern __thread ieee_flight_ring_t *ieee_flight_thread_ring
+    __attribute__((tls_model("initial-exec")));
+extern int ieee_flight_nan_seen;
+
+static inline int ieee_flight_is_nan(unsigned opcode, unsigned precision,
+                                     uint64_t bits) {
+  if (opcode == IEEE_TRACE_CMP)
+    return 0;
+  if (precision == IEEE_TRACE_FLOAT || opcode == IEEE_TRACE_CAST)
+    return (bits & 0x7fffffff) > 0x7f800000;
+  return (bits & 0x7fffffffffffffffULL) > 0x7ff0000000000000ULL;
+}
+
+/* Records an operation of the calling thread, with the arguments of a */
+/* trace record (trace.h)                                              */
+static inline void ieee_flight_record(unsigned opcode, unsigned precision,
+                                      int predicate, uint64_t a, uint64_t b,
+                                      uint64_t c, uint64_t result,
+                                      const void *site) {
+  ieee_flight_ring_t *ring = ieee_flight_thread_ring;
+  if (__builtin_expect(ring == NULL, 0)) {
+    ring = ieee_flight_new_ring();
+    if (ring == NULL)
+      return;
+  }
+  const uint64_t head = ring->head;
+  ieee_flight_record_t *rec = &ring->records[head & ring->mask];
+  rec->op.opcode = opcode;
+  rec->op.precision = precision;
+  rec->op.predicate = predicate;
+  rec->op.operands[0] = a;
+  rec->op.operands[1] = b;
+  rec->op.operands[2] = c;
+  rec->op.result = result;
+  rec->site = site;
+  /* published once complete, for the dumps of handlers and other threads */
+  __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+
+  if (__builtin_expect(ieee_flight_is_nan(opcode, precision, result), 0) &&
+      !ieee_flight_nan_seen)
+    ieee_flight_nan();
+}
+
+#endif /* __FLIGHT_RECORDER_H__ */
@@ -0,0 +1,86 @@
+/*****************************************************************************\
+ *                                                                           *\
+ *  This file is part of the Verificarlo project,                            *\
+ *  under the Apache License v2.0 with LLVM Exceptions.                      *\
+ *  SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception.                 *\
+ *  See https://llvm.org/LICENSE.txt for license information.                *\
+ *                                                                           *\
+ *  Copyright (c) 2019-2023                                                  *\
+ *     Verificarlo Contributors                                              *\
+ *                                                                           *\
+ ****************************************************************************/
+#define _GNU_SOURCE /* feenableexcept */
+#include <fenv.h>
+#include <pthread.h>
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+#include "fpenv.h"
+
+__thread int ieee_fpenv_thread_ready = 0;
+
+/* MXCSR flush-to-zero (bit 15) and denormals-are-zero (bit 6) */
+#define MXCSR_FTZ_DAZ 0x8040
+
+static int fpenv_rounding = FE_TONEAREST;
+static int fpenv_ftz_daz = 0;
+static int fpenv_traps = 0;
+
+/* Sticky flags of the threads that exited, collected by the destructor */
+/* of a key set in each thread setup with trapped exceptions            */
+static int fpenv_exited_flags = 0;
+static pthread_key_t fpenv_exit_key;
+static pthread_once_t fpenv_exit_once = PTHREAD_ONCE_INIT;
+
+static void _fpenv_thread_exit(void *unused) {
+  (void)unused;
+  __atomic_fetch_or(&fpenv_exited_flags, fetestexcept(FE_ALL_EXCEPT),
+                    __ATOMIC_RELAXED);
+}
+
+static void _fpenv_exit_key_create(void) {
+  pthread_key_create(&fpenv_exit_key, _fpenv_thread_exit);
+}
+
+void ieee_fpenv_configure(int fe_rounding, int ftz_daz, int fe_traps) {
+  fpenv_rounding = fe_rounding;
+  fpenv_ftz_daz = ftz_daz;
+  fpenv_traps = fe_traps;
+  ieee_fpenv_thread_setup();
+}
+
+void ieee_fpenv_thread_setup(void) {
+  /* fesetround sets both the MXCSR and the x87 control word, the latter */
+  /* is used by the scalar vbackend table built with -mno-sse            */
+  fesetround(fpenv_rounding);
+#if defined(__SSE__)
+  /* The x87 unit has no FTZ/DAZ, only SSE and AVX operations flush */
+  if (fpenv_ftz_daz) {
+    _mm_setcsr(_mm_getcsr() | MXCSR_FTZ_DAZ);
+  }
+  /* Exceptions are only unmasked in the MXCSR, the x87 unit used by the */
+  /* scalar vbackend table and the long double accounting of the backend */
+  /* keeps them masked. The MXCSR masks are the flags shifted by 7       */
+  if (fpenv_traps) {
+    feclearexcept(fpenv_traps);
+    _mm_setcsr(_mm_getcsr() & ~(fpenv_traps << 7));
+  }
+#else
+  if (fpenv_traps) {
+    feclearexcept(fpenv_traps);
+    feenableexcept(fpenv_traps);
+  }
+#endif
+  /* The destructor only runs for a non-NULL value */
+  if (fpenv_traps) {
+    pthread_once(&fpenv_exit_once, _fpenv_exit_key_create);
+    pthread_setspecific(fpenv_exit_key, &fpenv_exited_flags);
+  }
+  ieee_fpenv_thread_ready = 1;
+}
+
+int ieee_fpenv_raised(void) {
+  return __atomic_load_n(&fpenv_exited_flags, __ATOMIC_RELAXED) |
+         fetestexcept(FE_ALL_EXCEPT);
+}
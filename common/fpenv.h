@@ -0,0 +1,42 @@
+/*****************************************************************************\
+ *                                                                           *\
+ *  This file is part of the Verificarlo project,                            *\
+ *  under the Apache License v2.0 with LLVM Exceptions.                      *\
+ *  SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception.                 *\
+ *  See https://llvm.org/LICENSE.txt for license information.                *\
+ *                                                                           *\
+ *  Copyright (c) 2019-2023                                                  *\
+ *     Verificarlo Contributors                                              *\
+ *                                                                           *\
+ ****************************************************************************/
+#ifndef __FPENV_H__
+#define __FPENV_H__
+
+/* Per-thread floating-point environment of the backend                   */
+/* The environment requested by the options (rounding mode, FTZ/DAZ,      */
+/* trapped exceptions) is installed once per thread, the first time the   */
+/* thread enters the backend. Entry points call ieee_fpenv_enter() only   */
+/* when a non-default environment is requested, so the default            */
+/* configuration pays nothing.                                            */
+
+/* Sets the environment installed in each thread and in the calling one */
+/* <fe_rounding> is one of the FE_* rounding modes of <fenv.h>, a non  */
+/* zero <ftz_daz> sets the flush-to-zero and denormals-are-zero bits   */
+/* and <fe_traps> are the FE_* exceptions to unmask (trap.h)           */
+void ieee_fpenv_configure(int fe_rounding, int ftz_daz, int fe_traps);
+/* Installs the environment in the calling thread */
+void ieee_fpenv_thread_setup(void);
+/* Returns the sticky exception flags of the calling thread and, when   */
+/* exceptions are trapped, of the threads that exited, collected at     */
+/* their exit so that the operations pay nothing                        */
+int ieee_fpenv_raised(void);
+
+extern __thread int ieee_fpenv_thread_ready;
+
+static inline void ieee_fpenv_enter(void) {
+  if (__builtin_expect(!ieee_fpenv_thread_ready, 0)) {
+    ieee_fpenv_thread_setup();
+  }
+}
+
+#endif /* __FPENV_H__ */
@@ -0,0 +1,129 @@
+/*****************************************************************************\
+ *                                                                           *\
+ *  This file is part of the Verificarlo project,                            *\
+ *  under the Apache License v2.0 with LLVM Exceptions.                      *\
+ *  SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception.                 *\
+ *  See https://llvm.org/LICENSE.txt for license information.                *\
+ *                                                                           *\
+ *  Copyright (c) 2019-2023                                                  *\
+ *     Verificarlo Contributors                                              *\
+ *                                                                           *\
+ ****************************************************************************/
+#ifndef __HEX_FLOAT_H__
+#define __HEX_FLOAT_H__
+
+#include <stdint.h>
+#include <string.h>
+
+/* Hexadecimal floating-point formatting of the --debug-hex option          */
+/* Values are written as C99 hex floats, "[-]0x1.<hex>p<+|-><exp>", the    */
+/* significand bits of the format exactly and trailing zero digits dropped  */
+/* as by printf("%a"). Floats use 6 digits, their 23 bits shifted left by  */
+/* one. Subnormals are written "0x0.<hex>p-126" (p-1022 for doubles), or   */
+/* normalized to "0x1.<hex>p<exp>" on request. Zeros are "0x0p+0", other   */
+/* special values "inf" and "nan(0x<significand>)", keeping the payload.   */
+/* The functions write into a caller buffer, without terminating null, and */
+/* return the end of what they wrote.                                       */
+
+static const char ieee_hex_digits[16] = "0123456789abcdef";
+
+/* Writes the decimal representation of <n> */
+static inline char *ieee_format_uint(char *out, uint64_t n) {
+  char digits[20];
+  int len = 0;
+  do {
+    digits[len++] = '0' + n % 10;
+    n /= 10;
+  } while (n != 0);
+  while (len > 0)
+    *out++ = digits[--len];
+  return out;
+}
+
+/* Writes the <n_digits> high hexadecimal digits of the <bits>-bit <v> */
+static inline char *_ieee_format_hex_digits(char *out, uint64_t v,
+                                            unsigned bits, int n_digits) {
+  for (int i = 1; i <= n_digits; i++)
+    *out++ = ieee_hex_digits[(v >> (bits - 4 * i)) & 0xf];
+  return out;
+}
+
+/* Formats the value of sign <sign>, biased exponent <exp> and significand */
+/* <mant> of <mant_bits> bits, in a format of exponent bias <bias>         */
+static inline char *_ieee_format_hex(char *out, uint64_t sign, uint64_t exp,
+                                     uint64_t mant, unsigned mant_bits,
+                                     int bias, int normalize) {
+  /* significand left-aligned on whole hexadecimal digits */
+  const unsigned shift = (4 - mant_bits % 4) % 4;
+  const unsigned bits = mant_bits + shift;
+  const uint64_t max_exp = 2 * (uint64_t)bias + 1;
+
+  if (sign)
+    *out++ = '-';
+  if (exp == max_exp) {
+    if (mant == 0) {
+      memcpy(out, "inf", 3);
+      return out + 3;
+    }
+    memcpy(out, "nan(0x", 6);
+    out += 6;
+    const unsigned n_digits = (64 - __builtin_clzll(mant) + 3) / 4;
+    out = _ieee_format_hex_digits(out, mant, 4 * n_digits, n_digits);
+    *out++ = ')';
+    return out;
+  }
+  if (exp == 0 && mant == 0) {
+    memcpy(out, "0x0p+0", 6);
+    return out + 6;
+  }
+
+  int e;
+  char lead;
+  if (exp != 0) {
+    lead = '1';
+    e = (int)exp - bias;
+  } else if (normalize) {
+    /* shift the leading one into the implicit bit */
+    const unsigned k = mant_bits - (63 - __builtin_clzll(mant));
+    mant = (mant << k) & ((1ULL << mant_bits) - 1);
+    lead = '1';
+    e = 1 - bias - (int)k;
+  } else {
+    lead = '0';
+    e = 1 - bias;
+  }
+
+  memcpy(out, "0x", 2);
+  out += 2;
+  *out++ = lead;
+  if (mant != 0) {
+    const uint64_t aligned = mant << shift;
+    *out++ = '.';
+    out = _ieee_format_hex_digits(out, aligned, bits,
+                                  bits / 4 - __builtin_ctzll(aligned) / 4);
+  }
+  *out++ = 'p';
+  *out++ = (e < 0) ? '-' : '+';
+  return ieee_format_uint(out, (e < 0) ? -e : e);
+}
+
+static inline char *ieee_format_hex_float(char *out, float x, int normalize) {
+  uint32_t u;
+  memcpy(&u, &x, sizeof(u));
+  return _ieee_format_hex(out, u >> 31, (u >> 23) & 0xff, u & 0x7fffff, 23,
+                          127, normalize);
+}
+
+static inline char *ieee_format_hex_double(char *out, double x,
+                                           int normalize) {
+  uint64_t u;
+  memcpy(&u, &x, sizeof(u));
+  return _ieee_format_hex(out, u >> 63, (u >> 52) & 0x7ff,
+                          u & 0xfffffffffffffULL, 52, 1023, normalize);
+}
+
+#define IEEE_FORMAT_HEX(out, x, normalize)                                     \
+  _Generic(x, float : ieee_format_hex_float, double : ieee_format_hex_double)( \
+      out, x, normalize)
+
+#endif /* __HEX_FLOAT_H__ */
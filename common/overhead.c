@@ -0,0 +1,68 @@
+/*****************************************************************************\
+ *                                                                           *\
+ *  This file is part of the Verificarlo project,                            *\
+ *  under the Apache License v2.0 with LLVM Exceptions.                      *\
+ *  SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception.                 *\
+ *  See https://llvm.org/LICENSE.txt for license information.                *\
+ *                                                                           *\
+ *  Copyright (c) 2019-2023                                                  *\
+ *     Verificarlo Contributors                                              *\
+ *                                                                           *\
+ ****************************************************************************/
+#include <time.h>
+
+#include "overhead.h"
+
+ieee_overhead_entry_t ieee_overhead_entries[IEEE_STREAMS];
+
+__thread uint32_t ieee_overhead_countdown
+    __attribute__((tls_model("initial-exec"))) = IEEE_OVERHEAD_PERIOD;
+
+static uint64_t bias = 0;
+static uint64_t start_clock = 0;
+static struct timespec start_cpu, start_wall;
+
+static double elapsed(const struct timespec *start,
+                      const struct timespec *stop) {
+  return (stop->tv_sec - start->tv_sec) +
+         (stop->tv_nsec - start->tv_nsec) * 1e-9;
+}
+
+void ieee_overhead_start(void) {
+  /* The cheapest of a few pairs, the others were interrupted */
+  uint64_t best = UINT64_MAX;
+  for (int i = 0; i < 1000; i++) {
+    const uint64_t t0 = ieee_overhead_clock();
+    const uint64_t t1 = ieee_overhead_clock();
+    if (t1 - t0 < best)
+      best = t1 - t0;
+  }
+  bias = best;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &start_cpu);
+  clock_gettime(CLOCK_MONOTONIC, &start_wall);
+  start_clock = ieee_overhead_clock();
+}
+
+void ieee_overhead_record(unsigned entry, uint64_t cycles) {
+  ieee_overhead_entry_t *e = &ieee_overhead_entries[entry];
+  cycles = (cycles > bias) ? cycles - bias : 0;
+  unsigned bucket = (cycles == 0) ? 0 : 64 - __builtin_clzll(cycles);
+  if (bucket >= IEEE_OVERHEAD_BUCKETS)
+    bucket = IEEE_OVERHEAD_BUCKETS - 1;
+  __atomic_add_fetch(&e->samples, 1, __ATOMIC_RELAXED);
+  __atomic_add_fetch(&e->cycles, cycles, __ATOMIC_RELAXED);
+  __atomic_add_fetch(&e->histogram[bucket], 1, __ATOMIC_RELAXED);
+}
+
+void ieee_overhead_stop(ieee_overhead_clock_t *clock) {
+  const uint64_t stop_clock = ieee_overhead_clock();
+  struct timespec stop_cpu, stop_wall;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &stop_cpu);
+  clock_gettime(CLOCK_MONOTONIC, &stop_wall);
+  clock->wall_seconds = elapsed(&start_wall, &stop_wall);
+  clock->cpu_seconds = elapsed(&start_cpu, &stop_cpu);
+  clock->cycles_per_second = 0;
+  if (clock->wall_seconds > 0)
+    clock->cycles_per_second = (stop_clock - start_clock) / clock->wall_seconds;
+  clock->bias = bias;
+}
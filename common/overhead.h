@@ -0,0 +1,82 @@
+/*****************************************************************************\
+ *                                                                           *\
+ *  This file is part of the Verificarlo project,                            *\
+ *  under the Apache License v2.0 with LLVM Exceptions.                      *\
+ *  SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception.                 *\
+ *  See https://llvm.org/LICENSE.txt for license information.                *\
+ *                                                                           *\
+ *  Copyright (c) 2019-2023                                                  *\
+ *     Verificarlo Contributors                                              *\
+ *                                                                           *\
+ ****************************************************************************/
+#ifndef __OVERHEAD_H__
+#define __OVERHEAD_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "streams.h"
+
+/* Sampling profiler of the time spent in the backend (--overhead-profile)  */
+/* The entry points are wrapped: one call out of IEEE_OVERHEAD_PERIOD per   */
+/* thread, chosen by a thread-local countdown, is timed with rdtscp and    */
+/* added to the cycle histogram of its operation. The other calls only pay */
+/* the decrement. The period is prime so that it does not follow the       */
+/* power-of-two strides of loops.                                           */
+
+#define IEEE_OVERHEAD_PERIOD 1021
+/* Bucket i counts the samples of [2^(i-1), 2^i) cycles, 0 the empty ones */
+#define IEEE_OVERHEAD_BUCKETS 40
+
+typedef struct {
+  uint64_t samples;
+  uint64_t cycles; /* sum of the samples */
+  uint64_t histogram[IEEE_OVERHEAD_BUCKETS];
+} ieee_overhead_entry_t;
+
+/* One entry per stream, see streams.h */
+extern ieee_overhead_entry_t ieee_overhead_entries[IEEE_STREAMS];
+
+/* Calls left before the next sample of the thread. The initial-exec model */
+/* keeps its access to one instruction in the shared library              */
+extern __thread uint32_t ieee_overhead_countdown
+    __attribute__((tls_model("initial-exec")));
+
+/* Returns true if the current call of the thread is to be timed */
+static inline bool ieee_overhead_sample(void) {
+  if (__builtin_expect(--ieee_overhead_countdown != 0, 1))
+    return false;
+  ieee_overhead_countdown = IEEE_OVERHEAD_PERIOD;
+  return true;
+}
+
+/* Time stamp counter, nanoseconds where there is none. rdtscp waits for */
+/* the previous instructions, i.e. the operation timed, to complete      */
+static inline uint64_t ieee_overhead_clock(void) {
+#if defined(__x86_64__)
+  unsigned int aux;
+  return __builtin_ia32_rdtscp(&aux);
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+/* Measures the cost of the clock reads and the start of the profile */
+void ieee_overhead_start(void);
+/* Adds a sample of <cycles> to <entry>, minus the cost of the clock reads */
+void ieee_overhead_record(unsigned entry, uint64_t cycles);
+
+typedef struct {
+  double cycles_per_second; /* of the clock, measured over the profile */
+  double cpu_seconds;       /* CPU time of the process over the profile */
+  double wall_seconds;
+  uint64_t bias; /* cycles of two back-to-back clock reads, subtracted */
+} ieee_overhead_clock_t;
+
+/* Ends the profile and fills <clock> */
+void ieee_overhead_stop(ieee_overhead_clock_t *clock);
+
+#endif /* __OVERHEAD_H__ */
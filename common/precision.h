@@ -0,0 +1,106 @@
+/*****************************************************************************\
+ *                                                                           *\
+ *  This file is part of the Verificarlo project,                            *\
+ *  under the Apache License v2.0 with LLVM Exceptions.                      *\
+ *  SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception.                 *\
+ *  See https://llvm.org/LICENSE.txt for license information.                *\
+ *                                                                           *\
+ *  Copyright (c) 2019-2023                                                  *\
+ *     Verificarlo Contributors                                              *\
+ *                                                                           *\
+ ****************************************************************************/
+#ifndef __PRECISION_H__
+#define __PRECISION_H__
+
+#include <stdint.h>
+
+/* Representability of values in reduced-precision formats, used by      */
+/* --precision-profile                                                    */
+/* A finite value fits a format if it is in its exponent range and the    */
+/* significand bits the format drops are zero, subnormals of the format   */
+/* included. With a budget of <ulps> units in the last place of the       */
+/* source format, the value only has to be within <ulps> of a value of    */
+/* the format. Zeros, infinities and NaNs fit every format.               */
+
+typedef enum {
+  IEEE_FORMAT_FP32 = 0,
+  IEEE_FORMAT_FP16,
+  IEEE_FORMAT_BF16,
+  IEEE_N_FORMATS
+} ieee_format_t;
+
+/* Counters of the call site table of --precision-profile: operations in */
+/* counter 0, operations whose operands and result fit format f in       */
+/* IEEE_PRECISION_COUNTER(f)                                              */
+#define IEEE_PRECISION_COUNTER(f) (1 + (f))
+
+/* Mask of the formats a float always fits */
+#define IEEE_FORMAT_FLOAT_MASK (1U << IEEE_FORMAT_FP32)
+#define IEEE_FORMAT_ALL_MASK ((1U << IEEE_N_FORMATS) - 1)
+
+typedef struct {
+  int p;    /* significand bits, the implicit one included */
+  int emin; /* exponent of the smallest normal number */
+  int emax; /* exponent of the largest finite number */
+} ieee_format_desc_t;
+
+static const ieee_format_desc_t ieee_formats[IEEE_N_FORMATS] = {
+    {24, -126, 127}, /* fp32 */
+    {11, -14, 15},   /* fp16 */
+    {8, -126, 127},  /* bf16 */
+};
+
+/* Returns 1 if sig * 2^(e - mant_bits), with sig < 2^(mant_bits + 1), fits */
+/* <format>                                                                 */
+static inline int ieee_precision_fits_format(uint64_t sig, int e, int mant_bits,
+                                             const ieee_format_desc_t *format,
+                                             uint64_t ulps) {
+  if (e > format->emax)
+    return 0;
+  /* Significand bits dropped, more below the normal range of the format */
+  int d = mant_bits - (format->p - 1);
+  if (e < format->emin)
+    d += format->emin - e;
+  if (d <= 0)
+    return 1;
+  /* Past mant_bits + 1 every bit is dropped, 2^62 keeps dist == sig */
+  if (d > 62)
+    d = 62;
+  const uint64_t unit = 1ULL << d;
+  const uint64_t rem = sig & (unit - 1);
+  const uint64_t dist = (rem < unit - rem) ? rem : unit - rem;
+  return dist <= ulps;
+}
+
+/* Returns the mask of the formats the float of bit pattern <bits> fits */
+static inline unsigned ieee_precision_fits_binary32(uint32_t bits,
+                                                    uint64_t ulps) {
+  const uint32_t exp = (bits >> 23) & 0xff;
+  if (exp == 0xff || (bits & 0x7fffffff) == 0)
+    return IEEE_FORMAT_ALL_MASK;
+  const uint64_t sig = (bits & 0x7fffff) | (exp ? 0x800000 : 0);
+  const int e = (exp ? (int)exp : 1) - 127;
+  unsigned mask = IEEE_FORMAT_FLOAT_MASK;
+  for (int f = IEEE_FORMAT_FP16; f < IEEE_N_FORMATS; f++) {
+    if (ieee_precision_fits_format(sig, e, 23, &ieee_formats[f], ulps))
+      mask |= 1U << f;
+  }
+  return mask;
+}
+
+static inline unsigned ieee_precision_fits_binary64(uint64_t bits,
+                                                    uint64_t ulps) {
+  const uint64_t exp = (bits >> 52) & 0x7ff;
+  if (exp == 0x7ff || (bits & 0x7fffffffffffffffULL) == 0)
+    return IEEE_FORMAT_ALL_MASK;
+  const uint64_t sig = (bits & 0xfffffffffffffULL) | (exp ? 1ULL << 52 : 0);
+  const int e = (exp ? (int)exp : 1) - 1023;
+  unsigned mask = 0;
+  for (int f = 0; f < IEEE_N_FORMATS; f++) {
+    if (ieee_precision_fits_format(sig, e, 52, &ieee_formats[f], ulps))
+      mask |= 1U << f;
+  }
+  return mask;
+}
+
+#endif /* __PRECISION_H__ */
@@ -0,0 +1,20 @@
+/*****************************************************************************\
+ *                                                                           *\
+ *  This file is part of the Verificarlo project,                            *\
+ *  under the Apache License v2.0 with LLVM Exceptions.                      *\
+ *  SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception.                 *\
+ *  See https://llvm.org/LICENSE.txt for license information.                *\
+ *                                                                           *\
+ *  Copyright (c) 2019-2023                                                  *\
+ *     Verificarlo Contributors                                              *\
+ *                                                                           *\
+ ****************************************************************************/
+#include "probes.h"
+
+#if defined(HAVE_SYS_SDT_H)
+/* USDT semaphores, in the section the tracers expect. Linked in the */
+/* backend and in the tools built on the vbackend kernels            */
+unsigned short interflop_ieee_op_semaphore __attribute__((section(".probes")));
+unsigned short interflop_ieee_vector_semaphore
+    __attribute__((section(".probes")));
+#endif
@@ -0,0 +1,54 @@
+/*****************************************************************************\
+ *                                                                           *\
+ *  This file is part of the Verificarlo project,                            *\
+ *  under the Apache License v2.0 with LLVM Exceptions.                      *\
+ *  SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception.                 *\
+ *  See https://llvm.org/LICENSE.txt for license information.                *\
+ *                                                                           *\
+ *  Copyright (c) 2019-2023                                                  *\
+ *     Verificarlo Contributors                                              *\
+ *                                                                           *\
+ ****************************************************************************/
+#ifndef __PROBES_H__
+#define __PROBES_H__
+
+/* USDT static probes of the operations                                     */
+/* When the build finds <sys/sdt.h> (HAVE_SYS_SDT_H), the operations carry */
+/* probes of the provider interflop_ieee, each a note in the ELF file and  */
+/* a nop behind the test of its semaphore, which the tracers (bpftrace,    */
+/* perf, SystemTap) increment while attached. Until then the operations    */
+/* pay a load and a predicted branch, the operands are not moved:          */
+/*  - op(opcode, precision, predicate, a, b, c, result): scalar operation, */
+/*    with the fields of a trace record (trace.h), values as their bits    */
+/*  - vector(opcode, lanes, a, b, c): vbackend kernel on <lanes> floats,   */
+/*    with the addresses of the operands and of the result                 */
+/* Without <sys/sdt.h> the probes expand to nothing.                        */
+
+#if defined(HAVE_SYS_SDT_H)
+#define _SDT_HAS_SEMAPHORES 1
+#include <sys/sdt.h>
+
+/* Defined in probes.c, the names are the ones sys/sdt.h refers to */
+/* Hidden, the tracers find them from the notes of the probes             */
+extern unsigned short interflop_ieee_op_semaphore
+    __attribute__((visibility("hidden")));
+extern unsigned short interflop_ieee_vector_semaphore
+    __attribute__((visibility("hidden")));
+
+#define IEEE_PROBE_OP(opcode, precision, predicate, a, b, c, result)           \
+  do {                                                                         \
+    if (__builtin_expect(interflop_ieee_op_semaphore != 0, 0))                 \
+      STAP_PROBE7(interflop_ieee, op, opcode, precision, predicate, a, b, c,   \
+                  result);                                                     \
+  } while (0)
+#define IEEE_PROBE_VECTOR(opcode, lanes, a, b, c)                              \
+  do {                                                                         \
+    if (__builtin_expect(interflop_ieee_vector_semaphore != 0, 0))             \
+      STAP_PROBE5(interflop_ieee, vector, opcode, lanes, a, b, c);             \
+  } while (0)
+#else
+#define IEEE_PROBE_OP(opcode, precision, predicate, a, b, c, result)
+#define IEEE_PROBE_VECTOR(opcode, lanes, a, b, c)
+#endif
+
+#endif /* __PROBES_H__ */
@@ -0,0 +1,102 @@
+/*****************************************************************************\
+ *                                                                           *\
+ *  This file is part of the Verificarlo project,                            *\
+ *  under the Apache License v2.0 with LLVM Exceptions.                      *\
+ *  SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception.                 *\
+ *  See https://llvm.org/LICENSE.txt for license information.                *\
+ *                                                                           *\
+ *  Copyright (c) 2019-2023                                                  *\
+ *     Verificarlo Contributors                                              *\
+ *                                                                           *\
+ ****************************************************************************/
+#include <errno.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "interflop/interflop_stdlib.h"
+#include "report.h"
+
+/* Backend side of the reports, through the interflop stdlib wrappers. The */
+/* reader side, used by the tools, is in report_read.c                     */
+
+/* Longest "/.<host>.<pid>.report" or ".tmp" name appended to the directory */
+#define REPORT_NAME_MAX (IEEE_REPORT_HOST_MAX + 32)
+
+static struct timespec start_time;
+
+/* Environment variables holding the rank of the process, by launcher */
+static const char *const rank_variables[] = {
+    "OMPI_COMM_WORLD_RANK", /* Open MPI */
+    "PMI_RANK",             /* MPICH, Intel MPI */
+    "PMIX_RANK",            /* PMIx launchers */
+    "SLURM_PROCID",         /* srun */
+};
+
+void ieee_report_start(void) { clock_gettime(CLOCK_MONOTONIC, &start_time); }
+
+void ieee_report_identify(ieee_report_t *report) {
+  if (gethostname(report->host, sizeof(report->host)) != 0)
+    strcpy(report->host, "unknown");
+  report->host[sizeof(report->host) - 1] = '\0';
+  report->pid = getpid();
+
+  report->rank = -1;
+  for (size_t i = 0; i < sizeof(rank_variables) / sizeof(*rank_variables);
+       i++) {
+    const char *value = interflop_getenv(rank_variables[i]);
+    char *end;
+    if (value == NULL || *value == '\0')
+      continue;
+    const long long rank = strtoll(value, &end, 10);
+    if (*end == '\0' && rank >= 0) {
+      report->rank = rank;
+      break;
+    }
+  }
+
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  report->seconds = (now.tv_sec - start_time.tv_sec) +
+                    (now.tv_nsec - start_time.tv_nsec) * 1e-9;
+}
+
+int ieee_report_write(const char *dir, const ieee_report_t *report) {
+  /* The host name is bounded by IEEE_REPORT_HOST_MAX */
+  if (strlen(dir) > PATH_MAX - REPORT_NAME_MAX) {
+    errno = ENAMETOOLONG;
+    return -1;
+  }
+  char path[PATH_MAX], tmp[PATH_MAX];
+  interflop_sprintf(path, "%s/%s.%d" IEEE_REPORT_SUFFIX, dir, report->host,
+                    report->pid);
+  /* Without the suffix, readers skip it */
+  interflop_sprintf(tmp, "%s/.%s.%d.tmp", dir, report->host, report->pid);
+
+  int error = 0;
+  File *file = interflop_fopen(tmp, "w", &error);
+  if (file == NULL) {
+    errno = error;
+    return -1;
+  }
+  interflop_fprintf(file, IEEE_REPORT_HEADER "\n");
+  interflop_fprintf(file, "host %s\n", report->host);
+  interflop_fprintf(file, "pid %" PRId32 "\n", report->pid);
+  interflop_fprintf(file, "rank %" PRId64 "\n", report->rank);
+  interflop_fprintf(file, "seconds %.9g\n", report->seconds);
+  for (int i = 0; i < IEEE_REPORT_N_COUNTERS; i++)
+    interflop_fprintf(file, "%s %" PRIu64 "\n", ieee_report_counter_names[i],
+                      report->counters[i]);
+  if (interflop_fclose(file, &error) != 0 || rename(tmp, path) != 0) {
+    if (error == 0)
+      error = errno;
+    unlink(tmp);
+    errno = error;
+    return -1;
+  }
+  return 0;
+}
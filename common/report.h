@@ -0,0 +1,75 @@
+/*****************************************************************************\
+ *                                                                           *\
+ *  This file is part of the Verificarlo project,                            *\
+ *  under the Apache License v2.0 with LLVM Exceptions.                      *\
+ *  SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception.                 *\
+ *  See https://llvm.org/LICENSE.txt for license information.                *\
+ *                                                                           *\
+ *  Copyright (c) 2019-2023                                                  *\
+ *     Verificarlo Contributors                                              *\
+ *                                                                           *\
+ ****************************************************************************/
+#ifndef __REPORT_H__
+#define __REPORT_H__
+
+#include <stdint.h>
+
+/* Per-process report files of the --report-dir=<dir> option                */
+/*                                                                          */
+/* Each process writes <dir>/<hostname>.<pid>.report at finalize, a text    */
+/* file of "<key> <value>" lines:                                          */
+/*                                                                          */
+/*   # interflop-ieee report 1                                              */
+/*   host <hostname>                                                        */
+/*   pid <pid>                                                              */
+/*   rank <MPI rank, -1 if unknown>                                         */
+/*   seconds <wall time from init to finalize>                              */
+/*   <counter> <value>      for each of ieee_report_counter_names           */
+/*                                                                          */
+/* The file is written under a temporary name then renamed, so readers     */
+/* never see a partial report. Readers ignore unknown keys, new ones are   */
+/* only appended.                                                           */
+
+#define IEEE_REPORT_HEADER "# interflop-ieee report 1"
+#define IEEE_REPORT_SUFFIX ".report"
+#define IEEE_REPORT_HOST_MAX 256
+
+typedef enum {
+  IEEE_REPORT_MUL = 0,
+  IEEE_REPORT_DIV,
+  IEEE_REPORT_ADD,
+  IEEE_REPORT_SUB,
+  IEEE_REPORT_FMA,
+  IEEE_REPORT_FTZ,
+  IEEE_REPORT_DAZ,
+  IEEE_REPORT_N_COUNTERS
+} ieee_report_counter_t;
+
+static const char *const ieee_report_counter_names[IEEE_REPORT_N_COUNTERS] = {
+    "mul", "div", "add", "sub", "fma", "ftz", "daz"};
+
+typedef struct {
+  char host[IEEE_REPORT_HOST_MAX];
+  int32_t pid;
+  int64_t rank;
+  double seconds;
+  uint64_t counters[IEEE_REPORT_N_COUNTERS];
+} ieee_report_t;
+
+/* Backend side */
+
+/* Records the start of the process for the seconds field */
+void ieee_report_start(void);
+/* Fills the host, pid, rank and seconds fields of <report>. The rank is */
+/* read from OMPI_COMM_WORLD_RANK, PMI_RANK, PMIX_RANK or SLURM_PROCID  */
+void ieee_report_identify(ieee_report_t *report);
+/* Writes <report> in <dir>, returns 0 on success, -1 with errno set */
+int ieee_report_write(const char *dir, const ieee_report_t *report);
+
+/* Reader side, in report_read.c */
+
+/* Reads the report at <path>, returns 0 on success, -1 if it cannot be */
+/* opened or does not start with IEEE_REPORT_HEADER                    */
+int ieee_report_read(const char *path, ieee_report_t *report);
+
+#endif /* __REPORT_H__ */
@@ -0,0 +1,56 @@
+/*****************************************************************************\
+ *                                                                           *\
+ *  This file is part of the Verificarlo project,                            *\
+ *  under the Apache License v2.0 with LLVM Exceptions.                      *\
+ *  SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception.                 *\
+ *  See https://llvm.org/LICENSE.txt for license information.                *\
+ *                                                                           *\
+ *  Copyright (c) 2019-2023                                                  *\
+ *     Verificarlo Contributors                                              *\
+ *                                                                           *\
+ ****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "report.h"
+
+/* Reader side of the reports, for the tools: plain libc, no backend */
+
+int ieee_report_read(const char *path, ieee_report_t *report) {
+  FILE *file = fopen(path, "r");
+  if (file == NULL)
+    return -1;
+  memset(report, 0, sizeof(*report));
+  report->rank = -1;
+
+  char line[IEEE_REPORT_HOST_MAX + 64];
+  if (fgets(line, sizeof(line), file) == NULL ||
+      strncmp(line, IEEE_REPORT_HEADER, strlen(IEEE_REPORT_HEADER)) != 0) {
+    fclose(file);
+    return -1;
+  }
+  while (fgets(line, sizeof(line), file) != NULL) {
+    char *value = strchr(line, ' ');
+    if (value == NULL)
+      continue;
+    *value++ = '\0';
+    value[strcspn(value, "\n")] = '\0';
+    if (strcmp(line, "host") == 0) {
+      snprintf(report->host, sizeof(report->host), "%s", value);
+    } else if (strcmp(line, "pid") == 0) {
+      report->pid = (int32_t)strtol(value, NULL, 10);
+    } else if (strcmp(line, "rank") == 0) {
+      report->rank = strtoll(value, NULL, 10);
+    } else if (strcmp(line, "seconds") == 0) {
+      report->seconds = strtod(value, NULL);
+    } else {
+      for (int i = 0; i < IEEE_REPORT_N_COUNTERS; i++) {
+        if (strcmp(line, ieee_report_counter_names[i]) == 0)
+          report->counters[i] = strtoull(value, NULL, 10);
+      }
+    }
+  }
+  fclose(file);
+  return 0;
+}
@@ -0,0 +1,124 @@
+/*****************************************************************************\
+ *                                                                           *\
+ *  This file is part of the Verificarlo project,                            *\
+ *  under the Apache License v2.0 with LLVM Exceptions.                      *\
+ *  SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception.                 *\
+ *  See https://llvm.org/LICENSE.txt for license information.                *\
+ *                                                                           *\
+ *  Copyright (c) 2019-2023                                                  *\
+ *     Verificarlo Contributors                                              *\
+ *                                                                           *\
+ ****************************************************************************/
+#include <fcntl.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "interflop/interflop_stdlib.h"
+#include "shm_stats.h"
+
+static ieee_shm_stats_header_t *shm_header = NULL;
+static ieee_shm_stats_slot_t *shm_slots = NULL;
+
+__thread ieee_shm_stats_slot_t *ieee_shm_stats_thread_slot = NULL;
+ieee_shm_stats_slot_t *ieee_shm_stats_shared_slot = NULL;
+
+int ieee_shm_stats_open(const char *name) {
+  char path[256];
+  const size_t size = IEEE_SHM_STATS_SIZE(IEEE_SHM_STATS_MAX_THREADS);
+
+  /* shm_open names must start with a single '/' */
+  path[0] = '/';
+  strncpy(path + 1, (name[0] == '/') ? name + 1 : name, sizeof(path) - 2);
+  path[sizeof(path) - 1] = '\0';
+
+  const int fd = shm_open(path, O_CREAT | O_RDWR | O_TRUNC, 0644);
+  if (fd == -1) {
+    return -1;
+  }
+  if (ftruncate(fd, size) != 0) {
+    close(fd);
+    return -1;
+  }
+  void *p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (p == MAP_FAILED) {
+    return -1;
+  }
+
+  /* ftruncate zero-fills the segment, only the header needs to be set */
+  shm_header = (ieee_shm_stats_header_t *)p;
+  shm_slots = (ieee_shm_stats_slot_t *)((char *)p + sizeof(*shm_header));
+  ieee_shm_stats_shared_slot = &shm_slots[IEEE_SHM_STATS_MAX_THREADS - 1];
+
+  struct timespec now;
+  clock_gettime(CLOCK_REALTIME, &now);
+  shm_header->version = IEEE_SHM_STATS_VERSION;
+  shm_header->header_size = sizeof(ieee_shm_stats_header_t);
+  shm_header->slot_size = sizeof(ieee_shm_stats_slot_t);
+  shm_header->max_threads = IEEE_SHM_STATS_MAX_THREADS;
+  shm_header->n_counters = IEEE_SHM_STATS_N_COUNTERS;
+  shm_header->pid = getpid();
+  shm_header->start_time_ns =
+      (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+  /* The magic is written last so readers never see a partial header */
+  __atomic_store_n(&shm_header->magic, IEEE_SHM_STATS_MAGIC, __ATOMIC_RELEASE);
+  return 0;
+}
+
+ieee_shm_stats_slot_t *ieee_shm_stats_reserve_slot(void) {
+  uint32_t index =
+      __atomic_fetch_add(&shm_header->n_threads, 1, __ATOMIC_RELAXED);
+  if (index >= IEEE_SHM_STATS_MAX_THREADS - 1) {
+    /* Keep n_threads bounded, all late threads share the last slot */
+    __atomic_store_n(&shm_header->n_threads, IEEE_SHM_STATS_MAX_THREADS,
+                     __ATOMIC_RELAXED);
+    index = IEEE_SHM_STATS_MAX_THREADS - 1;
+    ieee_shm_stats_shared_slot->tid = -1;
+  } else {
+    shm_slots[index].tid = interflop_gettid();
+  }
+  ieee_shm_stats_thread_slot = &shm_slots[index];
+  return ieee_shm_stats_thread_slot;
+}
+
+void ieee_shm_stats_totals(uint64_t totals[IEEE_SHM_STATS_N_COUNTERS]) {
+  memset(totals, 0, IEEE_SHM_STATS_N_COUNTERS * sizeof(uint64_t));
+  if (shm_header == NULL) {
+    return;
+  }
+  uint32_t n_threads =
+      __atomic_load_n(&shm_header->n_threads, __ATOMIC_RELAXED);
+  if (n_threads > IEEE_SHM_STATS_MAX_THREADS) {
+    n_threads = IEEE_SHM_STATS_MAX_THREADS;
+  }
+  for (uint32_t i = 0; i < n_threads; i++) {
+    for (int c = 0; c < IEEE_SHM_STATS_N_COUNTERS; c++) {
+      totals[c] += __atomic_load_n(&shm_slots[i].counters[c], __ATOMIC_RELAXED);
+    }
+  }
+}
+
+void ieee_shm_stats_reset(void) {
+  if (shm_header == NULL) {
+    return;
+  }
+  uint32_t n_threads =
+      __atomic_load_n(&shm_header->n_threads, __ATOMIC_RELAXED);
+  if (n_threads > IEEE_SHM_STATS_MAX_THREADS) {
+    n_threads = IEEE_SHM_STATS_MAX_THREADS;
+  }
+  for (uint32_t i = 0; i < n_threads; i++) {
+    for (int c = 0; c < IEEE_SHM_STATS_N_COUNTERS; c++) {
+      __atomic_store_n(&shm_slots[i].counters[c], 0, __ATOMIC_RELAXED);
+    }
+  }
+}
+
+void ieee_shm_stats_finish(void) {
+  if (shm_header != NULL) {
+    __atomic_store_n(&shm_header->finished, 1, __ATOMIC_RELEASE);
+  }
+}
@@ -0,0 +1,104 @@
+/*****************************************************************************\
+ *                                                                           *\
+ *  This file is part of the Verificarlo project,                            *\
+ *  under the Apache License v2.0 with LLVM Exceptions.                      *\
+ *  SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception.                 *\
+ *  See https://llvm.org/LICENSE.txt for license information.                *\
+ *                                                                           *\
+ *  Copyright (c) 2019-2023                                                  *\
+ *     Verificarlo Contributors                                              *\
+ *                                                                           *\
+ ****************************************************************************/
+#ifndef __SHM_STATS_H__
+#define __SHM_STATS_H__
+
+#include <stdint.h>
+
+/* Layout of the --shm-stats=<name> segment, mapped at /dev/shm/<name>      */
+/*                                                                          */
+/*   offset 0                 ieee_shm_stats_header_t (64 bytes)            */
+/*   offset 64 + i * 64       ieee_shm_stats_slot_t of thread i             */
+/*                            for i in [0, header.max_threads)              */
+/*                                                                          */
+/* All fields are little-endian naturally aligned integers. A slot is owned */
+/* by one thread which updates its counters with plain 64-bit stores, so    */
+/* readers see each counter atomically but counters of a slot may be from   */
+/* slightly different instants. Slots are handed out in order, only the     */
+/* first header.n_threads ones are in use. The last slot is shared by all   */
+/* the threads past max_threads - 1 and is updated with atomic adds.        */
+/* Readers must check magic and version and ignore the segment otherwise.   */
+/* Fields are only appended in a new version, with slot_size growing.       */
+
+#define IEEE_SHM_STATS_MAGIC 0x5354415445454549ULL /* "IEEESTAT" */
+#define IEEE_SHM_STATS_VERSION 1
+#define IEEE_SHM_STATS_MAX_THREADS 1024
+
+typedef enum {
+  IEEE_SHM_STATS_MUL = 0,
+  IEEE_SHM_STATS_DIV,
+  IEEE_SHM_STATS_ADD,
+  IEEE_SHM_STATS_SUB,
+  IEEE_SHM_STATS_FMA,
+  IEEE_SHM_STATS_N_COUNTERS
+} ieee_shm_stats_counter_t;
+
+typedef struct {
+  uint64_t magic;        /* IEEE_SHM_STATS_MAGIC */
+  uint32_t version;      /* IEEE_SHM_STATS_VERSION */
+  uint32_t header_size;  /* sizeof(ieee_shm_stats_header_t) */
+  uint32_t slot_size;    /* sizeof(ieee_shm_stats_slot_t) */
+  uint32_t max_threads;  /* number of slots */
+  uint32_t n_counters;   /* IEEE_SHM_STATS_N_COUNTERS */
+  uint32_t n_threads;    /* slots in use, only grows */
+  int32_t pid;           /* process owning the segment */
+  uint32_t finished;     /* set to 1 by finalize */
+  uint64_t start_time_ns; /* CLOCK_REALTIME at creation */
+  uint8_t reserved[16];
+} ieee_shm_stats_header_t;
+
+typedef struct {
+  int32_t tid; /* owning thread */
+  uint32_t reserved;
+  uint64_t counters[IEEE_SHM_STATS_N_COUNTERS]; /* mul, div, add, sub, fma */
+  uint8_t padding[16];
+} ieee_shm_stats_slot_t;
+
+_Static_assert(sizeof(ieee_shm_stats_header_t) == 64, "header layout");
+_Static_assert(sizeof(ieee_shm_stats_slot_t) == 64, "slot layout");
+
+#define IEEE_SHM_STATS_SIZE(max_threads)                                       \
+  (sizeof(ieee_shm_stats_header_t) +                                           \
+   (max_threads) * sizeof(ieee_shm_stats_slot_t))
+
+/* Backend side */
+
+/* Creates and maps the segment /dev/shm/<name>, returns 0 on success */
+int ieee_shm_stats_open(const char *name);
+/* Reserves a slot for the calling thread */
+ieee_shm_stats_slot_t *ieee_shm_stats_reserve_slot(void);
+/* Sums the counters of every slot into <totals> */
+void ieee_shm_stats_totals(uint64_t totals[IEEE_SHM_STATS_N_COUNTERS]);
+/* Zeroes the counters of every slot. Increments racing with the reset */
+/* may be kept or lost                                                 */
+void ieee_shm_stats_reset(void);
+/* Marks the segment as finished, the segment is kept for late readers */
+void ieee_shm_stats_finish(void);
+
+extern __thread ieee_shm_stats_slot_t *ieee_shm_stats_thread_slot;
+extern ieee_shm_stats_slot_t *ieee_shm_stats_shared_slot;
+
+/* Increments <counter> in the slot of the calling thread */
+static inline void ieee_shm_stats_increment(ieee_shm_stats_counter_t counter) {
+  ieee_shm_stats_slot_t *slot = ieee_shm_stats_thread_slot;
+  if (__builtin_expect(slot == NULL, 0)) {
+    slot = ieee_shm_stats_reserve_slot();
+  }
+  if (__builtin_expect(slot == ieee_shm_stats_shared_slot, 0)) {
+    __atomic_add_fetch(&slot->counters[counter], 1, __ATOMIC_RELAXED);
+  } else {
+    __atomic_store_n(&slot->counters[counter], slot->counters[counter] + 1,
+                     __ATOMIC_RELAXED);
+  }
+}
+
+#endif /* __SHM_STATS_H__ */
@@ -0,0 +1,102 @@
+/*****************************************************************************\
+ *                                                                           *\
+ *  This file is part of the Verificarlo project,                            *\
+ *  under the Apache License v2.0 with LLVM Exceptions.                      *\
+ *  SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception.                 *\
+ *  See https://llvm.org/LICENSE.txt for license information.                *\
+ *                                                                           *\
+ *  Copyright (c) 2019-2023                                                  *\
+ *     Verificarlo Contributors                                              *\
+ *                                                                           *\
+ ****************************************************************************/
+#ifndef __SIGNAL_OUTPUT_H__
+#define __SIGNAL_OUTPUT_H__
+
+#include <fcntl.h>
+#include <signal.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "hex_float.h"
+
+/* Output usable in signal handlers, for --trap and --flight-recorder     */
+/* Lines are built in a caller buffer with the ieee_put_* functions, which */
+/* return the end of what they wrote, then written with one write(2), no  */
+/* stdio, allocation nor dladdr. Code addresses are printed raw, with the */
+/* executable mappings of the process to resolve them offline             */
+
+static inline char *ieee_put_str(char *out, const char *s) {
+  const size_t len = strlen(s);
+  memcpy(out, s, len);
+  return out + len;
+}
+
+static inline char *ieee_put_hex(char *out, uint64_t v) {
+  const unsigned n_digits = (v == 0) ? 1 : (64 - __builtin_clzll(v) + 3) / 4;
+  out = ieee_put_str(out, "0x");
+  for (int i = n_digits - 1; i >= 0; i--)
+    *out++ = ieee_hex_digits[(v >> (4 * i)) & 0xf];
+  return out;
+}
+
+/* Runs the handler of the <previous> disposition of <sig>, for the     */
+/* handlers of the backend installed over the ones of the application. */
+/* Returns 0 without running anything if it is SIG_DFL or SIG_IGN      */
+static inline int ieee_signal_forward(const struct sigaction *previous,
+                                      int sig, siginfo_t *info,
+                                      void *context) {
+  if (previous->sa_flags & SA_SIGINFO) {
+    previous->sa_sigaction(sig, info, context);
+    return 1;
+  }
+  if (previous->sa_handler == SIG_DFL || previous->sa_handler == SIG_IGN)
+    return 0;
+  previous->sa_handler(sig);
+  return 1;
+}
+
+static inline void ieee_write_line(const char *line, const char *end) {
+  while (line < end) {
+    const ssize_t n = write(STDERR_FILENO, line, end - line);
+    if (n <= 0)
+      return;
+    line += n;
+  }
+}
+
+#define IEEE_MAPS_LINE_MAX 256
+
+/* Writes the executable mappings of /proc/self/maps, prefixed by <prefix>, */
+/* so that an address A of the output in the mapping start-end at offset O */
+/* of an object resolves with addr2line -e object A-start+O. Lines longer  */
+/* than IEEE_MAPS_LINE_MAX are truncated                                   */
+static inline void ieee_write_maps(const char *prefix) {
+  const int fd = open("/proc/self/maps", O_RDONLY);
+  if (fd < 0)
+    return;
+  char buffer[512];
+  char line[IEEE_MAPS_LINE_MAX];
+  char *const start = ieee_put_str(line, prefix);
+  char *out = start;
+  ssize_t n;
+  while ((n = read(fd, buffer, sizeof(buffer))) > 0) {
+    for (ssize_t i = 0; i < n; i++) {
+      if (buffer[i] != '\n') {
+        if (out < line + sizeof(line) - 1)
+          *out++ = buffer[i];
+        continue;
+      }
+      /* start-end perms ..., executable if perms is r-x? or --x? */
+      const char *perms = memchr(start, ' ', out - start);
+      if (perms != NULL && out - perms > 3 && perms[3] == 'x') {
+        *out++ = '\n';
+        ieee_write_line(line, out);
+      }
+      out = start;
+    }
+  }
+  close(fd);
+}
+
+#endif /* __SIGNAL_OUTPUT_H__ */
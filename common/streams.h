@@ -0,0 +1,55 @@
+/*****************************************************************************\
+ *                                                                           *\
+ *  This file is part of the Verificarlo project,                            *\
+ *  under the Apache License v2.0 with LLVM Exceptions.                      *\
+ *  SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception.                 *\
+ *  See https://llvm.org/LICENSE.txt for license information.                *\
+ *                                                                           *\
+ *  Copyright (c) 2019-2023                                                  *\
+ *     Verificarlo Contributors                                              *\
+ *                                                                           *\
+ ****************************************************************************/
+#ifndef __STREAMS_H__
+#define __STREAMS_H__
+
+#include "trace.h"
+
+/* Operation streams, the entry points of the backend told apart by the    */
+/* per-operation profiles: the scalar operations, indexed by               */
+/* ieee_trace_opcode_t and ieee_trace_precision_t, then the vector kernels */
+/* of add, sub, mul and div, indexed by opcode and width                   */
+
+#define IEEE_SCALAR_STREAMS (IEEE_TRACE_N_OPCODES * 2)
+#define IEEE_STREAMS (IEEE_SCALAR_STREAMS + 4 * 4)
+
+static inline unsigned ieee_stream_scalar(unsigned opcode, unsigned precision) {
+  return opcode * 2 + precision;
+}
+
+static inline unsigned ieee_stream_vector(unsigned opcode, unsigned lanes) {
+  const unsigned width = (lanes == 1)   ? 0
+                         : (lanes == 4) ? 1
+                         : (lanes == 8) ? 2
+                                        : 3;
+  return IEEE_SCALAR_STREAMS + opcode * 4 + width;
+}
+
+static inline unsigned ieee_stream_opcode(unsigned stream) {
+  return (stream < IEEE_SCALAR_STREAMS) ? stream / 2
+                                        : (stream - IEEE_SCALAR_STREAMS) / 4;
+}
+
+/* Precision of the operands, vector kernels are float ones */
+static inline unsigned ieee_stream_precision(unsigned stream) {
+  return (stream < IEEE_SCALAR_STREAMS) ? stream % 2 : IEEE_TRACE_FLOAT;
+}
+
+/* Lanes of a vector kernel, 0 for the scalar operations */
+static inline unsigned ieee_stream_lanes(unsigned stream) {
+  static const unsigned lanes[] = {1, 4, 8, 16};
+  return (stream < IEEE_SCALAR_STREAMS)
+             ? 0
+             : lanes[(stream - IEEE_SCALAR_STREAMS) % 4];
+}
+
+#endif /* __STREAMS_H__ */
@@ -0,0 +1,51 @@
+/*****************************************************************************\
+ *                                                                           *\
+ *  This file is part of the Verificarlo project,                            *\
+ *  under the Apache License v2.0 with LLVM Exceptions.                      *\
+ *  SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception.                 *\
+ *  See https://llvm.org/LICENSE.txt for license information.                *\
+ *                                                                           *\
+ *  Copyright (c) 2019-2023                                                  *\
+ *     Verificarlo Contributors                                              *\
+ *                                                                           *\
+ ****************************************************************************/
+#ifndef __SUBNORMAL_H__
+#define __SUBNORMAL_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Subnormal penalty profiler (--subnormal-profile)                         */
+/* Operations with a subnormal operand or result are counted per call site */
+/* (call_sites.h). A value is tested with one comparison on its bits: its  */
+/* magnitude minus one is below the significand mask for subnormals only,  */
+/* zero wrapping around. The vector kernels test whole registers and check */
+/* the mask of the lanes once per call.                                     */
+/* One subnormal operation or call out of IEEE_SUBNORMAL_PERIOD per thread  */
+/* is replayed between reads of the time stamp counter, with its operands  */
+/* then with normal ones (1.0). The difference of the two estimates the    */
+/* cycles of the microcode assists the subnormals cost.                     */
+
+#define IEEE_SUBNORMAL_PERIOD 61
+
+static inline int ieee_subnormal_binary32(uint32_t bits) {
+  return (uint32_t)((bits & 0x7fffffff) - 1) < 0x007fffff;
+}
+
+static inline int ieee_subnormal_binary64(uint64_t bits) {
+  return ((bits & 0x7fffffffffffffffULL) - 1) < 0x000fffffffffffffULL;
+}
+
+/* Subnormal operations left before the next replay of the thread */
+extern __thread uint32_t ieee_subnormal_countdown
+    __attribute__((tls_model("initial-exec")));
+
+/* Returns true if the current subnormal operation is to be replayed */
+static inline bool ieee_subnormal_sample(void) {
+  if (--ieee_subnormal_countdown != 0)
+    return false;
+  ieee_subnormal_countdown = IEEE_SUBNORMAL_PERIOD;
+  return true;
+}
+
+#endif /* __SUBNORMAL_H__ */
@@ -0,0 +1,104 @@
+/*****************************************************************************\
+ *                                                                           *\
+ *  This file is part of the Verificarlo project,                            *\
+ *  under the Apache License v2.0 with LLVM Exceptions.                      *\
+ *  SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception.                 *\
+ *  See https://llvm.org/LICENSE.txt for license information.                *\
+ *                                                                           *\
+ *  Copyright (c) 2019-2023                                                  *\
+ *     Verificarlo Contributors                                              *\
+ *                                                                           *\
+ ****************************************************************************/
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+#include <stdint.h>
+
+/* Layout of a per-operation trace file                                     */
+/*                                                                          */
+/*   offset 0                 ieee_trace_header_t (64 bytes)                */
+/*   offset 64 + i * 40       ieee_trace_record_t of operation i            */
+/*                                                                          */
+/* All fields are little-endian naturally aligned integers. Floating-point */
+/* values are stored as their bit patterns, a float in the low 32 bits of  */
+/* its 64-bit field. header.n_records is the number of records, padding    */
+/* included, or 0 when the writer did not finish and the records go up to  */
+/* the end of the file. Every record written has IEEE_TRACE_WRITTEN in     */
+/* its flags: in an unfinished trace, the zeroed records of the segments   */
+/* and of the preallocated end of the file were never written and readers  */
+/* skip them.                                                               */
+/* Readers must check magic and version and ignore the file otherwise.     */
+/* Fields are only appended in a new version, with record_size growing.    */
+/*                                                                          */
+/* XOR-compressed traces (magic IEEE_TRACE_XOR_MAGIC) have the same header */
+/* followed by blocks instead of raw records:                              */
+/*                                                                          */
+/*   ieee_trace_block_header_t (16 bytes)                                   */
+/*   n_bytes of encoded records, n_bytes being a multiple of 8              */
+/*                                                                          */
+/* Each block holds consecutive records of one thread and is decoded on    */
+/* its own, see common/trace_codec.h for the encoding.                     */
+
+#define IEEE_TRACE_MAGIC 0x4341525445454549ULL     /* "IEEETRAC" */
+#define IEEE_TRACE_XOR_MAGIC 0x5843525445454549ULL /* "IEEETRCX" */
+#define IEEE_TRACE_VERSION 2
+
+typedef enum {
+  IEEE_TRACE_ADD = 0,
+  IEEE_TRACE_SUB,
+  IEEE_TRACE_MUL,
+  IEEE_TRACE_DIV,
+  IEEE_TRACE_CMP,  /* result is the int returned by the comparison */
+  IEEE_TRACE_CAST, /* double operand, float result */
+  IEEE_TRACE_FMA,
+  IEEE_TRACE_N_OPCODES
+} ieee_trace_opcode_t;
+
+/* Names of the opcodes, for the backend outputs and the tools */
+static const char *const ieee_trace_opcode_names[IEEE_TRACE_N_OPCODES] = {
+    "add", "sub", "mul", "div", "cmp", "cast", "fma"};
+
+/* Opcode of the padding records left by the memory-mapped writer at the  */
+/* end of partially filled segments, readers skip them                   */
+#define IEEE_TRACE_PAD 0xff
+
+/* Flag set in every record by the writer */
+#define IEEE_TRACE_WRITTEN 0x1
+
+typedef enum {
+  IEEE_TRACE_FLOAT = 0,
+  IEEE_TRACE_DOUBLE,
+} ieee_trace_precision_t;
+
+typedef struct {
+  uint64_t magic;       /* IEEE_TRACE_MAGIC */
+  uint32_t version;     /* IEEE_TRACE_VERSION */
+  uint32_t header_size; /* sizeof(ieee_trace_header_t) */
+  uint32_t record_size; /* sizeof(ieee_trace_record_t) */
+  uint32_t reserved0;
+  uint64_t n_records; /* 0 if unknown */
+  uint8_t reserved[32];
+} ieee_trace_header_t;
+
+typedef struct {
+  uint8_t opcode;       /* ieee_trace_opcode_t */
+  uint8_t precision;    /* ieee_trace_precision_t of the operands */
+  uint8_t predicate;    /* enum FCMP_PREDICATE of IEEE_TRACE_CMP */
+  uint8_t flags;        /* IEEE_TRACE_WRITTEN */
+  uint8_t reserved[4];
+  uint64_t operands[3]; /* a, b, c; unused ones are zero */
+  uint64_t result;
+} ieee_trace_record_t;
+
+typedef struct {
+  uint32_t n_records; /* records encoded in the block */
+  uint32_t n_bytes;   /* size of the encoded records */
+  int32_t tid;        /* thread which executed the operations */
+  uint32_t reserved;
+} ieee_trace_block_header_t;
+
+_Static_assert(sizeof(ieee_trace_header_t) == 64, "header layout");
+_Static_assert(sizeof(ieee_trace_record_t) == 40, "record layout");
+_Static_assert(sizeof(ieee_trace_block_header_t) == 16, "block layout");
+
+#endif /* __TRACE_H__ */
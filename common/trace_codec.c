@@ -0,0 +1,209 @@
+/*****************************************************************************\
+ *                                                                           *\
+ *  This file is part of the Verificarlo project,                            *\
+ *  under the Apache License v2.0 with LLVM Exceptions.                      *\
+ *  SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception.                 *\
+ *  See https://llvm.org/LICENSE.txt for license information.                *\
+ *                                                                           *\
+ *  Copyright (c) 2019-2023                                                  *\
+ *     Verificarlo Contributors                                              *\
+ *                                                                           *\
+ ****************************************************************************/
+#include <string.h>
+
+#include "trace_codec.h"
+
+/* Values per record: up to three operands and the result */
+#define N_SLOTS 4
+#define NO_WINDOW 0xff
+
+typedef struct {
+  uint64_t prev;
+  uint8_t lz; /* window of the last '11' value, NO_WINDOW if none */
+  uint8_t tz;
+} predictor_t;
+
+typedef predictor_t predictors_t[IEEE_TRACE_N_OPCODES][2][N_SLOTS];
+
+static const int n_operands[IEEE_TRACE_N_OPCODES] = {2, 2, 2, 2, 2, 1, 3};
+
+static void reset_predictors(predictors_t p) {
+  memset(p, 0, sizeof(predictors_t));
+  for (int op = 0; op < IEEE_TRACE_N_OPCODES; op++)
+    for (int prec = 0; prec < 2; prec++)
+      for (int slot = 0; slot < N_SLOTS; slot++)
+        p[op][prec][slot].lz = NO_WINDOW;
+}
+
+/* Width in bits of the value in <slot> of a record (slot 3 is the result) */
+static inline unsigned value_width(unsigned opcode, unsigned precision,
+                                   unsigned slot) {
+  if (slot == N_SLOTS - 1 &&
+      (opcode == IEEE_TRACE_CMP || opcode == IEEE_TRACE_CAST))
+    return 32;
+  return (precision == IEEE_TRACE_DOUBLE) ? 64 : 32;
+}
+
+static inline uint64_t low_mask(unsigned nbits) {
+  return (nbits == 64) ? ~0ULL : (1ULL << nbits) - 1;
+}
+
+/* Bit stream writer, bits are appended above the ones already written */
+
+typedef struct {
+  uint64_t acc;
+  unsigned n; /* bits in acc, always < 64 */
+  uint8_t *out;
+} bit_writer_t;
+
+/* Writes the <nbits> low bits of <v>, 1 <= nbits <= 64, v has no other */
+static inline void put_bits(bit_writer_t *w, uint64_t v, unsigned nbits) {
+  const unsigned room = 64 - w->n;
+  w->acc |= v << w->n;
+  if (nbits < room) {
+    w->n += nbits;
+    return;
+  }
+  memcpy(w->out, &w->acc, sizeof(w->acc));
+  w->out += sizeof(w->acc);
+  w->acc = (room == 64) ? 0 : v >> room;
+  w->n = nbits - room;
+}
+
+typedef struct {
+  uint64_t acc;
+  unsigned n; /* bits left in acc */
+  const uint8_t *in;
+  const uint8_t *end;
+  int error;
+} bit_reader_t;
+
+static inline uint64_t get_bits(bit_reader_t *r, unsigned nbits) {
+  if (nbits <= r->n) {
+    const uint64_t v = r->acc & low_mask(nbits);
+    r->acc = (nbits == 64) ? 0 : r->acc >> nbits;
+    r->n -= nbits;
+    return v;
+  }
+  uint64_t next = 0;
+  if (r->in + sizeof(next) <= r->end) {
+    memcpy(&next, r->in, sizeof(next));
+    r->in += sizeof(next);
+  } else {
+    r->error = 1;
+  }
+  const unsigned rest = nbits - r->n;
+  const uint64_t v = r->acc | ((next & low_mask(rest)) << r->n);
+  r->acc = (rest == 64) ? 0 : next >> rest;
+  r->n = 64 - rest;
+  return v;
+}
+
+static inline void encode_value(bit_writer_t *w, predictor_t *p, uint64_t v,
+                                unsigned width) {
+  const uint64_t x = v ^ p->prev;
+  p->prev = v;
+  if (x == 0) {
+    put_bits(w, 0, 1);
+    return;
+  }
+  const unsigned lz = __builtin_clzll(x) - (64 - width);
+  const unsigned tz = __builtin_ctzll(x);
+  if (p->lz != NO_WINDOW && lz >= p->lz && tz >= p->tz) {
+    /* '10' is written as 0b01, the first bit read is the low one */
+    put_bits(w, 0x1, 2);
+    put_bits(w, x >> p->tz, width - p->lz - p->tz);
+    return;
+  }
+  const unsigned len_bits = (width == 64) ? 6 : 5;
+  const unsigned len = width - lz - tz;
+  put_bits(w, 0x3, 2);
+  put_bits(w, lz, len_bits);
+  put_bits(w, len - 1, len_bits);
+  put_bits(w, x >> tz, len);
+  p->lz = lz;
+  p->tz = tz;
+}
+
+static inline uint64_t decode_value(bit_reader_t *r, predictor_t *p,
+                                    unsigned width) {
+  if (get_bits(r, 1) == 0)
+    return p->prev;
+  uint64_t x;
+  if (get_bits(r, 1) == 0) {
+    if (p->lz == NO_WINDOW) {
+      r->error = 1;
+      return 0;
+    }
+    x = get_bits(r, width - p->lz - p->tz) << p->tz;
+  } else {
+    const unsigned len_bits = (width == 64) ? 6 : 5;
+    const unsigned lz = get_bits(r, len_bits);
+    const unsigned len = get_bits(r, len_bits) + 1;
+    if (lz + len > width) {
+      r->error = 1;
+      return 0;
+    }
+    const unsigned tz = width - lz - len;
+    x = get_bits(r, len) << tz;
+    p->lz = lz;
+    p->tz = tz;
+  }
+  p->prev ^= x;
+  return p->prev;
+}
+
+size_t ieee_trace_encode(const ieee_trace_record_t *records, size_t n,
+                         uint8_t *out) {
+  predictors_t predictors;
+  reset_predictors(predictors);
+  bit_writer_t w = {0, 0, out};
+
+  for (size_t i = 0; i < n; i++) {
+    const ieee_trace_record_t *rec = &records[i];
+    const unsigned op = rec->opcode, prec = rec->precision;
+    put_bits(&w, op, 3);
+    put_bits(&w, prec, 1);
+    if (op == IEEE_TRACE_CMP)
+      put_bits(&w, rec->predicate, 4);
+    for (int slot = 0; slot < n_operands[op]; slot++) {
+      encode_value(&w, &predictors[op][prec][slot], rec->operands[slot],
+                   value_width(op, prec, slot));
+    }
+    encode_value(&w, &predictors[op][prec][N_SLOTS - 1], rec->result,
+                 value_width(op, prec, N_SLOTS - 1));
+  }
+
+  if (w.n > 0) {
+    memcpy(w.out, &w.acc, sizeof(w.acc));
+    w.out += sizeof(w.acc);
+  }
+  return (size_t)(w.out - out);
+}
+
+int ieee_trace_decode(const uint8_t *in, size_t size,
+                      ieee_trace_record_t *records, size_t n) {
+  predictors_t predictors;
+  reset_predictors(predictors);
+  bit_reader_t r = {0, 0, in, in + size, 0};
+
+  for (size_t i = 0; i < n && !r.error; i++) {
+    ieee_trace_record_t *rec = &records[i];
+    memset(rec, 0, sizeof(*rec));
+    const unsigned op = get_bits(&r, 3);
+    const unsigned prec = get_bits(&r, 1);
+    if (op >= IEEE_TRACE_N_OPCODES)
+      return -1;
+    rec->opcode = op;
+    rec->precision = prec;
+    if (op == IEEE_TRACE_CMP)
+      rec->predicate = get_bits(&r, 4);
+    for (int slot = 0; slot < n_operands[op]; slot++) {
+      rec->operands[slot] = decode_value(&r, &predictors[op][prec][slot],
+                                         value_width(op, prec, slot));
+    }
+    rec->result = decode_value(&r, &predictors[op][prec][N_SLOTS - 1],
+                               value_width(op, prec, N_SLOTS - 1));
+  }
+  return r.error ? -1 : 0;
+}
@@ -0,0 +1,50 @@
+/*****************************************************************************\
+ *                                                                           *\
+ *  This file is part of the Verificarlo project,                            *\
+ *  under the Apache License v2.0 with LLVM Exceptions.                      *\
+ *  SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception.                 *\
+ *  See https://llvm.org/LICENSE.txt for license information.                *\
+ *                                                                           *\
+ *  Copyright (c) 2019-2023                                                  *\
+ *     Verificarlo Contributors                                              *\
+ *                                                                           *\
+ ****************************************************************************/
+#ifndef __TRACE_CODEC_H__
+#define __TRACE_CODEC_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "trace.h"
+
+/* XOR encoding of trace records, in the style of Gorilla                   */
+/*                                                                          */
+/* Records are written as a little-endian bit stream:                       */
+/*   opcode (3 bits), precision (1 bit), predicate (4 bits, cmp only)       */
+/*   then each operand and the result, in that order                        */
+/* Every value is XORed with the previous value of the same stream, i.e.    */
+/* the same opcode, precision and operand position. With x the XOR:         */
+/*   '0'                          x == 0, value repeated                     */
+/*   '10' bits                    the meaningful bits of x fit the window   */
+/*                                (leading/trailing zeros) of the stream,   */
+/*                                only the window is written                */
+/*   '11' lz len-1 bits           new window: leading zeros and length of   */
+/*                                the meaningful bits (5+5 bits for 32-bit  */
+/*                                values, 6+6 for 64-bit ones), then them   */
+/* Floats, the float result of a cast and the int result of a comparison   */
+/* are 32-bit values. The predictors start from zero in each block.         */
+
+/* Upper bound of the encoded size of <n> records: 8 + 4 * 78 bits per     */
+/* record rounded up, and the final padding to 8 bytes                      */
+#define IEEE_TRACE_ENCODE_BOUND(n) ((size_t)(n) * 40 + 8)
+
+/* Encodes <n> records in <out>, returns the size written, a multiple of 8 */
+size_t ieee_trace_encode(const ieee_trace_record_t *records, size_t n,
+                         uint8_t *out);
+
+/* Decodes <n> records from the <size> bytes at <in>                        */
+/* Returns 0 on success, -1 if the block is truncated or corrupted          */
+int ieee_trace_decode(const uint8_t *in, size_t size,
+                      ieee_trace_record_t *records, size_t n);
+
+#endif /* __TRACE_CODEC_H__ */
@@ -0,0 +1,412 @@
+/*****************************************************************************\
+ *                                                                           *\
+ *  This file is part of the Verificarlo project,                            *\
+ *  under the Apache License v2.0 with LLVM Exceptions.                      *\
+ *  SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception.                 *\
+ *  See https://llvm.org/LICENSE.txt for license information.                *\
+ *                                                                           *\
+ *  Copyright (c) 2019-2023                                                  *\
+ *     Verificarlo Contributors                                              *\
+ *                                                                           *\
+ ****************************************************************************/
+/* fallocate */
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "interflop/interflop_stdlib.h"
+#include "trace_codec.h"
+#include "trace_writer.h"
+
+/* Buffers allocated at most, threads wait for the encoder beyond */
+#define MAX_BUFFERS 64
+/* The file is extended by this many segments past the last reserved one */
+#define SEGMENTS_AHEAD 8
+
+#define SEGMENT_BYTES                                                          \
+  ((off_t)IEEE_TRACE_SEGMENT_RECORDS * (off_t)sizeof(ieee_trace_record_t))
+#define SEGMENT_OFFSET(index)                                                  \
+  ((off_t)sizeof(ieee_trace_header_t) + (off_t)(index)*SEGMENT_BYTES)
+
+__thread ieee_trace_buffer_t *ieee_trace_thread_buffer = NULL;
+/* Private buffer of the thread once the trace is closed */
+static __thread ieee_trace_buffer_t *thread_discard = NULL;
+
+static ieee_trace_format_t trace_format = IEEE_TRACE_FORMAT_XOR;
+static int trace_fd = -1;
+static pthread_t encoder;
+static pthread_mutex_t trace_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t queue_cond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t free_cond = PTHREAD_COND_INITIALIZER;
+
+/* A buffer is in exactly one list: owned by a thread (active), full and */
+/* waiting for the encoder (queue), or free                              */
+static ieee_trace_buffer_t *active = NULL;
+static ieee_trace_buffer_t *queue_head = NULL;
+static ieee_trace_buffer_t *queue_tail = NULL;
+static ieee_trace_buffer_t *free_list = NULL;
+static unsigned int n_buffers = 0;
+static bool closing = false;
+
+/* Updated by the encoder thread only */
+static uint64_t n_records_written = 0;
+static uint64_t n_bytes_written = 0;
+
+/* Memory-mapped writer: next segment index, and file size preallocated */
+static uint64_t next_segment = 0;
+static off_t allocated_size = 0;
+/* Segments in the file once closed, and padding records written in them */
+static uint64_t closed_segments = 0;
+static uint64_t n_padding = 0;
+
+static int write_all(int fd, const void *data, size_t size) {
+  const char *p = (const char *)data;
+  while (size > 0) {
+    const ssize_t n = write(fd, p, size);
+    if (n <= 0)
+      return -1;
+    p += n;
+    size -= n;
+  }
+  return 0;
+}
+
+static int write_header(uint64_t magic, uint64_t n_records) {
+  ieee_trace_header_t header;
+  memset(&header, 0, sizeof(header));
+  header.magic = magic;
+  header.version = IEEE_TRACE_VERSION;
+  header.header_size = sizeof(ieee_trace_header_t);
+  header.record_size = sizeof(ieee_trace_record_t);
+  header.n_records = n_records;
+  return (pwrite(trace_fd, &header, sizeof(header), 0) == sizeof(header)) ? 0
+                                                                        : -1;
+}
+
+static ieee_trace_buffer_t *alloc_buffer(uint32_t capacity) {
+  ieee_trace_buffer_t *buffer = interflop_malloc(
+      sizeof(ieee_trace_buffer_t) + capacity * sizeof(ieee_trace_record_t));
+  if (buffer == NULL) {
+    interflop_panic("trace: cannot allocate a trace buffer\n");
+  }
+  buffer->records = (ieee_trace_record_t *)(buffer + 1);
+  buffer->map = NULL;
+  buffer->map_size = 0;
+  buffer->capacity = capacity;
+  buffer->n = 0;
+  return buffer;
+}
+
+/* Once the trace is closed, records go to a private buffer and are lost */
+static ieee_trace_buffer_t *discard_buffer(void) {
+  if (thread_discard == NULL)
+    thread_discard = alloc_buffer(IEEE_TRACE_BUFFER_RECORDS);
+  thread_discard->n = 0;
+  ieee_trace_thread_buffer = thread_discard;
+  return thread_discard;
+}
+
+static void add_active(ieee_trace_buffer_t *buffer) {
+  buffer->n = 0;
+  buffer->tid = interflop_gettid();
+  buffer->next = active;
+  active = buffer;
+}
+
+static void remove_active(ieee_trace_buffer_t *buffer) {
+  for (ieee_trace_buffer_t **p = &active; *p != NULL; p = &(*p)->next) {
+    if (*p == buffer) {
+      *p = buffer->next;
+      return;
+    }
+  }
+}
+
+/* XOR-compressed writer */
+
+static void enqueue(ieee_trace_buffer_t *buffer) {
+  buffer->next = NULL;
+  if (queue_tail != NULL)
+    queue_tail->next = buffer;
+  else
+    queue_head = buffer;
+  queue_tail = buffer;
+  pthread_cond_signal(&queue_cond);
+}
+
+static void *encoder_thread(__attribute__((unused)) void *arg) {
+  uint8_t *out = interflop_malloc(IEEE_TRACE_ENCODE_BOUND(
+      IEEE_TRACE_BUFFER_RECORDS));
+  if (out == NULL) {
+    interflop_panic("trace: cannot allocate the encoder buffer\n");
+  }
+
+  pthread_mutex_lock(&trace_lock);
+  for (;;) {
+    while (queue_head == NULL && !closing)
+      pthread_cond_wait(&queue_cond, &trace_lock);
+    ieee_trace_buffer_t *buffer = queue_head;
+    if (buffer == NULL)
+      break;
+    queue_head = buffer->next;
+    if (queue_head == NULL)
+      queue_tail = NULL;
+    pthread_mutex_unlock(&trace_lock);
+
+    /* A buffer queued at close may still be filled by its thread */
+    uint32_t n = __atomic_load_n(&buffer->n, __ATOMIC_ACQUIRE);
+    if (n > buffer->capacity)
+      n = buffer->capacity;
+    ieee_trace_block_header_t block;
+    memset(&block, 0, sizeof(block));
+    block.n_records = n;
+    block.n_bytes = ieee_trace_encode(buffer->records, n, out);
+    block.tid = buffer->tid;
+    if (write_all(trace_fd, &block, sizeof(block)) == 0 &&
+        write_all(trace_fd, out, block.n_bytes) == 0) {
+      n_records_written += block.n_records;
+      n_bytes_written += sizeof(block) + block.n_bytes;
+    }
+
+    pthread_mutex_lock(&trace_lock);
+    buffer->next = free_list;
+    free_list = buffer;
+    pthread_cond_signal(&free_cond);
+  }
+  pthread_mutex_unlock(&trace_lock);
+  interflop_free(out);
+  return NULL;
+}
+
+/* Queues the full buffer <old> and returns a free one, NULL if closed */
+static ieee_trace_buffer_t *swap_xor_buffer(ieee_trace_buffer_t *old) {
+  ieee_trace_buffer_t *buffer = NULL;
+  pthread_mutex_lock(&trace_lock);
+  if (closing)
+    goto out;
+  if (old != NULL) {
+    remove_active(old);
+    enqueue(old);
+  }
+  while (free_list == NULL && n_buffers >= MAX_BUFFERS && !closing)
+    pthread_cond_wait(&free_cond, &trace_lock);
+  if (closing)
+    goto out;
+  if (free_list != NULL) {
+    buffer = free_list;
+    free_list = buffer->next;
+  } else {
+    n_buffers++;
+    buffer = alloc_buffer(IEEE_TRACE_BUFFER_RECORDS);
+  }
+  add_active(buffer);
+out:
+  pthread_mutex_unlock(&trace_lock);
+  return buffer;
+}
+
+static void close_xor(void) {
+  pthread_mutex_lock(&trace_lock);
+  /* Partially filled buffers of every thread, including exited ones. */
+  /* Threads still running lose their records from now on             */
+  while (active != NULL) {
+    ieee_trace_buffer_t *buffer = active;
+    active = buffer->next;
+    if (buffer->n > 0)
+      enqueue(buffer);
+  }
+  __atomic_store_n(&closing, true, __ATOMIC_RELAXED);
+  pthread_cond_broadcast(&queue_cond);
+  pthread_cond_broadcast(&free_cond);
+  pthread_mutex_unlock(&trace_lock);
+  pthread_join(encoder, NULL);
+  write_header(IEEE_TRACE_XOR_MAGIC, n_records_written);
+}
+
+/* Memory-mapped writer */
+
+/* Fills the free end of a segment with padding, called with trace_lock held */
+static void pad_segment(ieee_trace_buffer_t *buffer) {
+  for (uint32_t i = buffer->n; i < buffer->capacity; i++) {
+    memset(&buffer->records[i], 0, sizeof(ieee_trace_record_t));
+    buffer->records[i].opcode = IEEE_TRACE_PAD;
+  }
+  n_padding += buffer->capacity - buffer->n;
+}
+
+/* Extends the file up to <size> plus SEGMENTS_AHEAD segments, called */
+/* with trace_lock held                                               */
+static int extend_file(off_t size) {
+  if (closing)
+    return -1;
+  if (allocated_size >= size)
+    return 0;
+  const off_t target = size + SEGMENTS_AHEAD * SEGMENT_BYTES;
+  /* ftruncate is the fallback for file systems without fallocate */
+  if (fallocate(trace_fd, 0, 0, target) != 0 &&
+      ftruncate(trace_fd, target) != 0) {
+    interflop_panic("trace: cannot extend the trace file\n");
+  }
+  __atomic_store_n(&allocated_size, target, __ATOMIC_RELEASE);
+  return 0;
+}
+
+/* Schedules the write back of the full segment <old>, no longer in the */
+/* active list, and releases it                                          */
+static void release_segment(ieee_trace_buffer_t *old) {
+  msync(old->map, old->map_size, MS_ASYNC);
+  munmap(old->map, old->map_size);
+  interflop_free(old);
+}
+
+/* Maps a new segment for the calling thread in place of the full <old> */
+/* one, which is unmapped once the kernel was asked to write it back.   */
+/* Returns NULL if the trace is closed                                   */
+static ieee_trace_buffer_t *swap_mmap_segment(ieee_trace_buffer_t *old) {
+  const uint64_t index = __atomic_fetch_add(&next_segment, 1, __ATOMIC_RELAXED);
+  const off_t start = SEGMENT_OFFSET(index);
+  const off_t end = start + SEGMENT_BYTES;
+
+  /* Only the threads reaching the preallocated end take the lock here */
+  if (__atomic_load_n(&allocated_size, __ATOMIC_ACQUIRE) < end) {
+    pthread_mutex_lock(&trace_lock);
+    const int error = extend_file(end);
+    pthread_mutex_unlock(&trace_lock);
+    if (error)
+      return NULL;
+  }
+
+  /* The first page may be shared with the previous segment, both */
+  /* mappings are MAP_SHARED so they see the same page            */
+  const off_t page = sysconf(_SC_PAGESIZE);
+  const off_t aligned = start & ~(page - 1);
+  char *p = mmap(NULL, end - aligned, PROT_READ | PROT_WRITE, MAP_SHARED,
+                 trace_fd, aligned);
+  if (p == MAP_FAILED) {
+    interflop_panic("trace: cannot map a trace segment\n");
+  }
+
+  ieee_trace_buffer_t *buffer = interflop_malloc(sizeof(ieee_trace_buffer_t));
+  if (buffer == NULL) {
+    interflop_panic("trace: cannot allocate a trace buffer\n");
+  }
+  buffer->records = (ieee_trace_record_t *)(p + (start - aligned));
+  buffer->map = p;
+  buffer->map_size = end - aligned;
+  buffer->capacity = IEEE_TRACE_SEGMENT_RECORDS;
+
+  pthread_mutex_lock(&trace_lock);
+  if (closing) {
+    /* Reserved before the close, the segment is in the file and must be */
+    /* padded. Past the end of the truncated file it must not be touched */
+    if (index < closed_segments) {
+      buffer->n = 0;
+      pad_segment(buffer);
+    }
+    pthread_mutex_unlock(&trace_lock);
+    munmap(p, end - aligned);
+    interflop_free(buffer);
+    /* close_mmap padded <old> and dropped it from the active list */
+    if (old != NULL)
+      release_segment(old);
+    return NULL;
+  }
+  if (old != NULL)
+    remove_active(old);
+  add_active(buffer);
+  pthread_mutex_unlock(&trace_lock);
+  if (old != NULL)
+    release_segment(old);
+  return buffer;
+}
+
+static void close_mmap(void) {
+  pthread_mutex_lock(&trace_lock);
+  __atomic_store_n(&closing, true, __ATOMIC_RELAXED);
+  /* Pad the end of the segments of every thread. The current segments */
+  /* are not unmapped, threads still running may write in them until   */
+  /* they notice the trace is closed                                   */
+  while (active != NULL) {
+    ieee_trace_buffer_t *buffer = active;
+    active = buffer->next;
+    pad_segment(buffer);
+  }
+  closed_segments = __atomic_load_n(&next_segment, __ATOMIC_RELAXED);
+  const uint64_t n_records = closed_segments * IEEE_TRACE_SEGMENT_RECORDS;
+  pthread_mutex_unlock(&trace_lock);
+
+  /* Drop the preallocated space past the last segment */
+  const off_t size = SEGMENT_OFFSET(closed_segments);
+  if (ftruncate(trace_fd, size) == 0) {
+    n_bytes_written = size;
+  }
+  write_header(IEEE_TRACE_MAGIC, n_records);
+  /* Segments padded after this point still count as operations */
+  n_records_written = n_records - n_padding;
+}
+
+int ieee_trace_open(const char *path, ieee_trace_format_t format) {
+  const int mode = (format == IEEE_TRACE_FORMAT_MMAP) ? O_RDWR : O_WRONLY;
+  trace_format = format;
+  trace_fd = open(path, O_CREAT | O_TRUNC | mode, 0644);
+  if (trace_fd == -1) {
+    return -1;
+  }
+
+  /* n_records stays 0 until close: records go up to the end of the file */
+  int error;
+  if (format == IEEE_TRACE_FORMAT_MMAP) {
+    pthread_mutex_lock(&trace_lock);
+    error = write_header(IEEE_TRACE_MAGIC, 0) != 0 ||
+            extend_file(SEGMENT_OFFSET(1)) != 0;
+    pthread_mutex_unlock(&trace_lock);
+  } else {
+    error = write_header(IEEE_TRACE_XOR_MAGIC, 0) != 0 ||
+            lseek(trace_fd, sizeof(ieee_trace_header_t), SEEK_SET) == -1 ||
+            pthread_create(&encoder, NULL, encoder_thread, NULL) != 0;
+  }
+  if (error) {
+    close(trace_fd);
+    trace_fd = -1;
+    return -1;
+  }
+  n_bytes_written = sizeof(ieee_trace_header_t);
+  return 0;
+}
+
+ieee_trace_buffer_t *ieee_trace_swap_buffer(void) {
+  ieee_trace_buffer_t *buffer = ieee_trace_thread_buffer;
+  if (__atomic_load_n(&closing, __ATOMIC_RELAXED) ||
+      (buffer != NULL && buffer == thread_discard)) {
+    return discard_buffer();
+  }
+
+  buffer = (trace_format == IEEE_TRACE_FORMAT_MMAP)
+               ? swap_mmap_segment(buffer)
+               : swap_xor_buffer(buffer);
+  if (buffer == NULL) {
+    return discard_buffer();
+  }
+  ieee_trace_thread_buffer = buffer;
+  return buffer;
+}
+
+void ieee_trace_close(ieee_trace_stats_t *stats) {
+  if (trace_fd == -1) {
+    memset(stats, 0, sizeof(*stats));
+    return;
+  }
+
+  if (trace_format == IEEE_TRACE_FORMAT_MMAP)
+    close_mmap();
+  else
+    close_xor();
+  close(trace_fd);
+  trace_fd = -1;
+  stats->n_records = n_records_written;
+  stats->n_bytes = n_bytes_written;
+}
@@ -0,0 +1,77 @@
+/*****************************************************************************\
+ *                                                                           *\
+ *  This file is part of the Verificarlo project,                            *\
+ *  under the Apache License v2.0 with LLVM Exceptions.                      *\
+ *  SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception.                 *\
+ *  See https://llvm.org/LICENSE.txt for license information.                *\
+ *                                                                           *\
+ *  Copyright (c) 2019-2023                                                  *\
+ *     Verificarlo Contributors                                              *\
+ *                                                                           *\
+ ****************************************************************************/
+#ifndef __TRACE_WRITER_H__
+#define __TRACE_WRITER_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "trace.h"
+
+/* Trace writers of the --trace option                                      */
+/* Each thread appends raw records to its own buffer, a lock is only taken  */
+/* when the buffer is full.                                                 */
+/*  - IEEE_TRACE_FORMAT_XOR: a full buffer is handed to the encoder thread, */
+/*    which XOR-encodes it (trace_codec.h) into one block of the file and   */
+/*    recycles it.                                                          */
+/*  - IEEE_TRACE_FORMAT_MMAP: the buffer is a segment of the file mapped in */
+/*    memory, records are written with plain stores and the kernel flushes  */
+/*    the pages. Segments are reserved with an atomic bump of the segment   */
+/*    index and the file is extended with fallocate ahead of need.          */
+
+#define IEEE_TRACE_BUFFER_RECORDS (64 * 1024)
+/* 256 Ki records, 10 MiB */
+#define IEEE_TRACE_SEGMENT_RECORDS (256 * 1024)
+
+typedef enum {
+  IEEE_TRACE_FORMAT_XOR = 0,
+  IEEE_TRACE_FORMAT_MMAP,
+} ieee_trace_format_t;
+
+typedef struct ieee_trace_buffer {
+  struct ieee_trace_buffer *next;
+  ieee_trace_record_t *records;
+  /* mapping of a memory-mapped segment, NULL for an allocated buffer */
+  void *map;
+  size_t map_size;
+  uint32_t capacity;
+  uint32_t n;
+  int32_t tid;
+} ieee_trace_buffer_t;
+
+typedef struct {
+  uint64_t n_records;
+  uint64_t n_bytes; /* size of the file */
+} ieee_trace_stats_t;
+
+/* Creates <path> and starts the encoder thread or preallocates the file  */
+/* Returns 0 on success                                                    */
+int ieee_trace_open(const char *path, ieee_trace_format_t format);
+/* Hands the buffer of the calling thread to the writer and returns a new */
+/* one, the first call of a thread only allocates it                      */
+ieee_trace_buffer_t *ieee_trace_swap_buffer(void);
+/* Writes the buffers of every thread and the final header. Records       */
+/* appended afterwards are lost                                           */
+void ieee_trace_close(ieee_trace_stats_t *stats);
+
+extern __thread ieee_trace_buffer_t *ieee_trace_thread_buffer;
+
+/* Returns the record to fill for the next operation of the thread */
+static inline ieee_trace_record_t *ieee_trace_next_record(void) {
+  ieee_trace_buffer_t *buffer = ieee_trace_thread_buffer;
+  if (__builtin_expect(buffer == NULL || buffer->n == buffer->capacity, 0)) {
+    buffer = ieee_trace_swap_buffer();
+  }
+  return &buffer->records[buffer->n++];
+}
+
+#endif /* __TRACE_WRITER_H__ */
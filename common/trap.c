@@ -0,0 +1,334 @@
+/*****************************************************************************\
+ *                                                                           *\
+ *  This file is part of the Verificarlo project,                            *\
+ *  under the Apache License v2.0 with LLVM Exceptions.                      *\
+ *  SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception.                 *\
+ *  See https://llvm.org/LICENSE.txt for license information.                *\
+ *                                                                           *\
+ *  Copyright (c) 2019-2023                                                  *\
+ *     Verificarlo Contributors                                              *\
+ *                                                                           *\
+ ****************************************************************************/
+#define _GNU_SOURCE /* ucontext registers */
+#include <execinfo.h>
+#include <fenv.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <ucontext.h>
+#include <unistd.h>
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+#include "fpenv.h"
+#include "signal_output.h"
+#include "trap.h"
+
+#define TRAP_BACKTRACE_DEPTH 32
+#define TRAP_LINE_MAX 256
+
+const char *const ieee_trap_names[IEEE_TRAP_KINDS] = {"invalid", "divzero",
+                                                      "overflow", "underflow"};
+const int ieee_trap_excepts[IEEE_TRAP_KINDS] = {FE_INVALID, FE_DIVBYZERO,
+                                                FE_OVERFLOW, FE_UNDERFLOW};
+
+static uint64_t trap_counts[IEEE_TRAP_KINDS];
+/* kinds already reported, as bits */
+static int trap_reported = 0;
+static struct sigaction trap_previous;
+
+int ieee_trap_parse(const char *list) {
+  int fe = 0;
+  while (*list != '\0') {
+    const char *end = strchr(list, ',');
+    const size_t len = (end != NULL) ? (size_t)(end - list) : strlen(list);
+    int found = 0;
+    if (len == 3 && strncmp(list, "all", 3) == 0) {
+      for (int k = 0; k < IEEE_TRAP_KINDS; k++)
+        fe |= ieee_trap_excepts[k];
+      found = 1;
+    }
+    for (int k = 0; k < IEEE_TRAP_KINDS && !found; k++) {
+      if (strlen(ieee_trap_names[k]) == len &&
+          strncmp(list, ieee_trap_names[k], len) == 0) {
+        fe |= ieee_trap_excepts[k];
+        found = 1;
+      }
+    }
+    if (!found)
+      return -1;
+    list += len;
+    if (*list == ',')
+      list++;
+  }
+  return fe;
+}
+
+static int kind_of_code(int code) {
+  switch (code) {
+  case FPE_FLTINV:
+    return 0;
+  case FPE_FLTDIV:
+    return 1;
+  case FPE_FLTOVF:
+    return 2;
+  case FPE_FLTUND:
+    return 3;
+  default:
+    return -1;
+  }
+}
+
+/* Faulting instruction, decoded from its SSE or VEX encoding. Scalar   */
+/* operations give their register operands, which hold the operands of */
+/* the backend operation; packed ones, of the vector kernels, only     */
+/* their name                                                           */
+typedef struct {
+  const char *name;
+  int is_double;
+  int is_scalar;
+  int n_operands;
+  int operands[3]; /* xmm registers, -1 for a memory operand */
+} trap_insn_t;
+
+static const char *opcode_name(uint8_t opcode) {
+  switch (opcode) {
+  case 0x2e:
+  case 0x2f:
+    return "cmp";
+  case 0x51:
+    return "sqrt";
+  case 0x58:
+    return "add";
+  case 0x59:
+    return "mul";
+  case 0x5a:
+    return "cast";
+  case 0x5c:
+    return "sub";
+  case 0x5d:
+    return "min";
+  case 0x5e:
+    return "div";
+  case 0x5f:
+    return "max";
+  case 0xc2:
+    return "cmp";
+  default:
+    return NULL;
+  }
+}
+
+/* Returns 0 if the instruction at <p> is a decoded floating-point one */
+static int decode(const uint8_t *p, trap_insn_t *insn) {
+  int pp = 0, rex_r = 0, rex_b = 0, vvvv = -1, map = 1, w = 0;
+  if (p[0] == 0xc5) {
+    rex_r = !(p[1] & 0x80);
+    vvvv = (~p[1] >> 3) & 0xf;
+    pp = p[1] & 3;
+    p += 2;
+  } else if (p[0] == 0xc4) {
+    rex_r = !(p[1] & 0x80);
+    rex_b = !(p[1] & 0x20);
+    map = p[1] & 0x1f;
+    w = p[2] >> 7;
+    vvvv = (~p[2] >> 3) & 0xf;
+    pp = p[2] & 3;
+    p += 3;
+  } else {
+    for (;; p++) {
+      if (*p == 0x66)
+        pp = 1;
+      else if (*p == 0xf3)
+        pp = 2;
+      else if (*p == 0xf2)
+        pp = 3;
+      else
+        break;
+    }
+    if ((*p & 0xf0) == 0x40) {
+      rex_r = (*p >> 2) & 1;
+      rex_b = *p & 1;
+      p++;
+    }
+    if (*p++ != 0x0f)
+      return -1;
+    if (*p == 0x38) {
+      map = 2;
+      p++;
+    }
+  }
+  const uint8_t opcode = p[0], modrm = p[1];
+  const int reg = ((modrm >> 3) & 7) + 8 * rex_r;
+  const int rm = ((modrm >> 6) == 3) ? (modrm & 7) + 8 * rex_b : -1;
+
+  if (map == 2) {
+    /* vfmadd, vfmsub, vfnmadd and vfnmsub 132, 213 and 231 */
+    if (vvvv < 0 || pp != 1 || opcode < 0x96 || opcode > 0xbf ||
+        (opcode & 0xf) < 6)
+      return -1;
+    insn->name = "fma";
+    insn->is_double = w;
+    insn->is_scalar = opcode & 1;
+    insn->n_operands = 3;
+    /* a * b + c */
+    const int order[3][3] = {
+        {reg, rm, vvvv}, {vvvv, reg, rm}, {vvvv, rm, reg}};
+    memcpy(insn->operands, order[(opcode >> 4) - 9], sizeof(insn->operands));
+    return 0;
+  }
+  if (map != 1 || (insn->name = opcode_name(opcode)) == NULL)
+    return -1;
+  if (opcode == 0x2e || opcode == 0x2f) {
+    /* ucomiss, comiss and their double versions */
+    insn->is_double = pp == 1;
+    insn->is_scalar = 1;
+  } else {
+    insn->is_double = pp == 1 || pp == 3;
+    insn->is_scalar = pp >= 2;
+  }
+  if (opcode == 0x51 || opcode == 0x5a) {
+    insn->n_operands = 1;
+    insn->operands[0] = rm;
+  } else {
+    insn->n_operands = 2;
+    insn->operands[0] = (vvvv >= 0 && opcode != 0x2e && opcode != 0x2f)
+                            ? vvvv
+                            : reg;
+    insn->operands[1] = rm;
+  }
+  return 0;
+}
+
+static char *put_insn(char *out, const uint8_t *code, const ucontext_t *uc) {
+#if defined(__x86_64__)
+  trap_insn_t insn;
+  if (decode(code, &insn) != 0)
+    return out;
+  out = ieee_put_str(out, ", ");
+  out = ieee_put_str(out, insn.name);
+  out = ieee_put_str(out, insn.is_double ? " double" : " float");
+  if (!insn.is_scalar)
+    return ieee_put_str(out, " vector");
+  out = ieee_put_str(out, ", operands");
+  for (int i = 0; i < insn.n_operands; i++) {
+    *out++ = ' ';
+    if (insn.operands[i] < 0) {
+      out = ieee_put_str(out, "(memory)");
+      continue;
+    }
+    const uint32_t *xmm =
+        uc->uc_mcontext.fpregs->_xmm[insn.operands[i]].element;
+    if (insn.is_double) {
+      double x;
+      memcpy(&x, xmm, sizeof(x));
+      out = ieee_format_hex_double(out, x, 0);
+    } else {
+      float x;
+      memcpy(&x, xmm, sizeof(x));
+      out = ieee_format_hex_float(out, x, 0);
+    }
+  }
+#else
+  (void)code;
+  (void)uc;
+#endif
+  return out;
+}
+
+static void report(int kind, void *address, const ucontext_t *uc) {
+  char line[TRAP_LINE_MAX];
+  char *out = line;
+  out = ieee_put_str(out, "Warning [interflop_ieee]: trap: ");
+  out = ieee_put_str(out, ieee_trap_names[kind]);
+  out = ieee_put_str(out, " in thread ");
+  out = ieee_format_uint(out, syscall(SYS_gettid));
+  out = ieee_put_str(out, " at ");
+  out = ieee_put_hex(out, (uintptr_t)address);
+  out = put_insn(out, address, uc);
+  *out++ = '\n';
+  ieee_write_line(line, out);
+
+  /* From the signal frame, without report and the handler. backtrace() */
+  /* is not async-signal-safe in POSIX terms: it is called once at start */
+  /* so that it does not load its unwinder here, and the frames are then */
+  /* written raw, as backtrace_symbols_fd would call dladdr              */
+  void *frames[TRAP_BACKTRACE_DEPTH];
+  const int depth = backtrace(frames, TRAP_BACKTRACE_DEPTH);
+  for (int i = 2; i < depth; i++) {
+    out = ieee_put_str(line, "  #");
+    out = ieee_format_uint(out, i - 2);
+    *out++ = ' ';
+    out = ieee_put_hex(out, (uintptr_t)frames[i]);
+    *out++ = '\n';
+    ieee_write_line(line, out);
+  }
+  ieee_write_maps("  map ");
+}
+
+/* Gives <sig> to the previous disposition, keeping the trap handler */
+/* installed when it is a handler of the application. Under SIG_DFL  */
+/* or SIG_IGN, the disposition is reset to the default so that the   */
+/* faulting instruction, executed again on return, kills the process */
+static void forward(int sig, siginfo_t *info, void *context) {
+  if (ieee_signal_forward(&trap_previous, sig, info, context))
+    return;
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = SIG_DFL;
+  sigemptyset(&action.sa_mask);
+  sigaction(SIGFPE, &action, NULL);
+}
+
+static void trap_handler(int sig, siginfo_t *info, void *context) {
+  ucontext_t *uc = context;
+  const int kind = kind_of_code(info->si_code);
+  if (kind < 0) {
+    /* Not a floating-point exception, e.g. an integer division by zero */
+    forward(sig, info, context);
+    return;
+  }
+  __atomic_add_fetch(&trap_counts[kind], 1, __ATOMIC_RELAXED);
+  const int bit = 1 << kind;
+  if ((__atomic_fetch_or(&trap_reported, bit, __ATOMIC_RELAXED) & bit) == 0)
+    report(kind, info->si_addr, uc);
+#if defined(__x86_64__)
+  /* Masked in the context restored on return, the operation completes */
+  /* with the default result and sets the sticky flag                  */
+  uc->uc_mcontext.fpregs->mxcsr |= ieee_trap_excepts[kind] << 7;
+#else
+  /* The exception cannot be masked in the context restored on return */
+  forward(sig, info, context);
+#endif
+}
+
+int ieee_trap_start(void) {
+  /* backtrace() loads libgcc on its first call, not in the handler */
+  void *frame;
+  backtrace(&frame, 1);
+
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_sigaction = trap_handler;
+  action.sa_flags = SA_SIGINFO;
+  sigemptyset(&action.sa_mask);
+  return sigaction(SIGFPE, &action, &trap_previous);
+}
+
+int ieee_trap_stop(void) {
+  int fe = 0;
+  for (int k = 0; k < IEEE_TRAP_KINDS; k++)
+    fe |= ieee_trap_excepts[k];
+#if defined(__SSE__)
+  _mm_setcsr(_mm_getcsr() | (fe << 7));
+#else
+  fedisableexcept(fe);
+#endif
+  return ieee_fpenv_raised();
+}
+
+void ieee_trap_counts(uint64_t counts[IEEE_TRAP_KINDS]) {
+  for (int k = 0; k < IEEE_TRAP_KINDS; k++)
+    counts[k] = __atomic_load_n(&trap_counts[k], __ATOMIC_RELAXED);
+}
@@ -0,0 +1,42 @@
+/*****************************************************************************\
+ *                                                                           *\
+ *  This file is part of the Verificarlo project,                            *\
+ *  under the Apache License v2.0 with LLVM Exceptions.                      *\
+ *  SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception.                 *\
+ *  See https://llvm.org/LICENSE.txt for license information.                *\
+ *                                                                           *\
+ *  Copyright (c) 2019-2023                                                  *\
+ *     Verificarlo Contributors                                              *\
+ *                                                                           *\
+ ****************************************************************************/
+#ifndef __TRAP_H__
+#define __TRAP_H__
+
+#include <stdint.h>
+
+/* Floating-point exception traps of the --trap option                     */
+/* The trapped exceptions are unmasked in each thread by the environment   */
+/* of fpenv.h, so only the operations which raise one fault and the others */
+/* pay nothing. The SIGFPE handler reports the first trap of each kind:    */
+/* faulting function, scalar operands read in the argument registers, and  */
+/* backtrace. It then masks the exception in the faulting thread and       */
+/* returns, the operation is executed again and gives its default result.  */
+
+/* invalid, divzero, overflow, underflow */
+#define IEEE_TRAP_KINDS 4
+
+extern const char *const ieee_trap_names[IEEE_TRAP_KINDS];
+extern const int ieee_trap_excepts[IEEE_TRAP_KINDS];
+
+/* Returns the FE_* exceptions of the comma-separated <list> of names of   */
+/* ieee_trap_names or "all", -1 if a name is unknown                        */
+int ieee_trap_parse(const char *list);
+/* Installs the SIGFPE handler, returns 0 on success */
+int ieee_trap_start(void);
+/* Masks the trapped exceptions in the calling thread and returns the */
+/* sticky exception flags of the process (ieee_fpenv_raised)          */
+int ieee_trap_stop(void);
+/* Number of traps caught, indexed like ieee_trap_names */
+void ieee_trap_counts(uint64_t counts[IEEE_TRAP_KINDS]);
+
+#endif /* __TRAP_H__ */
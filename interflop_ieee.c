@@ -17,23 +17,52 @@
  *     Verificarlo Contributors                                              *\
  *                                                                           *\
  ****************************************************************************/
+/* dladdr */
+#define _GNU_SOURCE
 #include <argp.h>
+#include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <fenv.h>
+#include <float.h>
+#include <limits.h>
 #include <ieee754.h>
 #include <math.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <signal.h>
 #include <stdarg.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-
-
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "common/call_sites.h"
+#include "common/count_sample.h"
+#include "common/fingerprint.h"
+#include "common/flight_recorder.h"
+#include "common/fpenv.h"
+#include "common/hex_float.h"
+#include "common/overhead.h"
+#include "common/precision.h"
+#include "common/probes.h"
+#include "common/report.h"
 #include "common/printf_specifier.h"
+#include "common/shm_stats.h"
+#include "common/signal_output.h"
+#include "common/subnormal.h"
+#include "common/trace_writer.h"
+#include "common/trap.h"
 #include "interflop/common/float_const.h"
 #include "interflop/fma/interflop_fma.h"
 #include "interflop/interflop.h"
 #include "interflop/iostream/logger.h"
 #include "interflop_ieee.h"
+#include "interflop_ieee_inline.h"
 
 #if defined(VECT512)
 #include "x86_64/interflop_vector_ieee_avx512.h"
@@ -57,6 +86,27 @@ typedef enum {
   KEY_PRINT_NEW_LINE = 'n',
   KEY_COUNT_OP = 'o',
   KEY_PRINT_SUBNORMAL_NORMALIZED,
+  /* long-only options, outside the printable range used by short ones */
+  KEY_LIVE_CONFIG = 0x100,
+  KEY_SHM_STATS,
+  KEY_ROUNDING,
+  KEY_FTZ_DAZ,
+  KEY_DEBUG_DIR,
+  KEY_TRACE,
+  KEY_TRACE_FORMAT,
+  KEY_PRECISION_PROFILE,
+  KEY_PRECISION_ULPS,
+  KEY_VECTOR_COVERAGE,
+  KEY_OVERHEAD_PROFILE,
+  KEY_REPORT_DIR,
+  KEY_FINGERPRINT,
+  KEY_FINGERPRINT_INTERVAL,
+  KEY_DEBUG_HEX,
+  KEY_SUBNORMAL_PROFILE,
+  KEY_TRAP,
+  KEY_FLIGHT_RECORDER,
+  KEY_ROI,
+  KEY_COUNT_SAMPLE,
 } key_args;
 
 static const char backend_name[] = "interflop-ieee";
@@ -69,6 +119,33 @@ static const char key_print_new_line_str[] = "print-new-line";
 static const char key_print_subnormal_normalized_str[] =
     "print-subnormal-normalized";
 static const char key_count_op_str[] = "count-op";
+static const char key_live_config_str[] = "live-config";
+static const char key_shm_stats_str[] = "shm-stats";
+static const char key_rounding_str[] = "rounding";
+static const char key_ftz_daz_str[] = "ftz-daz";
+static const char key_debug_dir_str[] = "debug-dir";
+static const char key_trace_str[] = "trace";
+static const char key_trace_format_str[] = "trace-format";
+static const char key_precision_profile_str[] = "precision-profile";
+static const char key_precision_ulps_str[] = "precision-ulps";
+static const char key_vector_coverage_str[] = "vector-coverage";
+static const char key_overhead_profile_str[] = "overhead-profile";
+static const char key_report_dir_str[] = "report-dir";
+static const char key_fingerprint_str[] = "fingerprint";
+static const char key_fingerprint_interval_str[] = "fingerprint-interval";
+static const char key_debug_hex_str[] = "debug-hex";
+static const char key_subnormal_profile_str[] = "subnormal-profile";
+static const char key_trap_str[] = "trap";
+static const char key_flight_recorder_str[] = "flight-recorder";
+static const char key_roi_str[] = "roi";
+static const char key_count_sample_str[] = "count-sample";
+
+/* Names of the --rounding modes, indexed by ieee_rounding_mode_t */
+static const char *rounding_mode_str[] = {"nearest", "up", "down", "zero"};
+/* Names of the --trace-format formats, indexed by ieee_trace_format_t */
+static const char *trace_format_str[] = {"xor", "mmap"};
+/* Names of the formats of --precision-profile, indexed by ieee_format_t */
+static const char *format_str[] = {"fp32", "fp16", "bf16"};
 
 typedef enum {
   ARITHMETIC = 0,
@@ -99,12 +176,92 @@ void insert_string(char *dst, char *str_to_add, int *i) {
   } while ((*i)++, j++, str_to_add[j] != '\0');
 }
 
+/* Per-thread debug files (--debug-dir)                                     */
+/* Each thread writes its records in <dir>/<pid>.<tid>.log, opened the     */
+/* first time it prints, so that neither a reused tid nor another run      */
+/* overwrites a file. Every record starts with "[<seq>] " where <seq> is   */
+/* taken from a global counter, so the files can be merged back in program */
+/* order (tools/debug_merge.c) while threads never share a stream. The     */
+/* streams are listed so that finalize flushes and closes them.            */
+
+/* Longest "/<pid>.<tid>.log" appended to the directory, with the NUL */
+#define DEBUG_FILE_NAME_MAX 32
+
+typedef struct debug_stream {
+  File *stream;
+  struct debug_stream *next;
+} debug_stream_t;
+
+static __thread File *debug_thread_stream = NULL;
+static debug_stream_t *debug_streams = NULL;
+static IUint64_t debug_sequence = 0;
+
+/* Opens the file of the calling thread, NULL on failure */
+static File *_ieee_debug_open(const ieee_context_t *ctx) {
+  /* The length of the directory is checked at initialization */
+  char path[PATH_MAX];
+  int error = 0;
+  interflop_sprintf(path, "%s/%d.%d.log", ctx->debug_dir, (int)getpid(),
+                    interflop_gettid());
+  File *stream = interflop_fopen(path, "w", &error);
+  if (stream == NULL) {
+    logger_warning("cannot open %s: %s, debug output sent to stderr\n", path,
+                   interflop_strerror(error));
+    return NULL;
+  }
+  debug_stream_t *node = interflop_malloc(sizeof(debug_stream_t));
+  if (node == NULL) {
+    interflop_fclose(stream, &error);
+    logger_warning("cannot allocate the debug stream of %s, debug output "
+                   "sent to stderr\n",
+                   path);
+    return NULL;
+  }
+  node->stream = stream;
+  node->next = __atomic_load_n(&debug_streams, __ATOMIC_RELAXED);
+  while (!__atomic_compare_exchange_n(&debug_streams, &node->next, node, 1,
+                                      __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+    ;
+  return stream;
+}
+
+/* Returns the stream receiving the debug output of the calling thread */
+static File *_ieee_debug_stream(const ieee_context_t *ctx) {
+  if (ctx->debug_dir == NULL)
+    return logger_stderr;
+  if (__builtin_expect(debug_thread_stream == NULL, 0)) {
+    debug_thread_stream = _ieee_debug_open(ctx);
+    if (debug_thread_stream == NULL)
+      debug_thread_stream = logger_stderr;
+  }
+  return debug_thread_stream;
+}
+
+/* Flushes and closes the files of every thread. Output printed later */
+/* goes to stderr                                                      */
+static void _ieee_debug_close(ieee_context_t *ctx) {
+  ctx->debug_dir = NULL;
+  debug_stream_t *node = __atomic_exchange_n(&debug_streams, NULL,
+                                             __ATOMIC_ACQUIRE);
+  while (node != NULL) {
+    debug_stream_t *next = node->next;
+    int error = 0;
+    if (interflop_fclose(node->stream, &error) != 0) {
+      logger_warning("cannot close a debug file: %s\n",
+                     interflop_strerror(error));
+    }
+    interflop_free(node);
+    node = next;
+  }
+}
+
 /* Auxiliary function to debug print that prints  */
 /* a new line if requested by option --print-new-line  */
 void debug_print_aux(void *context, char *fmt, va_list argp) {
-  interflop_vfprintf(logger_stderr, fmt, argp);
+  File *stream = _ieee_debug_stream((ieee_context_t *)context);
+  interflop_vfprintf(stream, fmt, argp);
   if (((ieee_context_t *)context)->print_new_line) {
-    interflop_fprintf(logger_stderr, "\n");
+    interflop_fprintf(stream, "\n");
   }
 }
 
@@ -137,10 +294,85 @@ void debug_print(void *context, char *fmt_flt, char *fmt, ...) {
 
 #define DEBUG_HEADER "Decimal "
 #define DEBUG_BINARY_HEADER "Binary "
+#define DEBUG_HEX_HEADER "Hex"
+
+/* Appends the null-terminated <str> to the record at <out> */
+static inline char *_ieee_debug_put(char *out, const char *str) {
+  const size_t len = strlen(str);
+  memcpy(out, str, len);
+  return out + len;
+}
+
+/* Separator of the parts of a record, printed on their own lines with */
+/* --print-new-line as in the other debug modes                        */
+#define DEBUG_HEX_BREAK(ctx) ((ctx)->print_new_line ? '\n' : ' ')
+
+/* Prints the --debug-hex record of an operation. The record is built in a */
+/* buffer with the formatter of common/hex_float.h and printed with a      */
+/* single call, no format string is parsed for the values                  */
+#define DEBUG_HEX_PRINT(ctx, typeop, op, a, b, c, d)                           \
+  {                                                                            \
+    char record[STRING_MAX];                                                   \
+    char *p = record;                                                          \
+    const int normalize = ctx->print_subnormal_normalized ? 1 : 0;             \
+    const bool print_header = ctx->no_backend_name ? false : true;             \
+    if (ctx->debug_dir != NULL) {                                              \
+      *p++ = '[';                                                              \
+      p = ieee_format_uint(p, __atomic_fetch_add(&debug_sequence, 1,           \
+                                                 __ATOMIC_RELAXED));           \
+      p = _ieee_debug_put(p, "] ");                                            \
+    }                                                                          \
+    if (print_header) {                                                        \
+      p = _ieee_debug_put(p, DEBUG_HEX_HEADER);                                \
+      *p++ = DEBUG_HEX_BREAK(ctx);                                             \
+    }                                                                          \
+    p = IEEE_FORMAT_HEX(p, a, normalize);                                      \
+    if (typeop == ARITHMETIC) {                                                \
+      *p++ = ' ';                                                              \
+      p = _ieee_debug_put(p, op);                                              \
+      *p++ = DEBUG_HEX_BREAK(ctx);                                             \
+      p = IEEE_FORMAT_HEX(p, b, normalize);                                    \
+      p = _ieee_debug_put(p, " ->");                                           \
+      *p++ = DEBUG_HEX_BREAK(ctx);                                             \
+      p = IEEE_FORMAT_HEX(p, c, normalize);                                    \
+    } else if (typeop == COMPARISON) {                                         \
+      p = _ieee_debug_put(p, " [");                                            \
+      p = _ieee_debug_put(p, op);                                              \
+      *p++ = ']';                                                              \
+      *p++ = DEBUG_HEX_BREAK(ctx);                                             \
+      p = IEEE_FORMAT_HEX(p, b, normalize);                                    \
+      p = _ieee_debug_put(p, c ? " -> true" : " -> false");                    \
+    } else if (typeop == CAST) {                                               \
+      *p++ = ' ';                                                              \
+      p = _ieee_debug_put(p, op);                                              \
+      p = _ieee_debug_put(p, " ->");                                           \
+      *p++ = DEBUG_HEX_BREAK(ctx);                                             \
+      p = IEEE_FORMAT_HEX(p, b, normalize);                                    \
+    } else if (typeop == FMA) {                                                \
+      p = _ieee_debug_put(p, " *");                                            \
+      *p++ = DEBUG_HEX_BREAK(ctx);                                             \
+      p = IEEE_FORMAT_HEX(p, b, normalize);                                    \
+      p = _ieee_debug_put(p, " +");                                            \
+      *p++ = DEBUG_HEX_BREAK(ctx);                                             \
+      p = IEEE_FORMAT_HEX(p, c, normalize);                                    \
+      p = _ieee_debug_put(p, " ->");                                           \
+      *p++ = DEBUG_HEX_BREAK(ctx);                                             \
+      p = IEEE_FORMAT_HEX(p, d, normalize);                                    \
+    }                                                                          \
+    *p++ = '\n';                                                               \
+    if (ctx->print_new_line)                                                   \
+      *p++ = '\n';                                                             \
+    *p = '\0';                                                                 \
+    if (ctx->debug_dir == NULL && print_header)                                \
+      logger_info("%s", record);                                               \
+    else                                                                       \
+      interflop_fprintf(_ieee_debug_stream(ctx), "%s", record);                \
+  }
 
 /* This macro print the debug information for a, b and c */
 /* the debug_print function handles automatically the format */
-/* (decimal or binary) depending on the context */
+/* (decimal or binary) depending on the context, --debug-hex */
+/* takes precedence over both */
 #define DEBUG_PRINT(context, typeop, op, a, b, c, d)                           \
   {                                                                            \
     ieee_context_t *ctx = (ieee_context_t *)context;                           \
@@ -148,7 +380,9 @@ void debug_print(void *context, char *fmt_flt, char *fmt, ...) {
     bool debug_binary = ctx->debug_binary ? true : false;                      \
     bool subnormal_normalized =                                                \
         ctx->print_subnormal_normalized ? true : false;                        \
-    if (debug || debug_binary) {                                               \
+    if (ctx->debug_hex) {                                                      \
+      DEBUG_HEX_PRINT(ctx, typeop, op, a, b, c, d);                            \
+    } else if (debug || debug_binary) {                                        \
       bool print_header = ctx->no_backend_name ? false : true;                 \
       char *header = (debug) ? DEBUG_HEADER : DEBUG_BINARY_HEADER;             \
       char *a_float_fmt =                                                      \
@@ -159,7 +393,15 @@ void debug_print(void *context, char *fmt_flt, char *fmt, ...) {
           (subnormal_normalized) ? FMT_SUBNORMAL_NORMALIZED(c) : FMT(c);       \
       char *d_float_fmt =                                                      \
           (subnormal_normalized) ? FMT_SUBNORMAL_NORMALIZED(d) : FMT(d);       \
-      if (print_header) {                                                      \
+      if (ctx->debug_dir != NULL) {                                            \
+        File *stream = _ieee_debug_stream(ctx);                                \
+        interflop_fprintf(stream, "[%lu] ",                                    \
+                          __atomic_fetch_add(&debug_sequence, 1,               \
+                                             __ATOMIC_RELAXED));               \
+        if (print_header)                                                      \
+          interflop_fprintf(stream, ctx->print_new_line ? "%s\n" : "%s",       \
+                            header);                                           \
+      } else if (print_header) {                                               \
         if (ctx->print_new_line)                                               \
           logger_info("%s\n", header);                                         \
         else                                                                   \
@@ -293,12 +535,319 @@ static inline void debug_print_fma_double(void *context,
     break;                                                                     \
   }
 
+/* Counts one operation, in the thread slot of the shared memory segment */
+/* with --shm-stats, in the context with --count-op. With --count-sample */
+/* only the sampled operations add their weight to the context           */
+static inline void _ieee_count_op(ieee_context_t *ctx,
+                                  ieee_shm_stats_counter_t counter,
+                                  IUint64_t *count) {
+  if (ctx->shm_stats) {
+    ieee_shm_stats_increment(counter);
+  } else if (ctx->count_op || ctx->report_dir != NULL) {
+    if (ctx->count_sample == 0)
+      __atomic_add_fetch(count, 1, __ATOMIC_RELAXED);
+    else if (ieee_count_sample())
+      __atomic_add_fetch(count, ctx->count_sample, __ATOMIC_RELAXED);
+  }
+}
+
+static inline uint64_t _ieee_float_bits(float x) {
+  uint32_t bits;
+  memcpy(&bits, &x, sizeof(bits));
+  return bits;
+}
+
+static inline uint64_t _ieee_double_bits(double x) {
+  uint64_t bits;
+  memcpy(&bits, &x, sizeof(bits));
+  return bits;
+}
+
+/* Hashes the result <bits> of an operation in its stream (--fingerprint) */
+static inline void _ieee_fingerprint(ieee_trace_opcode_t opcode,
+                                     ieee_trace_precision_t precision,
+                                     uint64_t bits) {
+  ieee_fingerprint_scalar(ieee_stream_scalar(opcode, precision), bits);
+}
+
+/* Appends an operation to the trace of the calling thread (--trace) */
+static inline void _ieee_trace(ieee_trace_opcode_t opcode,
+                               ieee_trace_precision_t precision, int predicate,
+                               uint64_t a, uint64_t b, uint64_t c,
+                               uint64_t result) {
+  ieee_trace_record_t *rec = ieee_trace_next_record();
+  rec->opcode = opcode;
+  rec->precision = precision;
+  rec->predicate = predicate;
+  rec->flags = IEEE_TRACE_WRITTEN;
+  rec->operands[0] = a;
+  rec->operands[1] = b;
+  rec->operands[2] = c;
+  rec->result = result;
+}
+
+/* FTZ/DAZ accounting (--ftz-daz)                                          */
+/* The operands are passed by value and are still those of the program.   */
+/* Subnormals are detected on the bits, as SSE comparisons see them as     */
+/* zero under DAZ, and the exact result is recomputed in long double: the  */
+/* x87 unit ignores the MXCSR and its wider range never holds a subnormal  */
+/* float or double.                                                        */
+
+/* Counts the <n_subnormal> operands read as zero, and the result if     */
+/* <exact> is below the smallest normal number <min> of the format       */
+static inline void _ieee_ftz_daz_count(ieee_context_t *ctx, int n_subnormal,
+                                       long double exact, long double min) {
+  if (n_subnormal)
+    __atomic_add_fetch(&ctx->daz_count, n_subnormal, __ATOMIC_RELAXED);
+  const long double abs_exact = fabsl(exact);
+  if (abs_exact != 0 && abs_exact < min)
+    __atomic_add_fetch(&ctx->ftz_count, 1, __ATOMIC_RELAXED);
+}
+
+/* Reduced-precision profile (--precision-profile)                         */
+/* Operations are counted per call site, with the formats all their      */
+/* floating-point operands and their result fit, see common/precision.h  */
+
+static inline void _ieee_precision_count(ieee_context_t *ctx, const void *site,
+                                         ieee_trace_opcode_t opcode,
+                                         ieee_trace_precision_t precision,
+                                         unsigned fits) {
+  ieee_site_t *entry = ieee_site_lookup(
+      ctx->precision_sites, ieee_site_key(site, opcode, precision));
+  ieee_site_add(entry, 0, 1);
+  for (int f = 0; f < IEEE_N_FORMATS; f++) {
+    if (fits & (1U << f))
+      ieee_site_add(entry, IEEE_PRECISION_COUNTER(f), 1);
+  }
+}
+
+/* Vectorization coverage (--vector-coverage), operations reaching the */
+/* scalar entry points. The vbackend kernels count the vector ones      */
+static inline void _ieee_coverage_count(ieee_context_t *ctx, const void *site,
+                                        ieee_trace_opcode_t opcode,
+                                        ieee_trace_precision_t precision) {
+  ieee_site_t *entry = ieee_site_lookup(ctx->vector_sites,
+                                        ieee_site_key(site, opcode, precision));
+  ieee_site_add(entry, IEEE_COVERAGE_OPS, 1);
+  ieee_site_add(entry, IEEE_COVERAGE_SCALAR, 1);
+}
+
+/* Subnormal penalty profile (--subnormal-profile), see common/subnormal.h */
+
+static inline float _ieee_fma_float(float a, float b, float c,
+                                    const ieee_context_t *ctx);
+static inline double _ieee_fma_double(double a, double b, double c,
+                                      const ieee_context_t *ctx);
+
+/* Defines _ieee_subnormal_time_<TYPE>, which returns the cycles of      */
+/* <opcode> on the operands, the least of two runs. The volatile copies */
+/* keep the operation from being folded or moved out of the clock reads */
+#define DEFINE_SUBNORMAL_TIMER(TYPE)                                           \
+  static uint64_t _ieee_subnormal_time_##TYPE(                                 \
+      const ieee_context_t *ctx, ieee_trace_opcode_t opcode, TYPE a, TYPE b,   \
+      TYPE c) {                                                                \
+    uint64_t best = UINT64_MAX;                                                \
+    for (int i = 0; i < 2; i++) {                                              \
+      volatile TYPE x = a, y = b, z = c, r;                                    \
+      const uint64_t start = ieee_overhead_clock();                            \
+      switch (opcode) {                                                        \
+      case IEEE_TRACE_ADD:                                                     \
+        r = x + y;                                                             \
+        break;                                                                 \
+      case IEEE_TRACE_SUB:                                                     \
+        r = x - y;                                                             \
+        break;                                                                 \
+      case IEEE_TRACE_MUL:                                                     \
+        r = x * y;                                                             \
+        break;                                                                 \
+      case IEEE_TRACE_DIV:                                                     \
+        r = x / y;                                                             \
+        break;                                                                 \
+      case IEEE_TRACE_CMP:                                                     \
+        r = isless(x, y);                                                      \
+        break;                                                                 \
+      case IEEE_TRACE_CAST:                                                    \
+        r = (float)x;                                                          \
+        break;                                                                 \
+      default:                                                                 \
+        r = _ieee_fma_##TYPE(x, y, z, ctx);                                    \
+        break;                                                                 \
+      }                                                                        \
+      const uint64_t stop = ieee_overhead_clock();                             \
+      (void)r;                                                                 \
+      if (stop - start < best)                                                 \
+        best = stop - start;                                                   \
+    }                                                                          \
+    return best;                                                               \
+  }
+
+DEFINE_SUBNORMAL_TIMER(float)
+DEFINE_SUBNORMAL_TIMER(double)
+
+/* Defines _ieee_subnormal_record_<TYPE>, which counts an operation with   */
+/* subnormal operands (<in>) or result (<out>) at <site>, and replays it  */
+/* with its operands then with 1.0 if the thread takes a sample           */
+#define DEFINE_SUBNORMAL_RECORD(TYPE, PRECISION)                               \
+  static void _ieee_subnormal_record_##TYPE(                                   \
+      ieee_context_t *ctx, const void *site, ieee_trace_opcode_t opcode,       \
+      unsigned in, unsigned out, TYPE a, TYPE b, TYPE c) {                     \
+    ieee_site_t *entry = ieee_site_lookup(                                     \
+        ctx->subnormal_sites, ieee_site_key(site, opcode, PRECISION));         \
+    ieee_site_add(entry, IEEE_SUBNORMAL_OPS, 1);                               \
+    ieee_site_add(entry, IEEE_SUBNORMAL_CALLS, 1);                             \
+    if (in)                                                                    \
+      ieee_site_add(entry, IEEE_SUBNORMAL_INPUTS, 1);                          \
+    if (out)                                                                   \
+      ieee_site_add(entry, IEEE_SUBNORMAL_OUTPUTS, 1);                         \
+    if (!ieee_subnormal_sample())                                              \
+      return;                                                                  \
+    ieee_site_add(entry, IEEE_SUBNORMAL_SAMPLES, 1);                           \
+    ieee_site_add(entry, IEEE_SUBNORMAL_CYCLES,                                \
+                  _ieee_subnormal_time_##TYPE(ctx, opcode, a, b, c));          \
+    ieee_site_add(entry, IEEE_SUBNORMAL_REFERENCE_CYCLES,                      \
+                  _ieee_subnormal_time_##TYPE(ctx, opcode, 1, 1, 1));          \
+  }
+
+DEFINE_SUBNORMAL_RECORD(float, IEEE_TRACE_FLOAT)
+DEFINE_SUBNORMAL_RECORD(double, IEEE_TRACE_DOUBLE)
+
+/* Per-operation hook of the instrumented entry points                     */
+/* An operation is given by the fields of its trace record: opcode,        */
+/* precision of the operands, predicate of a comparison, and bit patterns  */
+/* of the operands and of the result, unused operands being zero. Every    */
+/* option observing single operations is fed from here, the entry points   */
+/* only compute, count and print. It is inlined with constant opcode and   */
+/* precision, so each entry point keeps only the tests of its options.     */
+
+static inline float _ieee_bits_float(uint64_t bits) {
+  const uint32_t low = (uint32_t)bits;
+  float x;
+  memcpy(&x, &low, sizeof(x));
+  return x;
+}
+
+static inline double _ieee_bits_double(uint64_t bits) {
+  double x;
+  memcpy(&x, &bits, sizeof(x));
+  return x;
+}
+
+static inline long double _ieee_bits_value(ieee_trace_precision_t precision,
+                                           uint64_t bits) {
+  return (precision == IEEE_TRACE_DOUBLE) ? _ieee_bits_double(bits)
+                                          : _ieee_bits_float(bits);
+}
+
+static inline unsigned _ieee_bits_subnormal(ieee_trace_precision_t precision,
+                                            uint64_t bits) {
+  return (precision == IEEE_TRACE_DOUBLE)
+             ? ieee_subnormal_binary64(bits)
+             : ieee_subnormal_binary32((uint32_t)bits);
+}
+
+static inline unsigned _ieee_bits_fits(const ieee_context_t *ctx,
+                                       ieee_trace_precision_t precision,
+                                       uint64_t bits) {
+  return (precision == IEEE_TRACE_DOUBLE)
+             ? ieee_precision_fits_binary64(bits, ctx->precision_ulps)
+             : ieee_precision_fits_binary32((uint32_t)bits,
+                                            ctx->precision_ulps);
+}
+
+/* Exact result of <opcode>, for --ftz-daz, none for a comparison */
+static inline long double _ieee_exact(ieee_trace_opcode_t opcode,
+                                      long double a, long double b,
+                                      long double c) {
+  switch (opcode) {
+  case IEEE_TRACE_ADD:
+    return a + b;
+  case IEEE_TRACE_SUB:
+    return a - b;
+  case IEEE_TRACE_MUL:
+    return a * b;
+  case IEEE_TRACE_DIV:
+    return a / b;
+  case IEEE_TRACE_CAST:
+    return a;
+  case IEEE_TRACE_FMA:
+    return a * b + c;
+  default:
+    return 0;
+  }
+}
+
+static inline __attribute__((always_inline)) void
+_ieee_observe(ieee_context_t *ctx, const void *return_address,
+              ieee_trace_opcode_t opcode, ieee_trace_precision_t precision,
+              int predicate, uint64_t a, uint64_t b, uint64_t c,
+              uint64_t result) {
+  /* A cast returns a float, a comparison an int */
+  const ieee_trace_precision_t result_precision =
+      (opcode == IEEE_TRACE_CAST) ? IEEE_TRACE_FLOAT : precision;
+  const bool float_result = opcode != IEEE_TRACE_CMP;
+
+  if (ctx->ftz_daz) {
+    const long double exact = _ieee_exact(
+        opcode, _ieee_bits_value(precision, a),
+        _ieee_bits_value(precision, b), _ieee_bits_value(precision, c));
+    _ieee_ftz_daz_count(ctx,
+                        _ieee_bits_subnormal(precision, a) +
+                            _ieee_bits_subnormal(precision, b) +
+                            _ieee_bits_subnormal(precision, c),
+                        float_result ? exact : 0,
+                        (result_precision == IEEE_TRACE_DOUBLE) ? DBL_MIN
+                                                                : FLT_MIN);
+  }
+  if (ctx->trace)
+    _ieee_trace(opcode, precision, predicate, a, b, c, result);
+  if (ctx->flight_recorder)
+    ieee_flight_record(opcode, precision, predicate, a, b, c, result,
+                       ieee_call_site(return_address));
+  IEEE_PROBE_OP(opcode, precision, predicate, a, b, c, result);
+  if (ctx->fingerprint)
+    _ieee_fingerprint(opcode, precision, result);
+  if (ctx->precision_profile) {
+    /* Zero, in place of the unused operands, fits every format */
+    unsigned fits = _ieee_bits_fits(ctx, precision, a) &
+                    _ieee_bits_fits(ctx, precision, b) &
+                    _ieee_bits_fits(ctx, precision, c);
+    if (float_result)
+      fits &= _ieee_bits_fits(ctx, result_precision, result);
+    _ieee_precision_count(ctx, ieee_call_site(return_address), opcode,
+                          precision, fits);
+  }
+  if (ctx->vector_coverage)
+    _ieee_coverage_count(ctx, ieee_call_site(return_address), opcode,
+                         precision);
+  if (ctx->subnormal_profile) {
+    const unsigned in = _ieee_bits_subnormal(precision, a) |
+                        _ieee_bits_subnormal(precision, b) |
+                        _ieee_bits_subnormal(precision, c);
+    const unsigned out =
+        float_result && _ieee_bits_subnormal(result_precision, result);
+    if (__builtin_expect(in | out, 0)) {
+      const void *site = ieee_call_site(return_address);
+      if (precision == IEEE_TRACE_DOUBLE)
+        _ieee_subnormal_record_double(ctx, site, opcode, in, out,
+                                      _ieee_bits_double(a),
+                                      _ieee_bits_double(b),
+                                      _ieee_bits_double(c));
+      else
+        _ieee_subnormal_record_float(ctx, site, opcode, in, out,
+                                     _ieee_bits_float(a), _ieee_bits_float(b),
+                                     _ieee_bits_float(c));
+    }
+  }
+}
+
 void INTERFLOP_IEEE_API(add_float)(const float a, const float b, float *c,
                                    void *context) {
   ieee_context_t *my_context = (ieee_context_t *)context;
   *c = a + b;
-  if (my_context->count_op)
-    __atomic_add_fetch(&my_context->add_count, 1, __ATOMIC_RELAXED);
+  _ieee_count_op(my_context, IEEE_SHM_STATS_ADD, &my_context->add_count);
+  _ieee_observe(my_context, IEEE_RETURN_ADDRESS(), IEEE_TRACE_ADD,
+                IEEE_TRACE_FLOAT, 0, _ieee_float_bits(a), _ieee_float_bits(b),
+                0, _ieee_float_bits(*c));
   debug_print_float(context, ARITHMETIC, "+", a, b, *c);
 }
 
@@ -306,8 +855,10 @@ void INTERFLOP_IEEE_API(sub_float)(const float a, const float b, float *c,
                                    void *context) {
   ieee_context_t *my_context = (ieee_context_t *)context;
   *c = a - b;
-  if (my_context->count_op)
-    __atomic_add_fetch(&my_context->sub_count, 1, __ATOMIC_RELAXED);
+  _ieee_count_op(my_context, IEEE_SHM_STATS_SUB, &my_context->sub_count);
+  _ieee_observe(my_context, IEEE_RETURN_ADDRESS(), IEEE_TRACE_SUB,
+                IEEE_TRACE_FLOAT, 0, _ieee_float_bits(a), _ieee_float_bits(b),
+                0, _ieee_float_bits(*c));
   debug_print_float(context, ARITHMETIC, "-", a, b, *c);
 }
 
@@ -315,8 +866,10 @@ void INTERFLOP_IEEE_API(mul_float)(const float a, const float b, float *c,
                                    void *context) {
   ieee_context_t *my_context = (ieee_context_t *)context;
   *c = a * b;
-  if (my_context->count_op)
-    __atomic_add_fetch(&my_context->mul_count, 1, __ATOMIC_RELAXED);
+  _ieee_count_op(my_context, IEEE_SHM_STATS_MUL, &my_context->mul_count);
+  _ieee_observe(my_context, IEEE_RETURN_ADDRESS(), IEEE_TRACE_MUL,
+                IEEE_TRACE_FLOAT, 0, _ieee_float_bits(a), _ieee_float_bits(b),
+                0, _ieee_float_bits(*c));
   debug_print_float(context, ARITHMETIC, "*", a, b, *c);
 }
 
@@ -324,15 +877,21 @@ void INTERFLOP_IEEE_API(div_float)(const float a, const float b, float *c,
                                    void *context) {
   ieee_context_t *my_context = (ieee_context_t *)context;
   *c = a / b;
-  if (my_context->count_op)
-    __atomic_add_fetch(&my_context->div_count, 1, __ATOMIC_RELAXED);
+  _ieee_count_op(my_context, IEEE_SHM_STATS_DIV, &my_context->div_count);
+  _ieee_observe(my_context, IEEE_RETURN_ADDRESS(), IEEE_TRACE_DIV,
+                IEEE_TRACE_FLOAT, 0, _ieee_float_bits(a), _ieee_float_bits(b),
+                0, _ieee_float_bits(*c));
   debug_print_float(context, ARITHMETIC, "/", a, b, *c);
 }
 
 void INTERFLOP_IEEE_API(cmp_float)(const enum FCMP_PREDICATE p, const float a,
                                    const float b, int *c, void *context) {
   char *str = "";
+  ieee_context_t *my_context = (ieee_context_t *)context;
   SELECT_FLOAT_CMP(a, b, c, p, str);
+  _ieee_observe(my_context, IEEE_RETURN_ADDRESS(), IEEE_TRACE_CMP,
+                IEEE_TRACE_FLOAT, p, _ieee_float_bits(a), _ieee_float_bits(b),
+                0, (uint32_t)*c);
   debug_print_float(context, COMPARISON, str, a, b, *c);
 }
 
@@ -340,8 +899,10 @@ void INTERFLOP_IEEE_API(add_double)(const double a, const double b, double *c,
                                     void *context) {
   ieee_context_t *my_context = (ieee_context_t *)context;
   *c = a + b;
-  if (my_context->count_op)
-    __atomic_add_fetch(&my_context->add_count, 1, __ATOMIC_RELAXED);
+  _ieee_count_op(my_context, IEEE_SHM_STATS_ADD, &my_context->add_count);
+  _ieee_observe(my_context, IEEE_RETURN_ADDRESS(), IEEE_TRACE_ADD,
+                IEEE_TRACE_DOUBLE, 0, _ieee_double_bits(a),
+                _ieee_double_bits(b), 0, _ieee_double_bits(*c));
   debug_print_double(context, ARITHMETIC, "+", a, b, *c);
 }
 
@@ -349,8 +910,10 @@ void INTERFLOP_IEEE_API(sub_double)(const double a, const double b, double *c,
                                     void *context) {
   ieee_context_t *my_context = (ieee_context_t *)context;
   *c = a - b;
-  if (my_context->count_op)
-    __atomic_add_fetch(&my_context->sub_count, 1, __ATOMIC_RELAXED);
+  _ieee_count_op(my_context, IEEE_SHM_STATS_SUB, &my_context->sub_count);
+  _ieee_observe(my_context, IEEE_RETURN_ADDRESS(), IEEE_TRACE_SUB,
+                IEEE_TRACE_DOUBLE, 0, _ieee_double_bits(a),
+                _ieee_double_bits(b), 0, _ieee_double_bits(*c));
   debug_print_double(context, ARITHMETIC, "-", a, b, *c);
 }
 
@@ -358,8 +921,10 @@ void INTERFLOP_IEEE_API(mul_double)(const double a, const double b, double *c,
                                     void *context) {
   ieee_context_t *my_context = (ieee_context_t *)context;
   *c = a * b;
-  if (my_context->count_op)
-    __atomic_add_fetch(&my_context->mul_count, 1, __ATOMIC_RELAXED);
+  _ieee_count_op(my_context, IEEE_SHM_STATS_MUL, &my_context->mul_count);
+  _ieee_observe(my_context, IEEE_RETURN_ADDRESS(), IEEE_TRACE_MUL,
+                IEEE_TRACE_DOUBLE, 0, _ieee_double_bits(a),
+                _ieee_double_bits(b), 0, _ieee_double_bits(*c));
   debug_print_double(context, ARITHMETIC, "*", a, b, *c);
 }
 
@@ -367,58 +932,987 @@ void INTERFLOP_IEEE_API(div_double)(const double a, const double b, double *c,
                                     void *context) {
   ieee_context_t *my_context = (ieee_context_t *)context;
   *c = a / b;
-  if (my_context->count_op)
-    __atomic_add_fetch(&my_context->div_count, 1, __ATOMIC_RELAXED);
+  _ieee_count_op(my_context, IEEE_SHM_STATS_DIV, &my_context->div_count);
+  _ieee_observe(my_context, IEEE_RETURN_ADDRESS(), IEEE_TRACE_DIV,
+                IEEE_TRACE_DOUBLE, 0, _ieee_double_bits(a),
+                _ieee_double_bits(b), 0, _ieee_double_bits(*c));
   debug_print_double(context, ARITHMETIC, "/", a, b, *c);
 }
 
 void INTERFLOP_IEEE_API(cmp_double)(const enum FCMP_PREDICATE p, const double a,
                                     const double b, int *c, void *context) {
   char *str = "";
+  ieee_context_t *my_context = (ieee_context_t *)context;
   SELECT_FLOAT_CMP(a, b, c, p, str);
+  _ieee_observe(my_context, IEEE_RETURN_ADDRESS(), IEEE_TRACE_CMP,
+                IEEE_TRACE_DOUBLE, p, _ieee_double_bits(a),
+                _ieee_double_bits(b), 0, (uint32_t)*c);
   debug_print_double(context, COMPARISON, str, a, b, *c);
 }
 
 void INTERFLOP_IEEE_API(cast_double_to_float)(double a, float *b,
                                               void *context) {
+  ieee_context_t *my_context = (ieee_context_t *)context;
   *b = (float)a;
+  _ieee_observe(my_context, IEEE_RETURN_ADDRESS(), IEEE_TRACE_CAST,
+                IEEE_TRACE_DOUBLE, 0, _ieee_double_bits(a), 0, 0,
+                _ieee_float_bits(*b));
   debug_print_cast_double_to_float(context, CAST, "(float)", a, *b);
 }
 
+/* FMA operations use the FMA3 instructions when the CPU has them, which */
+/* is detected once by init. They are correctly rounded like the software */
+/* FMA of the interflop library and honor the thread MXCSR. Without FMA3, */
+/* the software FMA is used to round to nearest and the libm fma for the  */
+/* other rounding modes                                                   */
+static bool ieee_hw_fma = false;
+
+#if defined(__x86_64__)
+__attribute__((target("fma"))) static float _ieee_fma_float_hw(float a,
+                                                                float b,
+                                                                float c) {
+  return __builtin_fmaf(a, b, c);
+}
+
+__attribute__((target("fma"))) static double _ieee_fma_double_hw(double a,
+                                                                  double b,
+                                                                  double c) {
+  return __builtin_fma(a, b, c);
+}
+#endif
+
+static inline float _ieee_fma_float(float a, float b, float c,
+                                    const ieee_context_t *ctx) {
+#if defined(__x86_64__)
+  if (__builtin_expect(ieee_hw_fma, 1))
+    return _ieee_fma_float_hw(a, b, c);
+#endif
+  if (ctx->rounding == IEEE_ROUND_NEAREST)
+    return interflop_fma_binary32(a, b, c);
+  return fmaf(a, b, c);
+}
+
+static inline double _ieee_fma_double(double a, double b, double c,
+                                      const ieee_context_t *ctx) {
+#if defined(__x86_64__)
+  if (__builtin_expect(ieee_hw_fma, 1))
+    return _ieee_fma_double_hw(a, b, c);
+#endif
+  if (ctx->rounding == IEEE_ROUND_NEAREST)
+    return interflop_fma_binary64(a, b, c);
+  return fma(a, b, c);
+}
+
 void INTERFLOP_IEEE_API(fma_float)(float a, float b, float c, float *res,
                                    void *context) {
   ieee_context_t *my_context = (ieee_context_t *)context;
-  *res = interflop_fma_binary32(a, b, c);
-  if (my_context->count_op)
-    __atomic_add_fetch(&my_context->fma_count, 1, __ATOMIC_RELAXED);
+  *res = _ieee_fma_float(a, b, c, my_context);
+  _ieee_count_op(my_context, IEEE_SHM_STATS_FMA, &my_context->fma_count);
+  _ieee_observe(my_context, IEEE_RETURN_ADDRESS(), IEEE_TRACE_FMA,
+                IEEE_TRACE_FLOAT, 0, _ieee_float_bits(a), _ieee_float_bits(b),
+                _ieee_float_bits(c), _ieee_float_bits(*res));
   debug_print_fma_float(context, FMA, "fma", a, b, c, *res);
 }
 
 void INTERFLOP_IEEE_API(fma_double)(double a, double b, double c, double *res,
                                     void *context) {
   ieee_context_t *my_context = (ieee_context_t *)context;
-  *res = interflop_fma_binary64(a, b, c);
-  if (my_context->count_op)
-    __atomic_add_fetch(&my_context->fma_count, 1, __ATOMIC_RELAXED);
+  *res = _ieee_fma_double(a, b, c, my_context);
+  _ieee_count_op(my_context, IEEE_SHM_STATS_FMA, &my_context->fma_count);
+  _ieee_observe(my_context, IEEE_RETURN_ADDRESS(), IEEE_TRACE_FMA,
+                IEEE_TRACE_DOUBLE, 0, _ieee_double_bits(a),
+                _ieee_double_bits(b), _ieee_double_bits(c),
+                _ieee_double_bits(*res));
   debug_print_fma_double(context, FMA, "fma", a, b, c, *res);
 }
 
+/* Bare variants, plain IEEE-754 operations without any instrumentation */
+/* They are installed instead of the instrumented ones when no option   */
+/* needs to observe the operations. Their bodies are the inline ones of */
+/* interflop_ieee_inline.h, except fma which picks the FMA3 instruction */
+/* at runtime                                                            */
+
+static void _ieee_add_float_bare(const float a, const float b, float *c,
+                                 void *context) {
+  INTERFLOP_IEEE_INLINE_API(add_float)(a, b, c, context);
+  IEEE_PROBE_OP(IEEE_TRACE_ADD, IEEE_TRACE_FLOAT, 0, _ieee_float_bits(a),
+                _ieee_float_bits(b), 0, _ieee_float_bits(*c));
+}
+
+static void _ieee_sub_float_bare(const float a, const float b, float *c,
+                                 void *context) {
+  INTERFLOP_IEEE_INLINE_API(sub_float)(a, b, c, context);
+  IEEE_PROBE_OP(IEEE_TRACE_SUB, IEEE_TRACE_FLOAT, 0, _ieee_float_bits(a),
+                _ieee_float_bits(b), 0, _ieee_float_bits(*c));
+}
+
+static void _ieee_mul_float_bare(const float a, const float b, float *c,
+                                 void *context) {
+  INTERFLOP_IEEE_INLINE_API(mul_float)(a, b, c, context);
+  IEEE_PROBE_OP(IEEE_TRACE_MUL, IEEE_TRACE_FLOAT, 0, _ieee_float_bits(a),
+                _ieee_float_bits(b), 0, _ieee_float_bits(*c));
+}
+
+static void _ieee_div_float_bare(const float a, const float b, float *c,
+                                 void *context) {
+  INTERFLOP_IEEE_INLINE_API(div_float)(a, b, c, context);
+  IEEE_PROBE_OP(IEEE_TRACE_DIV, IEEE_TRACE_FLOAT, 0, _ieee_float_bits(a),
+                _ieee_float_bits(b), 0, _ieee_float_bits(*c));
+}
+
+static void _ieee_cmp_float_bare(const enum FCMP_PREDICATE p, const float a,
+                                 const float b, int *c, void *context) {
+  INTERFLOP_IEEE_INLINE_API(cmp_float)(p, a, b, c, context);
+  IEEE_PROBE_OP(IEEE_TRACE_CMP, IEEE_TRACE_FLOAT, p, _ieee_float_bits(a),
+                _ieee_float_bits(b), 0, (uint32_t)*c);
+}
+
+static void _ieee_add_double_bare(const double a, const double b, double *c,
+                                  void *context) {
+  INTERFLOP_IEEE_INLINE_API(add_double)(a, b, c, context);
+  IEEE_PROBE_OP(IEEE_TRACE_ADD, IEEE_TRACE_DOUBLE, 0, _ieee_double_bits(a),
+                _ieee_double_bits(b), 0, _ieee_double_bits(*c));
+}
+
+static void _ieee_sub_double_bare(const double a, const double b, double *c,
+                                  void *context) {
+  INTERFLOP_IEEE_INLINE_API(sub_double)(a, b, c, context);
+  IEEE_PROBE_OP(IEEE_TRACE_SUB, IEEE_TRACE_DOUBLE, 0, _ieee_double_bits(a),
+                _ieee_double_bits(b), 0, _ieee_double_bits(*c));
+}
+
+static void _ieee_mul_double_bare(const double a, const double b, double *c,
+                                  void *context) {
+  INTERFLOP_IEEE_INLINE_API(mul_double)(a, b, c, context);
+  IEEE_PROBE_OP(IEEE_TRACE_MUL, IEEE_TRACE_DOUBLE, 0, _ieee_double_bits(a),
+                _ieee_double_bits(b), 0, _ieee_double_bits(*c));
+}
+
+static void _ieee_div_double_bare(const double a, const double b, double *c,
+                                  void *context) {
+  INTERFLOP_IEEE_INLINE_API(div_double)(a, b, c, context);
+  IEEE_PROBE_OP(IEEE_TRACE_DIV, IEEE_TRACE_DOUBLE, 0, _ieee_double_bits(a),
+                _ieee_double_bits(b), 0, _ieee_double_bits(*c));
+}
+
+static void _ieee_cmp_double_bare(const enum FCMP_PREDICATE p, const double a,
+                                  const double b, int *c, void *context) {
+  INTERFLOP_IEEE_INLINE_API(cmp_double)(p, a, b, c, context);
+  IEEE_PROBE_OP(IEEE_TRACE_CMP, IEEE_TRACE_DOUBLE, p, _ieee_double_bits(a),
+                _ieee_double_bits(b), 0, (uint32_t)*c);
+}
+
+static void _ieee_cast_double_to_float_bare(double a, float *b,
+                                            void *context) {
+  INTERFLOP_IEEE_INLINE_API(cast_double_to_float)(a, b, context);
+  IEEE_PROBE_OP(IEEE_TRACE_CAST, IEEE_TRACE_DOUBLE, 0, _ieee_double_bits(a), 0,
+                0, _ieee_float_bits(*b));
+}
+
+static void _ieee_fma_float_bare(float a, float b, float c, float *res,
+                                 void *context) {
+  *res = _ieee_fma_float(a, b, c, (ieee_context_t *)context);
+  IEEE_PROBE_OP(IEEE_TRACE_FMA, IEEE_TRACE_FLOAT, 0, _ieee_float_bits(a),
+                _ieee_float_bits(b), _ieee_float_bits(c),
+                _ieee_float_bits(*res));
+}
+
+static void _ieee_fma_double_bare(double a, double b, double c, double *res,
+                                  void *context) {
+  *res = _ieee_fma_double(a, b, c, (ieee_context_t *)context);
+  IEEE_PROBE_OP(IEEE_TRACE_FMA, IEEE_TRACE_DOUBLE, 0, _ieee_double_bits(a),
+                _ieee_double_bits(b), _ieee_double_bits(c),
+                _ieee_double_bits(*res));
+}
+
+/* Table of the scalar operations installed in the backend interface */
+typedef struct {
+  void (*add_float)(const float, const float, float *, void *);
+  void (*sub_float)(const float, const float, float *, void *);
+  void (*mul_float)(const float, const float, float *, void *);
+  void (*div_float)(const float, const float, float *, void *);
+  void (*cmp_float)(const enum FCMP_PREDICATE, const float, const float, int *,
+                    void *);
+  void (*add_double)(const double, const double, double *, void *);
+  void (*sub_double)(const double, const double, double *, void *);
+  void (*mul_double)(const double, const double, double *, void *);
+  void (*div_double)(const double, const double, double *, void *);
+  void (*cmp_double)(const enum FCMP_PREDICATE, const double, const double,
+                     int *, void *);
+  void (*cast_double_to_float)(double, float *, void *);
+  void (*fma_float)(float, float, float, float *, void *);
+  void (*fma_double)(double, double, double, double *, void *);
+} ieee_ops_t;
+
+static const ieee_ops_t ieee_bare_ops = {
+    _ieee_add_float_bare,  _ieee_sub_float_bare,
+    _ieee_mul_float_bare,  _ieee_div_float_bare,
+    _ieee_cmp_float_bare,  _ieee_add_double_bare,
+    _ieee_sub_double_bare, _ieee_mul_double_bare,
+    _ieee_div_double_bare, _ieee_cmp_double_bare,
+    _ieee_cast_double_to_float_bare, _ieee_fma_float_bare,
+    _ieee_fma_double_bare,
+};
+
+static const ieee_ops_t ieee_instrumented_ops = {
+    INTERFLOP_IEEE_API(add_float),  INTERFLOP_IEEE_API(sub_float),
+    INTERFLOP_IEEE_API(mul_float),  INTERFLOP_IEEE_API(div_float),
+    INTERFLOP_IEEE_API(cmp_float),  INTERFLOP_IEEE_API(add_double),
+    INTERFLOP_IEEE_API(sub_double), INTERFLOP_IEEE_API(mul_double),
+    INTERFLOP_IEEE_API(div_double), INTERFLOP_IEEE_API(cmp_double),
+    INTERFLOP_IEEE_API(cast_double_to_float), INTERFLOP_IEEE_API(fma_float),
+    INTERFLOP_IEEE_API(fma_double),
+};
+
+/* Operations of --count-sample when nothing else is instrumented: the    */
+/* bare operation, then the counter update of the sampled ones only. The */
+/* comparisons and casts are not counted                                  */
+#define DEFINE_SAMPLED_OP(NAME, TYPE, COUNT)                                   \
+  static void _ieee_##NAME##_sampled(const TYPE a, const TYPE b, TYPE *c,      \
+                                     void *context) {                          \
+    _ieee_##NAME##_bare(a, b, c, context);                                     \
+    if (ieee_count_sample()) {                                                 \
+      ieee_context_t *ctx = (ieee_context_t *)context;                         \
+      __atomic_add_fetch(&ctx->COUNT, ctx->count_sample, __ATOMIC_RELAXED);    \
+    }                                                                          \
+  }
+
+#define DEFINE_SAMPLED_FMA(NAME, TYPE)                                         \
+  static void _ieee_##NAME##_sampled(TYPE a, TYPE b, TYPE c, TYPE *res,        \
+                                     void *context) {                          \
+    _ieee_##NAME##_bare(a, b, c, res, context);                                \
+    if (ieee_count_sample()) {                                                 \
+      ieee_context_t *ctx = (ieee_context_t *)context;                         \
+      __atomic_add_fetch(&ctx->fma_count, ctx->count_sample,                   \
+                         __ATOMIC_RELAXED);                                    \
+    }                                                                          \
+  }
+
+DEFINE_SAMPLED_OP(add_float, float, add_count)
+DEFINE_SAMPLED_OP(sub_float, float, sub_count)
+DEFINE_SAMPLED_OP(mul_float, float, mul_count)
+DEFINE_SAMPLED_OP(div_float, float, div_count)
+DEFINE_SAMPLED_OP(add_double, double, add_count)
+DEFINE_SAMPLED_OP(sub_double, double, sub_count)
+DEFINE_SAMPLED_OP(mul_double, double, mul_count)
+DEFINE_SAMPLED_OP(div_double, double, div_count)
+DEFINE_SAMPLED_FMA(fma_float, float)
+DEFINE_SAMPLED_FMA(fma_double, double)
+
+static const ieee_ops_t ieee_sampled_ops = {
+    _ieee_add_float_sampled,  _ieee_sub_float_sampled,
+    _ieee_mul_float_sampled,  _ieee_div_float_sampled,
+    _ieee_cmp_float_bare,     _ieee_add_double_sampled,
+    _ieee_sub_double_sampled, _ieee_mul_double_sampled,
+    _ieee_div_double_sampled, _ieee_cmp_double_bare,
+    _ieee_cast_double_to_float_bare, _ieee_fma_float_sampled,
+    _ieee_fma_double_sampled,
+};
+
+/* Returns the table specialized for the options set in <ctx> */
+static const ieee_ops_t *_ieee_select_ops(const ieee_context_t *ctx) {
+  /* --ftz-daz counts its flushes in the instrumented operations */
+  const bool instrumented =
+      ctx->debug || ctx->debug_binary || ctx->debug_hex || ctx->shm_stats ||
+      ctx->trace || ctx->precision_profile || ctx->vector_coverage ||
+      ctx->fingerprint || ctx->subnormal_profile || ctx->flight_recorder ||
+      ctx->ftz_daz;
+  const bool counted = ctx->count_op || ctx->report_dir != NULL;
+  if (counted && ctx->count_sample != 0 && !instrumented)
+    return &ieee_sampled_ops;
+  return instrumented || counted ? &ieee_instrumented_ops : &ieee_bare_ops;
+}
+
+/* Table used by the dispatchers. It is replaced with a release store     */
+/* once the new options are written in the context (--live-config) and   */
+/* read with an acquire load, so that the operations of the new table see */
+/* those options. On x86 the acquire load is a plain load                 */
+static const ieee_ops_t *ieee_active_ops = &ieee_bare_ops;
+
+#define ACTIVE_OPS() __atomic_load_n(&ieee_active_ops, __ATOMIC_ACQUIRE)
+
+/* Defines the dispatchers _ieee_<op>_<SUFFIX> forwarding to the active   */
+/* table after PROLOGUE, and the table ieee_<SUFFIX>_ops gathering them   */
+#define DEFINE_DISPATCHERS(SUFFIX, PROLOGUE)                                   \
+  static void _ieee_add_float_##SUFFIX(const float a, const float b, float *c, \
+                                       void *context) {                        \
+    PROLOGUE;                                                                  \
+    ACTIVE_OPS()->add_float(a, b, c, context);                                 \
+  }                                                                            \
+  static void _ieee_sub_float_##SUFFIX(const float a, const float b, float *c, \
+                                       void *context) {                        \
+    PROLOGUE;                                                                  \
+    ACTIVE_OPS()->sub_float(a, b, c, context);                                 \
+  }                                                                            \
+  static void _ieee_mul_float_##SUFFIX(const float a, const float b, float *c, \
+                                       void *context) {                        \
+    PROLOGUE;                                                                  \
+    ACTIVE_OPS()->mul_float(a, b, c, context);                                 \
+  }                                                                            \
+  static void _ieee_div_float_##SUFFIX(const float a, const float b, float *c, \
+                                       void *context) {                        \
+    PROLOGUE;                                                                  \
+    ACTIVE_OPS()->div_float(a, b, c, context);                                 \
+  }                                                                            \
+  static void _ieee_cmp_float_##SUFFIX(const enum FCMP_PREDICATE p,            \
+                                       const float a, const float b, int *c,   \
+                                       void *context) {                        \
+    PROLOGUE;                                                                  \
+    ACTIVE_OPS()->cmp_float(p, a, b, c, context);                              \
+  }                                                                            \
+  static void _ieee_add_double_##SUFFIX(const double a, const double b,        \
+                                        double *c, void *context) {            \
+    PROLOGUE;                                                                  \
+    ACTIVE_OPS()->add_double(a, b, c, context);                                \
+  }                                                                            \
+  static void _ieee_sub_double_##SUFFIX(const double a, const double b,        \
+                                        double *c, void *context) {            \
+    PROLOGUE;                                                                  \
+    ACTIVE_OPS()->sub_double(a, b, c, context);                                \
+  }                                                                            \
+  static void _ieee_mul_double_##SUFFIX(const double a, const double b,        \
+                                        double *c, void *context) {            \
+    PROLOGUE;                                                                  \
+    ACTIVE_OPS()->mul_double(a, b, c, context);                                \
+  }                                                                            \
+  static void _ieee_div_double_##SUFFIX(const double a, const double b,        \
+                                        double *c, void *context) {            \
+    PROLOGUE;                                                                  \
+    ACTIVE_OPS()->div_double(a, b, c, context);                                \
+  }                                                                            \
+  static void _ieee_cmp_double_##SUFFIX(const enum FCMP_PREDICATE p,           \
+                                        const double a, const double b,        \
+                                        int *c, void *context) {               \
+    PROLOGUE;                                                                  \
+    ACTIVE_OPS()->cmp_double(p, a, b, c, context);                             \
+  }                                                                            \
+  static void _ieee_cast_double_to_float_##SUFFIX(double a, float *b,          \
+                                                  void *context) {             \
+    PROLOGUE;                                                                  \
+    ACTIVE_OPS()->cast_double_to_float(a, b, context);                         \
+  }                                                                            \
+  static void _ieee_fma_float_##SUFFIX(float a, float b, float c, float *res,  \
+                                       void *context) {                        \
+    PROLOGUE;                                                                  \
+    ACTIVE_OPS()->fma_float(a, b, c, res, context);                            \
+  }                                                                            \
+  static void _ieee_fma_double_##SUFFIX(double a, double b, double c,          \
+                                        double *res, void *context) {          \
+    PROLOGUE;                                                                  \
+    ACTIVE_OPS()->fma_double(a, b, c, res, context);                           \
+  }                                                                            \
+  static const ieee_ops_t ieee_##SUFFIX##_ops = {                              \
+      _ieee_add_float_##SUFFIX,  _ieee_sub_float_##SUFFIX,                     \
+      _ieee_mul_float_##SUFFIX,  _ieee_div_float_##SUFFIX,                     \
+      _ieee_cmp_float_##SUFFIX,  _ieee_add_double_##SUFFIX,                    \
+      _ieee_sub_double_##SUFFIX, _ieee_mul_double_##SUFFIX,                    \
+      _ieee_div_double_##SUFFIX, _ieee_cmp_double_##SUFFIX,                    \
+      _ieee_cast_double_to_float_##SUFFIX, _ieee_fma_float_##SUFFIX,           \
+      _ieee_fma_double_##SUFFIX,                                               \
+  };
+
+/* Plain dispatchers, used by --live-config */
+DEFINE_DISPATCHERS(dispatch, (void)0)
+
+/* Dispatchers installing the floating-point environment of the thread */
+/* the first time it enters the backend, used by --rounding and         */
+/* --ftz-daz                                                             */
+DEFINE_DISPATCHERS(fpenv_dispatch, ieee_fpenv_enter())
+
+/* Wrappers of --overhead-profile, timing the sampled calls of the table   */
+/* installed before them. The timed call is not a tail call, its call site */
+/* is passed to the profiling options in ieee_site_caller                  */
+static const ieee_ops_t *ieee_timed_ops = &ieee_bare_ops;
+
+#define DEFINE_TIMED_OP(NAME, OPCODE, PRECISION, PARAMS, ARGS)                 \
+  static void _ieee_##NAME##_timed PARAMS {                                    \
+    if (!ieee_overhead_sample()) {                                             \
+      ieee_timed_ops->NAME ARGS;                                               \
+      return;                                                                  \
+    }                                                                          \
+    ieee_site_caller = IEEE_CALL_SITE();                                       \
+    const uint64_t start = ieee_overhead_clock();                              \
+    ieee_timed_ops->NAME ARGS;                                                 \
+    const uint64_t stop = ieee_overhead_clock();                               \
+    ieee_site_caller = NULL;                                                   \
+    ieee_overhead_record(ieee_stream_scalar(OPCODE, PRECISION), stop - start); \
+  }
+
+DEFINE_TIMED_OP(add_float, IEEE_TRACE_ADD, IEEE_TRACE_FLOAT,
+                (const float a, const float b, float *c, void *context),
+                (a, b, c, context))
+DEFINE_TIMED_OP(sub_float, IEEE_TRACE_SUB, IEEE_TRACE_FLOAT,
+                (const float a, const float b, float *c, void *context),
+                (a, b, c, context))
+DEFINE_TIMED_OP(mul_float, IEEE_TRACE_MUL, IEEE_TRACE_FLOAT,
+                (const float a, const float b, float *c, void *context),
+                (a, b, c, context))
+DEFINE_TIMED_OP(div_float, IEEE_TRACE_DIV, IEEE_TRACE_FLOAT,
+                (const float a, const float b, float *c, void *context),
+                (a, b, c, context))
+DEFINE_TIMED_OP(cmp_float, IEEE_TRACE_CMP, IEEE_TRACE_FLOAT,
+                (const enum FCMP_PREDICATE p, const float a, const float b,
+                 int *c, void *context),
+                (p, a, b, c, context))
+DEFINE_TIMED_OP(add_double, IEEE_TRACE_ADD, IEEE_TRACE_DOUBLE,
+                (const double a, const double b, double *c, void *context),
+                (a, b, c, context))
+DEFINE_TIMED_OP(sub_double, IEEE_TRACE_SUB, IEEE_TRACE_DOUBLE,
+                (const double a, const double b, double *c, void *context),
+                (a, b, c, context))
+DEFINE_TIMED_OP(mul_double, IEEE_TRACE_MUL, IEEE_TRACE_DOUBLE,
+                (const double a, const double b, double *c, void *context),
+                (a, b, c, context))
+DEFINE_TIMED_OP(div_double, IEEE_TRACE_DIV, IEEE_TRACE_DOUBLE,
+                (const double a, const double b, double *c, void *context),
+                (a, b, c, context))
+DEFINE_TIMED_OP(cmp_double, IEEE_TRACE_CMP, IEEE_TRACE_DOUBLE,
+                (const enum FCMP_PREDICATE p, const double a, const double b,
+                 int *c, void *context),
+                (p, a, b, c, context))
+DEFINE_TIMED_OP(cast_double_to_float, IEEE_TRACE_CAST, IEEE_TRACE_DOUBLE,
+                (double a, float *b, void *context), (a, b, context))
+DEFINE_TIMED_OP(fma_float, IEEE_TRACE_FMA, IEEE_TRACE_FLOAT,
+                (float a, float b, float c, float *res, void *context),
+                (a, b, c, res, context))
+DEFINE_TIMED_OP(fma_double, IEEE_TRACE_FMA, IEEE_TRACE_DOUBLE,
+                (double a, double b, double c, double *res, void *context),
+                (a, b, c, res, context))
+
+static const ieee_ops_t ieee_timed_table = {
+    _ieee_add_float_timed,  _ieee_sub_float_timed,
+    _ieee_mul_float_timed,  _ieee_div_float_timed,
+    _ieee_cmp_float_timed,  _ieee_add_double_timed,
+    _ieee_sub_double_timed, _ieee_mul_double_timed,
+    _ieee_div_double_timed, _ieee_cmp_double_timed,
+    _ieee_cast_double_to_float_timed, _ieee_fma_float_timed,
+    _ieee_fma_double_timed,
+};
+
+/* Sites printed by the --precision-profile, --vector-coverage and */
+/* --subnormal-profile reports                                      */
+#define PRECISION_REPORT_SITES 32
+
+/* Writes the name of the function containing <address> in <name> */
+static void _ieee_site_name(const void *address, char *name) {
+  Dl_info info;
+  if (dladdr(address, &info) == 0) {
+    interflop_sprintf(name, "%p", address);
+  } else if (info.dli_sname != NULL) {
+    interflop_sprintf(name, "%s+0x%lx", info.dli_sname,
+                      (uintptr_t)address - (uintptr_t)info.dli_saddr);
+  } else if (info.dli_fname != NULL) {
+    interflop_sprintf(name, "%s+0x%lx", info.dli_fname,
+                      (uintptr_t)address - (uintptr_t)info.dli_fbase);
+  } else {
+    interflop_sprintf(name, "%p", address);
+  }
+}
+
+static void _ieee_print_fits(const uint64_t *counters) {
+  for (int f = 0; f < IEEE_N_FORMATS; f++) {
+    interflop_fprintf(logger_stderr, " %6.2f%%",
+                      100.0 * counters[IEEE_PRECISION_COUNTER(f)] /
+                          counters[0]);
+  }
+}
+
+/* Prints the share of the operations representable in each format, per */
+/* operation then for the busiest call sites                             */
+static void _ieee_precision_report(const ieee_context_t *ctx) {
+  if (ctx->precision_sites == NULL)
+    return;
+  ieee_site_t **sites =
+      interflop_malloc((IEEE_SITES_MAX + 1) * sizeof(ieee_site_t *));
+  if (sites == NULL)
+    return;
+  const size_t n_sites = ieee_site_sort(ctx->precision_sites, sites);
+
+  uint64_t totals[IEEE_TRACE_N_OPCODES][2][IEEE_SITE_COUNTERS] = {{{0}}};
+  for (size_t i = 0; i < n_sites; i++) {
+    const uint64_t key = sites[i]->key;
+    if (key == 0)
+      continue;
+    for (int c = 0; c < IEEE_SITE_COUNTERS; c++) {
+      totals[ieee_site_opcode(key)][ieee_site_precision(key)][c] +=
+          sites[i]->counters[c];
+    }
+  }
+
+  interflop_fprintf(logger_stderr,
+                    "precision profile (%s=%lu), operations whose operands "
+                    "and result fit:\n",
+                    key_precision_ulps_str, ctx->precision_ulps);
+  interflop_fprintf(logger_stderr, "\t%-4s %-6s %14s %7s %7s %7s\n", "op",
+                    "type", "count", format_str[IEEE_FORMAT_FP32],
+                    format_str[IEEE_FORMAT_FP16], format_str[IEEE_FORMAT_BF16]);
+  for (int op = 0; op < IEEE_TRACE_N_OPCODES; op++) {
+    for (int prec = 0; prec < 2; prec++) {
+      if (totals[op][prec][0] == 0)
+        continue;
+      interflop_fprintf(logger_stderr, "\t%-4s %-6s %14lu",
+                        ieee_trace_opcode_names[op],
+                        prec == IEEE_TRACE_FLOAT ? "float" : "double",
+                        totals[op][prec][0]);
+      _ieee_print_fits(totals[op][prec]);
+      interflop_fprintf(logger_stderr, "\n");
+    }
+  }
+
+  interflop_fprintf(logger_stderr, "call sites (%lu):\n", n_sites);
+  for (size_t i = 0; i < n_sites && i < PRECISION_REPORT_SITES; i++) {
+    const uint64_t key = sites[i]->key;
+    char name[PATH_MAX + 32] = "other sites";
+    if (key != 0)
+      _ieee_site_name(ieee_site_address(key), name);
+    interflop_fprintf(logger_stderr, "\t%-4s %-6s %14lu",
+                      key ? ieee_trace_opcode_names[ieee_site_opcode(key)]
+                          : "-",
+                      key ? (ieee_site_precision(key) == IEEE_TRACE_FLOAT
+                                 ? "float"
+                                 : "double")
+                          : "-",
+                      sites[i]->counters[0]);
+    _ieee_print_fits(sites[i]->counters);
+    interflop_fprintf(logger_stderr, "  %s\n", name);
+  }
+  if (n_sites > PRECISION_REPORT_SITES) {
+    interflop_fprintf(logger_stderr, "\t... %lu more call sites\n",
+                      n_sites - PRECISION_REPORT_SITES);
+  }
+  interflop_free(sites);
+}
+
+/* Lanes of the widest vbackend table the CPU runs, set by init */
+static int ieee_max_lanes = 1;
+
+/* Widths of the vbackend kernels, indexed from IEEE_COVERAGE_VECTOR_1 */
+static const int coverage_lanes[] = {1, 4, 8, 16};
+
+typedef struct {
+  const void *start; /* function address, NULL if unknown */
+  const char *name;  /* symbol of the function, NULL if unknown */
+  uint64_t counters[IEEE_SITE_COUNTERS];
+} ieee_coverage_function_t;
+
+static int _ieee_compare_functions(const void *a, const void *b) {
+  const uint64_t na = ((const ieee_coverage_function_t *)a)->counters[0];
+  const uint64_t nb = ((const ieee_coverage_function_t *)b)->counters[0];
+  return (na < nb) - (na > nb);
+}
+
+/* Prints the share of scalar and vector operations and the lane */
+/* utilization of the <counters> of a site or function            */
+static void _ieee_print_coverage(const uint64_t *counters) {
+  uint64_t calls = counters[IEEE_COVERAGE_SCALAR];
+  for (int w = 0; w < 4; w++)
+    calls += counters[IEEE_COVERAGE_VECTOR_1 + w];
+  interflop_fprintf(logger_stderr, " %14lu %6.2f%%", counters[0],
+                    100.0 * counters[IEEE_COVERAGE_SCALAR] / counters[0]);
+  for (int w = 0; w < 4; w++) {
+    interflop_fprintf(logger_stderr, " %6.2f%%",
+                      100.0 * counters[IEEE_COVERAGE_VECTOR_1 + w] *
+                          coverage_lanes[w] / counters[0]);
+  }
+  interflop_fprintf(logger_stderr, " %6.2f%%",
+                    100.0 * counters[0] / ((double)calls * ieee_max_lanes));
+}
+
+/* Prints the vectorization coverage per function then for the busiest */
+/* call sites                                                           */
+static void _ieee_coverage_report(const ieee_context_t *ctx) {
+  if (ctx->vector_sites == NULL)
+    return;
+  ieee_site_t **sites =
+      interflop_malloc((IEEE_SITES_MAX + 1) * sizeof(ieee_site_t *));
+  ieee_coverage_function_t *functions =
+      interflop_calloc(IEEE_SITES_MAX + 1, sizeof(ieee_coverage_function_t));
+  if (sites == NULL || functions == NULL) {
+    interflop_free(sites);
+    interflop_free(functions);
+    return;
+  }
+  const size_t n_sites = ieee_site_sort(ctx->vector_sites, sites);
+
+  /* Sites of unknown functions and the overflow entry share the NULL one */
+  size_t n_functions = 0;
+  for (size_t i = 0; i < n_sites; i++) {
+    Dl_info info;
+    const void *start = NULL;
+    if (sites[i]->key != 0 &&
+        dladdr(ieee_site_address(sites[i]->key), &info) != 0)
+      start = info.dli_saddr;
+    size_t f = 0;
+    while (f < n_functions && functions[f].start != start)
+      f++;
+    if (f == n_functions) {
+      functions[f].start = start;
+      functions[f].name = (start != NULL) ? info.dli_sname : NULL;
+      n_functions++;
+    }
+    for (int c = 0; c < IEEE_SITE_COUNTERS; c++)
+      functions[f].counters[c] += sites[i]->counters[c];
+  }
+  qsort(functions, n_functions, sizeof(*functions), _ieee_compare_functions);
+
+  interflop_fprintf(logger_stderr,
+                    "vector coverage, share of the operations per entry "
+                    "point, lane utilization for %d lanes:\n",
+                    ieee_max_lanes);
+  interflop_fprintf(logger_stderr,
+                    "\t%-11s %14s %7s %7s %7s %7s %7s %7s\n", "", "ops",
+                    "scalar", "vec1", "vec4", "vec8", "vec16", "lanes");
+  interflop_fprintf(logger_stderr, "functions (%lu):\n", n_functions);
+  for (size_t f = 0; f < n_functions && f < PRECISION_REPORT_SITES; f++) {
+    interflop_fprintf(logger_stderr, "\t%-11s", "");
+    _ieee_print_coverage(functions[f].counters);
+    interflop_fprintf(logger_stderr, "  %s\n",
+                      functions[f].name ? functions[f].name : "other");
+  }
+
+  interflop_fprintf(logger_stderr, "call sites (%lu):\n", n_sites);
+  for (size_t i = 0; i < n_sites && i < PRECISION_REPORT_SITES; i++) {
+    const uint64_t key = sites[i]->key;
+    char name[PATH_MAX + 32] = "other sites";
+    if (key != 0)
+      _ieee_site_name(ieee_site_address(key), name);
+    interflop_fprintf(logger_stderr, "\t%-4s %-6s",
+                      key ? ieee_trace_opcode_names[ieee_site_opcode(key)]
+                          : "-",
+                      key ? (ieee_site_precision(key) == IEEE_TRACE_FLOAT
+                                 ? "float"
+                                 : "double")
+                          : "-");
+    _ieee_print_coverage(sites[i]->counters);
+    interflop_fprintf(logger_stderr, "  %s\n", name);
+  }
+  interflop_free(functions);
+  interflop_free(sites);
+}
+
+/* Prints the cycles a replay with subnormals took more than one with */
+/* normal operands, then the cycles extrapolated to all the calls     */
+static void _ieee_print_subnormal(const uint64_t *counters) {
+  const uint64_t samples = counters[IEEE_SUBNORMAL_SAMPLES];
+  const double penalty =
+      samples ? ((double)counters[IEEE_SUBNORMAL_CYCLES] -
+                 (double)counters[IEEE_SUBNORMAL_REFERENCE_CYCLES]) /
+                    samples
+              : 0;
+  interflop_fprintf(
+      logger_stderr, " %14lu %6.2f%% %6.2f%% %8lu %9.1f %12.4g",
+      counters[IEEE_SUBNORMAL_OPS],
+      100.0 * counters[IEEE_SUBNORMAL_INPUTS] / counters[IEEE_SUBNORMAL_OPS],
+      100.0 * counters[IEEE_SUBNORMAL_OUTPUTS] / counters[IEEE_SUBNORMAL_OPS],
+      samples, penalty, penalty * counters[IEEE_SUBNORMAL_CALLS]);
+}
+
+/* Prints the operations on subnormals and their estimated cost, per */
+/* operation then for the busiest call sites                         */
+static void _ieee_subnormal_report(const ieee_context_t *ctx) {
+  if (ctx->subnormal_sites == NULL)
+    return;
+  ieee_site_t **sites =
+      interflop_malloc((IEEE_SITES_MAX + 1) * sizeof(ieee_site_t *));
+  if (sites == NULL)
+    return;
+  const size_t n_sites = ieee_site_sort(ctx->subnormal_sites, sites);
+
+  uint64_t totals[IEEE_TRACE_N_OPCODES][2][IEEE_SITE_COUNTERS] = {{{0}}};
+  double extra_cycles = 0;
+  for (size_t i = 0; i < n_sites; i++) {
+    const uint64_t *counters = sites[i]->counters;
+    if (counters[IEEE_SUBNORMAL_SAMPLES] != 0) {
+      extra_cycles += ((double)counters[IEEE_SUBNORMAL_CYCLES] -
+                       (double)counters[IEEE_SUBNORMAL_REFERENCE_CYCLES]) /
+                      counters[IEEE_SUBNORMAL_SAMPLES] *
+                      counters[IEEE_SUBNORMAL_CALLS];
+    }
+    const uint64_t key = sites[i]->key;
+    if (key == 0)
+      continue;
+    for (int c = 0; c < IEEE_SITE_COUNTERS; c++) {
+      totals[ieee_site_opcode(key)][ieee_site_precision(key)][c] +=
+          counters[c];
+    }
+  }
+
+  interflop_fprintf(logger_stderr,
+                    "subnormal profile, operations with a subnormal operand "
+                    "or result, extra cycles per call over normal operands "
+                    "(1 call out of %d replayed):\n",
+                    IEEE_SUBNORMAL_PERIOD);
+  interflop_fprintf(logger_stderr, "\t%-11s %14s %7s %7s %8s %9s %12s\n", "",
+                    "ops", "inputs", "outputs", "samples", "cyc/call",
+                    "extra cyc");
+  for (int op = 0; op < IEEE_TRACE_N_OPCODES; op++) {
+    for (int prec = 0; prec < 2; prec++) {
+      if (totals[op][prec][IEEE_SUBNORMAL_CALLS] == 0)
+        continue;
+      interflop_fprintf(logger_stderr, "\t%-4s %-6s",
+                        ieee_trace_opcode_names[op],
+                        prec == IEEE_TRACE_FLOAT ? "float" : "double");
+      _ieee_print_subnormal(totals[op][prec]);
+      interflop_fprintf(logger_stderr, "\n");
+    }
+  }
+  interflop_fprintf(logger_stderr, "estimated extra cycles: %.4g\n",
+                    extra_cycles);
+
+  interflop_fprintf(logger_stderr, "call sites (%lu):\n", n_sites);
+  for (size_t i = 0; i < n_sites && i < PRECISION_REPORT_SITES; i++) {
+    const uint64_t key = sites[i]->key;
+    char name[PATH_MAX + 32] = "other sites";
+    if (key != 0)
+      _ieee_site_name(ieee_site_address(key), name);
+    interflop_fprintf(logger_stderr, "\t%-4s %-6s",
+                      key ? ieee_trace_opcode_names[ieee_site_opcode(key)]
+                          : "-",
+                      key ? (ieee_site_precision(key) == IEEE_TRACE_FLOAT
+                                 ? "float"
+                                 : "double")
+                          : "-");
+    _ieee_print_subnormal(sites[i]->counters);
+    interflop_fprintf(logger_stderr, "  %s\n", name);
+  }
+  if (n_sites > PRECISION_REPORT_SITES) {
+    interflop_fprintf(logger_stderr, "\t... %lu more call sites\n",
+                      n_sites - PRECISION_REPORT_SITES);
+  }
+  interflop_free(sites);
+}
+
+/* Writes the names of the exceptions of <fe> in <list>, of STRING_MAX */
+/* bytes, "none" if empty                                              */
+static const char *_ieee_trap_list(int fe, char *list) {
+  char *out = list;
+  for (int k = 0; k < IEEE_TRAP_KINDS; k++) {
+    if (fe & ieee_trap_excepts[k])
+      out += interflop_sprintf(out, "%s%s", (out == list) ? "" : ",",
+                               ieee_trap_names[k]);
+  }
+  if (out == list)
+    interflop_sprintf(list, "none");
+  return list;
+}
+
+/* Prints the traps caught per exception and the sticky flags <raised> */
+/* of the finalizing thread and of the threads that exited             */
+static void _ieee_trap_report(const ieee_context_t *ctx, int raised) {
+  char list[STRING_MAX];
+  uint64_t counts[IEEE_TRAP_KINDS];
+  ieee_trap_counts(counts);
+  interflop_fprintf(logger_stderr, "trap (%s):\n",
+                    _ieee_trap_list(ctx->trap, list));
+  for (int k = 0; k < IEEE_TRAP_KINDS; k++) {
+    interflop_fprintf(logger_stderr, "\t %s=%lu\n", ieee_trap_names[k],
+                      counts[k]);
+  }
+  interflop_fprintf(logger_stderr, "\t flags raised: %s\n",
+                    _ieee_trap_list(raised, list));
+}
+
+/* Returns the upper bound of the bucket holding the <q> quantile of the */
+/* samples of <entry>                                                    */
+static uint64_t _ieee_overhead_quantile(const ieee_overhead_entry_t *entry,
+                                        double q) {
+  const uint64_t rank = (uint64_t)(q * (entry->samples - 1));
+  uint64_t seen = 0;
+  for (int b = 0; b < IEEE_OVERHEAD_BUCKETS; b++) {
+    seen += entry->histogram[b];
+    if (seen > rank)
+      return (b == 0) ? 0 : 1ULL << b;
+  }
+  return 1ULL << (IEEE_OVERHEAD_BUCKETS - 1);
+}
+
+/* Prints the cycle histogram of each operation and the share of the */
+/* runtime spent in the backend, extrapolated from the samples       */
+static void _ieee_overhead_report(void) {
+  ieee_overhead_clock_t clock;
+  ieee_overhead_stop(&clock);
+
+  interflop_fprintf(logger_stderr,
+                    "overhead profile, 1 call in %d timed, clock reads of "
+                    "%lu cycles subtracted:\n",
+                    IEEE_OVERHEAD_PERIOD, clock.bias);
+  interflop_fprintf(logger_stderr, "\t%-4s %-6s %10s %14s %8s %8s %8s\n",
+                    "op", "type", "samples", "calls", "mean", "p50", "p99");
+  uint64_t total_cycles = 0;
+  for (unsigned i = 0; i < IEEE_STREAMS; i++) {
+    const ieee_overhead_entry_t *entry = &ieee_overhead_entries[i];
+    if (entry->samples == 0)
+      continue;
+    char type[8];
+    const char *op = ieee_trace_opcode_names[ieee_stream_opcode(i)];
+    if (ieee_stream_lanes(i) == 0)
+      interflop_sprintf(type, "%s",
+                        ieee_stream_precision(i) ? "double" : "float");
+    else
+      interflop_sprintf(type, "x%u", ieee_stream_lanes(i));
+    total_cycles += entry->cycles * IEEE_OVERHEAD_PERIOD;
+    interflop_fprintf(logger_stderr, "\t%-4s %-6s %10lu %14lu %8.1f %8lu %8lu",
+                      op, type, entry->samples,
+                      entry->samples * IEEE_OVERHEAD_PERIOD,
+                      (double)entry->cycles / entry->samples,
+                      _ieee_overhead_quantile(entry, 0.5),
+                      _ieee_overhead_quantile(entry, 0.99));
+    /* Histogram, as the samples below each power of two */
+    for (int b = 0; b < IEEE_OVERHEAD_BUCKETS; b++) {
+      if (entry->histogram[b] != 0)
+        interflop_fprintf(logger_stderr, " <%llu:%lu", 1ULL << b,
+                          entry->histogram[b]);
+    }
+    interflop_fprintf(logger_stderr, "\n");
+  }
+
+  if (clock.cycles_per_second > 0) {
+    const double backend_seconds = total_cycles / clock.cycles_per_second;
+    interflop_fprintf(logger_stderr,
+                      "backend: %.3f s (%.3g cycles) of %.3f s of CPU time "
+                      "(%.2f%%), %.3f s of wall time\n",
+                      backend_seconds, (double)total_cycles, clock.cpu_seconds,
+                      (clock.cpu_seconds > 0)
+                          ? 100.0 * backend_seconds / clock.cpu_seconds
+                          : 0.0,
+                      clock.wall_seconds);
+  }
+}
+
+/* Writes the counters of the process in --report-dir */
+static void _ieee_write_report(const ieee_context_t *ctx) {
+  ieee_report_t report;
+  ieee_report_identify(&report);
+  report.counters[IEEE_REPORT_MUL] = ctx->mul_count;
+  report.counters[IEEE_REPORT_DIV] = ctx->div_count;
+  report.counters[IEEE_REPORT_ADD] = ctx->add_count;
+  report.counters[IEEE_REPORT_SUB] = ctx->sub_count;
+  report.counters[IEEE_REPORT_FMA] = ctx->fma_count;
+  report.counters[IEEE_REPORT_FTZ] = ctx->ftz_count;
+  report.counters[IEEE_REPORT_DAZ] = ctx->daz_count;
+  if (ieee_report_write(ctx->report_dir, &report) != 0) {
+    logger_warning("cannot write the report in %s: %s\n", ctx->report_dir,
+                   interflop_strerror(errno));
+  }
+}
+
+/* Reads the operation counts of the --shm-stats segment into <ctx> */
+static void _ieee_shm_stats_counts(ieee_context_t *ctx) {
+  uint64_t totals[IEEE_SHM_STATS_N_COUNTERS];
+  ieee_shm_stats_totals(totals);
+  ctx->mul_count = totals[IEEE_SHM_STATS_MUL];
+  ctx->div_count = totals[IEEE_SHM_STATS_DIV];
+  ctx->add_count = totals[IEEE_SHM_STATS_ADD];
+  ctx->sub_count = totals[IEEE_SHM_STATS_SUB];
+  ctx->fma_count = totals[IEEE_SHM_STATS_FMA];
+}
+
+static void _ieee_print_op_counts(const ieee_context_t *ctx) {
+  /* The --shm-stats counters are exact */
+  if (ctx->count_sample == 0 || ctx->shm_stats) {
+    interflop_fprintf(logger_stderr, "operations count:\n");
+    interflop_fprintf(logger_stderr, "\t mul=%ld\n", ctx->mul_count);
+    interflop_fprintf(logger_stderr, "\t div=%ld\n", ctx->div_count);
+    interflop_fprintf(logger_stderr, "\t add=%ld\n", ctx->add_count);
+    interflop_fprintf(logger_stderr, "\t sub=%ld\n", ctx->sub_count);
+    interflop_fprintf(logger_stderr, "\t fma=%ld\n", ctx->fma_count);
+    return;
+  }
+
+  const char *names[] = {"mul", "div", "add", "sub", "fma"};
+  const IUint64_t counts[] = {ctx->mul_count, ctx->div_count, ctx->add_count,
+                              ctx->sub_count, ctx->fma_count};
+  interflop_fprintf(logger_stderr,
+                    "operations count (estimated, 1 in %lu sampled, 95%% "
+                    "confidence interval):\n",
+                    ctx->count_sample);
+  for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+    interflop_fprintf(
+        logger_stderr, "\t %s=%ld +/- %ld\n", names[i], counts[i],
+        ieee_count_sample_interval(counts[i], ctx->count_sample));
+  }
+}
+
+/* Prints the call site reports of the profiling options */
+static void _ieee_print_site_reports(const ieee_context_t *ctx) {
+  if (ctx->precision_profile)
+    _ieee_precision_report(ctx);
+
+  if (ctx->vector_coverage)
+    _ieee_coverage_report(ctx);
+
+  if (ctx->subnormal_profile)
+    _ieee_subnormal_report(ctx);
+
+  if (ctx->ftz_daz) {
+    interflop_fprintf(logger_stderr, "ftz-daz (scalar operations):\n");
+    interflop_fprintf(logger_stderr, "\t results flushed to zero=%ld\n",
+                      ctx->ftz_count);
+    interflop_fprintf(logger_stderr, "\t operands read as zero=%ld\n",
+                      ctx->daz_count);
+  }
+}
+
+static void _ieee_live_config_stop(void);
+
 void INTERFLOP_IEEE_API(finalize)(void *context) {
   ieee_context_t *my_context = (ieee_context_t *)context;
 
-  if (my_context->count_op) {
-    interflop_fprintf(logger_stderr, "operations count:\n");
-    interflop_fprintf(logger_stderr, "\t mul=%ld\n", my_context->mul_count);
-    interflop_fprintf(logger_stderr, "\t div=%ld\n", my_context->div_count);
-    interflop_fprintf(logger_stderr, "\t add=%ld\n", my_context->add_count);
-    interflop_fprintf(logger_stderr, "\t sub=%ld\n", my_context->sub_count);
-    interflop_fprintf(logger_stderr, "\t fma=%ld\n", my_context->fma_count);
+  /* No reload may change the context while it is reported */
+  _ieee_live_config_stop();
+
+  /* The reports below must not trap */
+  const int raised = my_context->trap ? ieee_trap_stop() : 0;
+
+  /* First, so that the work of finalize is not counted in the runtime */
+  if (my_context->overhead_profile)
+    _ieee_overhead_report();
+
+  if (my_context->shm_stats) {
+    _ieee_shm_stats_counts(my_context);
+    ieee_shm_stats_finish();
+  }
+
+  /* --report-dir replaces the block shared by every process on stderr */
+  if (my_context->report_dir != NULL) {
+    _ieee_write_report(my_context);
+  } else if (my_context->count_op) {
+    _ieee_print_op_counts(my_context);
   };
+
+  if (my_context->fingerprint) {
+    const uint64_t lost = ieee_fingerprint_close();
+    if (lost != 0) {
+      logger_warning("fingerprint %s: %lu checkpoints could not be written\n",
+                     my_context->fingerprint_file, lost);
+    }
+  }
+
+  if (my_context->trace) {
+    ieee_trace_stats_t stats;
+    ieee_trace_close(&stats);
+    logger_info("trace %s: %lu operations, %lu bytes (%.2f bytes/op)\n",
+                my_context->trace_file, stats.n_records, stats.n_bytes,
+                stats.n_records ? (double)stats.n_bytes / stats.n_records
+                                : 0.0);
+  }
+
+  _ieee_print_site_reports(my_context);
+
+  if (my_context->trap)
+    _ieee_trap_report(my_context, raised);
+
+  if (my_context->flight_recorder)
+    ieee_flight_dump("end of the execution");
+
+  if (my_context->debug_dir != NULL)
+    _ieee_debug_close(my_context);
 }
 
 void _ieee_check_stdlib(void) {
   INTERFLOP_CHECK_IMPL(malloc);
   INTERFLOP_CHECK_IMPL(exit);
+  INTERFLOP_CHECK_IMPL(fclose);
   INTERFLOP_CHECK_IMPL(fopen);
   INTERFLOP_CHECK_IMPL(fprintf);
   INTERFLOP_CHECK_IMPL(getenv);
@@ -435,19 +1929,46 @@ void _ieee_alloc_context(void **context) {
 }
 
 static void _ieee_init_context(ieee_context_t *context) {
-  // context->debug = false;
-  // context->debug_binary = false;
-  context->debug = true;
-  context->debug_binary = true;
+  context->debug = false;
+  context->debug_binary = false;
+  context->debug_hex = false;
   context->no_backend_name = false;
   context->print_new_line = false;
   context->print_subnormal_normalized = false;
   context->count_op = false;
+  context->count_sample = 0;
   context->mul_count = 0;
   context->div_count = 0;
   context->add_count = 0;
   context->sub_count = 0;
   context->fma_count = 0;
+  context->ftz_count = 0;
+  context->daz_count = 0;
+  context->live_config_file = NULL;
+  context->shm_stats_name = NULL;
+  context->shm_stats = false;
+  context->rounding = IEEE_ROUND_NEAREST;
+  context->ftz_daz = false;
+  context->debug_dir = NULL;
+  context->trace_file = NULL;
+  context->trace = false;
+  context->trace_format = IEEE_TRACE_FORMAT_XOR;
+  context->precision_profile = false;
+  context->precision_ulps = 0;
+  context->precision_sites = NULL;
+  context->vector_coverage = false;
+  context->vector_sites = NULL;
+  context->subnormal_profile = false;
+  context->subnormal_sites = NULL;
+  context->trap = 0;
+  context->flight_recorder = 0;
+  context->roi = false;
+  context->roi_active = false;
+  context->overhead_profile = false;
+  context->report_dir = NULL;
+  context->fingerprint_file = NULL;
+  context->fingerprint = false;
+  context->fingerprint_interval = IEEE_FINGERPRINT_DEFAULT_INTERVAL;
 }
 
 void INTERFLOP_IEEE_API(pre_init)(interflop_panic_t panic, File *stream,
@@ -479,10 +2000,80 @@ static struct argp_option options[] = {
     {key_print_subnormal_normalized_str, KEY_PRINT_SUBNORMAL_NORMALIZED, 0, 0,
      "normalize subnormal numbers", 0},
     {key_count_op_str, KEY_COUNT_OP, 0, 0, "enable operation count output", 0},
+    {key_count_sample_str, KEY_COUNT_SAMPLE, "N", 0,
+     "count about one operation in N (N < 2^32) and estimate the operation "
+     "count",
+     0},
+    {key_live_config_str, KEY_LIVE_CONFIG, "FILE", 0,
+     "reload the options from FILE when it changes or on SIGUSR1", 0},
+    {key_shm_stats_str, KEY_SHM_STATS, "NAME", 0,
+     "export per-thread operation counters in /dev/shm/NAME", 0},
+    {key_rounding_str, KEY_ROUNDING, "MODE", 0,
+     "rounding mode: nearest (default), up, down or zero", 0},
+    {key_debug_hex_str, KEY_DEBUG_HEX, 0, 0,
+     "enable exact hexadecimal debug output (0x1.8p+1)", 0},
+    {key_debug_dir_str, KEY_DEBUG_DIR, "DIR", 0,
+     "write the debug output of each thread in DIR/<pid>.<tid>.log", 0},
+    {key_trace_str, KEY_TRACE, "FILE", 0,
+     "record every operation in FILE", 0},
+    {key_trace_format_str, KEY_TRACE_FORMAT, "FORMAT", 0,
+     "format of the --trace file: xor (compressed, default) or mmap (raw)", 0},
+    {key_precision_profile_str, KEY_PRECISION_PROFILE, 0, 0,
+     "count per call site the operations representable in fp32, fp16, bf16",
+     0},
+    {key_precision_ulps_str, KEY_PRECISION_ULPS, "N", 0,
+     "--precision-profile tolerance, in ulps of the source format (default 0)",
+     0},
+    {key_vector_coverage_str, KEY_VECTOR_COVERAGE, 0, 0,
+     "count per call site the scalar and vector (1/4/8/16 lanes) operations",
+     0},
+    {key_subnormal_profile_str, KEY_SUBNORMAL_PROFILE, 0, 0,
+     "count per call site the operations on subnormals and estimate their "
+     "cost",
+     0},
+    {key_trap_str, KEY_TRAP, "LIST", 0,
+     "trap the exceptions of LIST: invalid, divzero, overflow, underflow or "
+     "all",
+     0},
+    {key_flight_recorder_str, KEY_FLIGHT_RECORDER, "N", 0,
+     "keep the last N operations of each thread in memory, printed on a "
+     "crash, on the first NaN and at the end",
+     0},
+    {key_roi_str, KEY_ROI, 0, 0,
+     "instrument only the operations between the ROI_BEGIN and ROI_END user "
+     "calls",
+     0},
+    {key_overhead_profile_str, KEY_OVERHEAD_PROFILE, 0, 0,
+     "time a sample of the backend calls and estimate the backend share of "
+     "the runtime",
+     0},
+    {key_report_dir_str, KEY_REPORT_DIR, "DIR", 0,
+     "write the operation counts of the process in "
+     "DIR/<hostname>.<pid>.report",
+     0},
+    {key_fingerprint_str, KEY_FINGERPRINT, "FILE", 0,
+     "write rolling hashes of the results of each thread and operation in "
+     "FILE",
+     0},
+    {key_fingerprint_interval_str, KEY_FINGERPRINT_INTERVAL, "N", 0,
+     "operations between two --fingerprint checkpoints (default 1048576)", 0},
+    {key_ftz_daz_str, KEY_FTZ_DAZ, 0, 0,
+     "flush subnormal results and operands to zero (MXCSR FTZ/DAZ)", 0},
     {0}};
 
-static error_t parse_opt(int key, __attribute__((unused)) char *arg,
-                         struct argp_state *state) {
+/* Reports an invalid option. On the command line it ends the program, */
+/* in a live configuration (parsed with ARGP_NO_EXIT) it only fails the */
+/* reload and the running options are kept                              */
+#define PARSE_ERROR(state, ...)                                                \
+  do {                                                                         \
+    if ((state)->flags & ARGP_NO_EXIT) {                                       \
+      logger_warning(__VA_ARGS__);                                             \
+      return EINVAL;                                                           \
+    }                                                                          \
+    logger_error(__VA_ARGS__);                                                 \
+  } while (0)
+
+static error_t parse_opt(int key, char *arg, struct argp_state *state) {
   ieee_context_t *ctx = (ieee_context_t *)state->input;
   switch (key) {
   case KEY_DEBUG:
@@ -492,10 +2083,13 @@ static error_t parse_opt(int key, __attribute__((unused)) char *arg,
     if (interflop_register_printf_specifier != Null) {
       ctx->debug_binary = true;
     } else {
-      logger_error("--debug-binary option forbiden if "
-                   "register_printf_specifier handler is not set");
+      PARSE_ERROR(state, "--debug-binary option forbiden if "
+                         "register_printf_specifier handler is not set");
     }
     break;
+  case KEY_DEBUG_HEX:
+    ctx->debug_hex = true;
+    break;
   case KEY_NO_BACKEND_NAME:
     ctx->no_backend_name = true;
     break;
@@ -508,6 +2102,137 @@ static error_t parse_opt(int key, __attribute__((unused)) char *arg,
   case KEY_COUNT_OP:
     ctx->count_op = true;
     break;
+  case KEY_LIVE_CONFIG:
+    ctx->live_config_file = arg;
+    break;
+  case KEY_SHM_STATS:
+    ctx->shm_stats_name = arg;
+    break;
+  case KEY_ROUNDING: {
+    const int n_modes =
+        sizeof(rounding_mode_str) / sizeof(rounding_mode_str[0]);
+    int mode = 0;
+    while (mode < n_modes && interflop_strcasecmp(arg, rounding_mode_str[mode]))
+      mode++;
+    if (mode == n_modes) {
+      PARSE_ERROR(state, "--%s invalid value provided, must be one of: "
+                         "nearest, up, down, zero\n",
+                         key_rounding_str);
+      break;
+    }
+    ctx->rounding = (ieee_rounding_mode_t)mode;
+    break;
+  }
+  case KEY_FTZ_DAZ:
+    ctx->ftz_daz = true;
+    break;
+  case KEY_DEBUG_DIR:
+    ctx->debug_dir = arg;
+    break;
+  case KEY_TRACE:
+    ctx->trace_file = arg;
+    break;
+  case KEY_TRACE_FORMAT: {
+    const int n_formats =
+        sizeof(trace_format_str) / sizeof(trace_format_str[0]);
+    int format = 0;
+    while (format < n_formats &&
+           interflop_strcasecmp(arg, trace_format_str[format]))
+      format++;
+    if (format == n_formats) {
+      PARSE_ERROR(state,
+                  "--%s invalid value provided, must be one of: xor, mmap\n",
+                  key_trace_format_str);
+      break;
+    }
+    ctx->trace_format = format;
+    break;
+  }
+  case KEY_PRECISION_PROFILE:
+    ctx->precision_profile = true;
+    break;
+  case KEY_VECTOR_COVERAGE:
+    ctx->vector_coverage = true;
+    break;
+  case KEY_OVERHEAD_PROFILE:
+    ctx->overhead_profile = true;
+    break;
+  case KEY_SUBNORMAL_PROFILE:
+    ctx->subnormal_profile = true;
+    break;
+  case KEY_TRAP: {
+    const int fe_traps = ieee_trap_parse(arg);
+    if (fe_traps < 0) {
+      PARSE_ERROR(state,
+                  "--%s invalid value provided, must be a comma-separated "
+                  "list of: invalid, divzero, overflow, underflow, all\n",
+                  key_trap_str);
+    }
+    ctx->trap = fe_traps;
+    break;
+  }
+  case KEY_FLIGHT_RECORDER: {
+    int error = 0;
+    char *end = NULL;
+    const long n = interflop_strtol(arg, &end, &error);
+    if (error != 0 || end == arg || *end != '\0' || n <= 0) {
+      PARSE_ERROR(state, "--%s invalid value provided, must be a positive "
+                         "integer\n",
+                         key_flight_recorder_str);
+    }
+    ctx->flight_recorder = n;
+    break;
+  }
+  case KEY_ROI:
+    ctx->roi = true;
+    break;
+  case KEY_COUNT_SAMPLE: {
+    int error = 0;
+    char *end = NULL;
+    const long period = interflop_strtol(arg, &end, &error);
+    /* The countdown holds 32 bits, and 1 - 1/N rounds to 1 for larger N */
+    if (error != 0 || end == arg || *end != '\0' || period <= 0 ||
+        (unsigned long)period > UINT32_MAX) {
+      PARSE_ERROR(state, "--%s invalid value provided, must be a positive "
+                         "integer of at most %u\n",
+                         key_count_sample_str, UINT32_MAX);
+    }
+    ctx->count_op = true;
+    ctx->count_sample = period;
+    break;
+  }
+  case KEY_REPORT_DIR:
+    ctx->report_dir = arg;
+    break;
+  case KEY_FINGERPRINT:
+    ctx->fingerprint_file = arg;
+    break;
+  case KEY_FINGERPRINT_INTERVAL: {
+    int error = 0;
+    char *end = NULL;
+    const long interval = interflop_strtol(arg, &end, &error);
+    if (error != 0 || end == arg || *end != '\0' || interval <= 0) {
+      PARSE_ERROR(state,
+                  "--%s invalid value provided, must be a positive "
+                  "integer\n",
+                  key_fingerprint_interval_str);
+    }
+    ctx->fingerprint_interval = interval;
+    break;
+  }
+  case KEY_PRECISION_ULPS: {
+    int error = 0;
+    char *end = NULL;
+    const long ulps = interflop_strtol(arg, &end, &error);
+    if (error != 0 || end == arg || *end != '\0' || ulps < 0) {
+      PARSE_ERROR(state,
+                  "--%s invalid value provided, must be a non-negative "
+                  "integer\n",
+                  key_precision_ulps_str);
+    }
+    ctx->precision_ulps = ulps;
+    break;
+  }
   default:
     return ARGP_ERR_UNKNOWN;
   }
@@ -541,10 +2266,13 @@ static void print_information_header(void *context) {
     return;
 
   ieee_context_t *ctx = (ieee_context_t *)context;
+  char traps[STRING_MAX];
   logger_info("load backend with:\n");
   logger_info("%s = %s\n", key_debug_str, ctx->debug ? "true" : "false");
   logger_info("%s = %s\n", key_debug_binary_str,
               ctx->debug_binary ? "true" : "false");
+  logger_info("%s = %s\n", key_debug_hex_str,
+              ctx->debug_hex ? "true" : "false");
   logger_info("%s = %s\n", key_no_backend_name_str,
               ctx->no_backend_name ? "true" : "false");
   logger_info("%s = %s\n", key_print_new_line_str,
@@ -552,17 +2280,294 @@ static void print_information_header(void *context) {
   logger_info("%s = %s\n", key_print_subnormal_normalized_str,
               ctx->print_subnormal_normalized ? "true" : "false");
   logger_info("%s = %s\n", key_count_op_str, ctx->count_op ? "true" : "false");
+  logger_info("%s = %lu\n", key_count_sample_str, ctx->count_sample);
+  logger_info("%s = %s\n", key_live_config_str,
+              ctx->live_config_file ? ctx->live_config_file : "none");
+  logger_info("%s = %s\n", key_shm_stats_str,
+              ctx->shm_stats_name ? ctx->shm_stats_name : "none");
+  logger_info("%s = %s\n", key_rounding_str, rounding_mode_str[ctx->rounding]);
+  logger_info("%s = %s\n", key_ftz_daz_str, ctx->ftz_daz ? "true" : "false");
+  logger_info("%s = %s\n", key_debug_dir_str,
+              ctx->debug_dir ? ctx->debug_dir : "none");
+  logger_info("%s = %s\n", key_trace_str,
+              ctx->trace_file ? ctx->trace_file : "none");
+  logger_info("%s = %s\n", key_trace_format_str,
+              trace_format_str[ctx->trace_format]);
+  logger_info("%s = %s\n", key_precision_profile_str,
+              ctx->precision_profile ? "true" : "false");
+  logger_info("%s = %lu\n", key_precision_ulps_str, ctx->precision_ulps);
+  logger_info("%s = %s\n", key_vector_coverage_str,
+              ctx->vector_coverage ? "true" : "false");
+  logger_info("%s = %s\n", key_subnormal_profile_str,
+              ctx->subnormal_profile ? "true" : "false");
+  logger_info("%s = %s\n", key_trap_str, _ieee_trap_list(ctx->trap, traps));
+  logger_info("%s = %lu\n", key_flight_recorder_str, ctx->flight_recorder);
+  logger_info("%s = %s\n", key_roi_str, ctx->roi ? "true" : "false");
+  logger_info("%s = %s\n", key_overhead_profile_str,
+              ctx->overhead_profile ? "true" : "false");
+  logger_info("%s = %s\n", key_report_dir_str,
+              ctx->report_dir ? ctx->report_dir : "none");
+  logger_info("%s = %s\n", key_fingerprint_str,
+              ctx->fingerprint_file ? ctx->fingerprint_file : "none");
+  logger_info("%s = %lu\n", key_fingerprint_interval_str,
+              ctx->fingerprint_interval);
 }
 
-void INTERFLOP_IEEE_API(configure)(void *configure, void *context) {
-  ieee_context_t *ctx = (ieee_context_t *)context;
-  ieee_conf_t *conf = (ieee_conf_t *)configure;
+/* Copies the options that can be changed at runtime */
+static void _ieee_apply_conf(ieee_context_t *ctx, const ieee_conf_t *conf) {
   ctx->debug = conf->debug;
   ctx->debug_binary = conf->debug_binary;
+  ctx->debug_hex = conf->debug_hex;
   ctx->no_backend_name = conf->no_backend_name;
   ctx->print_new_line = conf->print_new_line;
   ctx->print_subnormal_normalized = conf->print_subnormal_normalized;
   ctx->count_op = conf->count_op;
+  /* The gaps are drawn with the new period before a sampled table is */
+  /* published                                                         */
+  if (conf->count_sample != 0)
+    ieee_count_sample_start(conf->count_sample);
+  ctx->count_sample = conf->count_sample;
+}
+
+void INTERFLOP_IEEE_API(configure)(void *configure, void *context) {
+  ieee_context_t *ctx = (ieee_context_t *)context;
+  ieee_conf_t *conf = (ieee_conf_t *)configure;
+  _ieee_apply_conf(ctx, conf);
+  ctx->live_config_file = conf->live_config_file;
+  ctx->shm_stats_name = conf->shm_stats_name;
+  ctx->rounding = conf->rounding;
+  ctx->ftz_daz = conf->ftz_daz;
+  ctx->debug_dir = conf->debug_dir;
+  ctx->trace_file = conf->trace_file;
+  ctx->trace_format = conf->trace_format;
+  ctx->precision_profile = conf->precision_profile;
+  ctx->precision_ulps = conf->precision_ulps;
+  ctx->vector_coverage = conf->vector_coverage;
+  ctx->overhead_profile = conf->overhead_profile;
+  ctx->subnormal_profile = conf->subnormal_profile;
+  ctx->trap = conf->trap;
+  ctx->flight_recorder = conf->flight_recorder;
+  ctx->roi = conf->roi;
+  ctx->report_dir = conf->report_dir;
+  ctx->fingerprint_file = conf->fingerprint_file;
+  ctx->fingerprint_interval = conf->fingerprint_interval;
+}
+
+/* Live reconfiguration (--live-config)                                     */
+/* A watcher thread re-reads the file when its mtime changes (checked every */
+/* LIVE_CONFIG_POLL_SEC) or when SIGUSR1 is received, whose previous      */
+/* handler is still run. The file holds the backend options as on the     */
+/* command line, e.g. "--debug --count-op". The new options are written   */
+/* in the context, then the table specialized for them is published in   */
+/* ieee_active_ops. A file with an invalid option is ignored. Finalize    */
+/* stops the watcher and restores SIGUSR1 before printing its reports.    */
+
+#define LIVE_CONFIG_POLL_SEC 1
+#define LIVE_CONFIG_MAX_SIZE 4096
+#define LIVE_CONFIG_MAX_ARGS 64
+
+static sem_t live_config_sem;
+static struct sigaction live_config_previous;
+static pthread_t live_config_watcher;
+static bool live_config_running = false;
+/* set by finalize, the watcher returns on its next wake up */
+static int live_config_stopped = 0;
+
+/* Wakes the watcher, then runs the SIGUSR1 handler of the application */
+static void _ieee_live_config_signal(int sig, siginfo_t *info,
+                                     void *context) {
+  sem_post(&live_config_sem);
+  ieee_signal_forward(&live_config_previous, sig, info, context);
+}
+
+/* Publishes the table of the options, or the bare one outside the region */
+/* of interest of --roi                                                    */
+static void _ieee_publish_ops(const ieee_context_t *ctx) {
+  const ieee_ops_t *ops = _ieee_select_ops(ctx);
+  if (ctx->roi && !__atomic_load_n(&ctx->roi_active, __ATOMIC_RELAXED))
+    ops = &ieee_bare_ops;
+  __atomic_store_n(&ieee_active_ops, ops, __ATOMIC_RELEASE);
+}
+
+/* Reads the options in <file> and applies them to <ctx> */
+static void _ieee_live_config_reload(ieee_context_t *ctx, const char *file) {
+  char buffer[LIVE_CONFIG_MAX_SIZE];
+  char *argv[LIVE_CONFIG_MAX_ARGS + 1];
+  int argc = 0;
+
+  const int fd = open(file, O_RDONLY);
+  if (fd == -1) {
+    logger_warning("cannot open live configuration %s\n", file);
+    return;
+  }
+  const ssize_t size = read(fd, buffer, sizeof(buffer) - 1);
+  close(fd);
+  if (size < 0) {
+    logger_warning("cannot read live configuration %s\n", file);
+    return;
+  }
+  buffer[size] = '\0';
+
+  argv[argc++] = (char *)key_live_config_str;
+  for (char *save = NULL, *tok = strtok_r(buffer, " \t\n", &save);
+       tok != NULL && argc < LIVE_CONFIG_MAX_ARGS;
+       tok = strtok_r(NULL, " \t\n", &save)) {
+    argv[argc++] = tok;
+  }
+  argv[argc] = NULL;
+
+  ieee_conf_t conf;
+  _ieee_init_context(&conf);
+  if (interflop_argp_parse(&argp, argc, argv, ARGP_NO_EXIT | ARGP_NO_HELP, 0,
+                           &conf) != 0) {
+    logger_warning("invalid live configuration %s, options unchanged\n", file);
+    return;
+  }
+
+  _ieee_apply_conf(ctx, &conf);
+  _ieee_publish_ops(ctx);
+  logger_info("live configuration reloaded from %s\n", file);
+}
+
+static void *_ieee_live_config_watcher(void *context) {
+  ieee_context_t *ctx = (ieee_context_t *)context;
+  /* Copy the name, the context one may be changed by a reload */
+  const char *file = ctx->live_config_file;
+  struct timespec last_mtime = {0, 0};
+  struct stat st;
+
+  if (stat(file, &st) == 0) {
+    last_mtime = st.st_mtim;
+  }
+
+  for (;;) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += LIVE_CONFIG_POLL_SEC;
+    const bool signaled = (sem_timedwait(&live_config_sem, &deadline) == 0);
+    if (__atomic_load_n(&live_config_stopped, __ATOMIC_ACQUIRE))
+      break;
+
+    if (stat(file, &st) != 0)
+      continue;
+    const bool modified = st.st_mtim.tv_sec != last_mtime.tv_sec ||
+                          st.st_mtim.tv_nsec != last_mtime.tv_nsec;
+    if (!signaled && !modified)
+      continue;
+    last_mtime = st.st_mtim;
+    _ieee_live_config_reload(ctx, file);
+  }
+  return NULL;
+}
+
+/* Applies the initial content of the live configuration file and starts */
+/* the watcher thread                                                    */
+static void _ieee_live_config_start(ieee_context_t *ctx) {
+  if (interflop_argp_parse == NULL) {
+    logger_error("--%s requires argp_parse\n", key_live_config_str);
+    return;
+  }
+
+  if (access(ctx->live_config_file, R_OK) == 0) {
+    _ieee_live_config_reload(ctx, ctx->live_config_file);
+  }
+
+  sem_init(&live_config_sem, 0, 0);
+  struct sigaction sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_sigaction = _ieee_live_config_signal;
+  sa.sa_flags = SA_SIGINFO | SA_RESTART;
+  sigemptyset(&sa.sa_mask);
+  sigaction(SIGUSR1, &sa, &live_config_previous);
+
+  if (pthread_create(&live_config_watcher, NULL, _ieee_live_config_watcher,
+                     ctx) != 0) {
+    logger_error("cannot start the live configuration watcher\n");
+    return;
+  }
+  live_config_running = true;
+}
+
+/* Stops the watcher, after the reload it may be running, and restores */
+/* the SIGUSR1 disposition of the application                          */
+static void _ieee_live_config_stop(void) {
+  if (!live_config_running)
+    return;
+  sigaction(SIGUSR1, &live_config_previous, NULL);
+  __atomic_store_n(&live_config_stopped, 1, __ATOMIC_RELEASE);
+  sem_post(&live_config_sem);
+  pthread_join(live_config_watcher, NULL);
+  live_config_running = false;
+}
+
+/* User calls                                                                */
+/* The application sends commands with                                    */
+/* interflop_call(INTERFLOP_CUSTOM_ID, "<command>"):                       */
+/*  - ROI_BEGIN, ROI_END: with --roi, the dispatchers follow the table of  */
+/*    the options between the two calls and the bare table elsewhere, so   */
+/*    that counting, tracing and debug output only cost in the region.     */
+/*    Regions are not nested, and apply to all the threads                 */
+/*  - RESET_COUNTERS: zeroes the operation counts, the --shm-stats        */
+/*    counters and the call site tables                                    */
+/*  - DUMP: prints them as at the end of the execution                     */
+/* Other call ids and commands, meant for other backends, are ignored      */
+
+static const char user_call_roi_begin_str[] = "ROI_BEGIN";
+static const char user_call_roi_end_str[] = "ROI_END";
+static const char user_call_reset_counters_str[] = "RESET_COUNTERS";
+static const char user_call_dump_str[] = "DUMP";
+
+static void _ieee_reset_counters(ieee_context_t *ctx) {
+  IUint64_t *counts[] = {&ctx->mul_count, &ctx->div_count, &ctx->add_count,
+                         &ctx->sub_count, &ctx->fma_count, &ctx->ftz_count,
+                         &ctx->daz_count};
+  for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); i++)
+    __atomic_store_n(counts[i], 0, __ATOMIC_RELAXED);
+  if (ctx->shm_stats)
+    ieee_shm_stats_reset();
+
+  struct ieee_site_table *tables[] = {ctx->precision_sites, ctx->vector_sites,
+                                      ctx->subnormal_sites};
+  for (size_t i = 0; i < sizeof(tables) / sizeof(tables[0]); i++) {
+    if (tables[i] != NULL)
+      ieee_site_reset(tables[i]);
+  }
+}
+
+static void _ieee_dump(ieee_context_t *ctx) {
+  interflop_fprintf(logger_stderr, "user call %s:\n", user_call_dump_str);
+  if (ctx->shm_stats)
+    _ieee_shm_stats_counts(ctx);
+  if (ctx->count_op || ctx->report_dir != NULL)
+    _ieee_print_op_counts(ctx);
+  _ieee_print_site_reports(ctx);
+}
+
+void INTERFLOP_IEEE_API(user_call)(void *context, interflop_call_id id,
+                                   va_list ap) {
+  ieee_context_t *ctx = (ieee_context_t *)context;
+  if (id != INTERFLOP_CUSTOM_ID)
+    return;
+
+  /* The comparisons stop at the first byte past the known commands */
+  const char *command = va_arg(ap, const char *);
+  if (command == NULL)
+    return;
+  const bool roi_begin =
+      interflop_strcmp(command, user_call_roi_begin_str) == 0;
+  if (roi_begin || interflop_strcmp(command, user_call_roi_end_str) == 0) {
+    if (!ctx->roi) {
+      logger_warning("user call %s ignored without --%s\n", command,
+                     key_roi_str);
+      return;
+    }
+    __atomic_store_n(&ctx->roi_active, roi_begin, __ATOMIC_RELAXED);
+    _ieee_publish_ops(ctx);
+  } else if (interflop_strcmp(command, user_call_reset_counters_str) == 0) {
+    _ieee_reset_counters(ctx);
+  } else if (interflop_strcmp(command, user_call_dump_str) == 0) {
+    _ieee_dump(ctx);
+  }
 }
 
 struct interflop_backend_interface_t INTERFLOP_IEEE_API(init)(void *context) {
@@ -570,23 +2575,137 @@ struct interflop_backend_interface_t INTERFLOP_IEEE_API(init)(void *context) {
   ieee_context_t *ctx = (ieee_context_t *)context;
   print_information_header(ctx);
 
+  if (ctx->trace_file != NULL) {
+    if (ieee_trace_open(ctx->trace_file, ctx->trace_format) == 0) {
+      ctx->trace = true;
+    } else {
+      logger_error("cannot create trace %s: %s\n", ctx->trace_file,
+                   interflop_strerror(errno));
+    }
+  }
+
+  if (ctx->fingerprint_file != NULL) {
+    if (ieee_fingerprint_open(ctx->fingerprint_file,
+                              ctx->fingerprint_interval) == 0) {
+      ctx->fingerprint = true;
+    } else {
+      logger_error("cannot create fingerprint file %s: %s\n",
+                   ctx->fingerprint_file, interflop_strerror(errno));
+    }
+  }
+
+  /* Every process of the job creates it, the first one wins */
+  if (ctx->report_dir != NULL) {
+    if (mkdir(ctx->report_dir, 0755) != 0 && errno != EEXIST) {
+      logger_error("cannot create report directory %s: %s\n",
+                   ctx->report_dir, interflop_strerror(errno));
+    }
+    ieee_report_start();
+  }
+
+  if (ctx->debug_dir != NULL &&
+      strlen(ctx->debug_dir) > PATH_MAX - DEBUG_FILE_NAME_MAX) {
+    logger_error("--%s: directory name too long\n", key_debug_dir_str);
+  }
+  if (ctx->debug_dir != NULL && mkdir(ctx->debug_dir, 0755) != 0 &&
+      errno != EEXIST) {
+    logger_error("cannot create debug directory %s: %s\n", ctx->debug_dir,
+                 interflop_strerror(errno));
+  }
+
+  /* The vector kernels update the call site tables, they must exist */
+  /* before the vector tables are built                               */
+  if (ctx->precision_profile) {
+    ctx->precision_sites = interflop_calloc(1, sizeof(ieee_site_table_t));
+    if (ctx->precision_sites == NULL) {
+      logger_error("cannot allocate the precision profile\n");
+    }
+  }
+  if (ctx->vector_coverage) {
+    ctx->vector_sites = interflop_calloc(1, sizeof(ieee_site_table_t));
+    if (ctx->vector_sites == NULL) {
+      logger_error("cannot allocate the vector coverage\n");
+    }
+  }
+  if (ctx->subnormal_profile) {
+    ctx->subnormal_sites = interflop_calloc(1, sizeof(ieee_site_table_t));
+    if (ctx->subnormal_sites == NULL) {
+      logger_error("cannot allocate the subnormal profile\n");
+    }
+  }
+
+#if defined(__x86_64__)
+  __builtin_cpu_init();
+  ieee_hw_fma = __builtin_cpu_supports("fma");
+  ieee_max_lanes = __builtin_cpu_supports("avx512f") ? 16
+                   : __builtin_cpu_supports("avx2")  ? 8
+                   : __builtin_cpu_supports("sse2")  ? 4
+                                                     : 1;
+#endif
+
+  if (ctx->shm_stats_name != NULL) {
+    if (ieee_shm_stats_open(ctx->shm_stats_name) == 0) {
+      ctx->shm_stats = true;
+    } else {
+      logger_error("cannot create shared memory segment %s: %s\n",
+                   ctx->shm_stats_name, interflop_strerror(errno));
+    }
+  }
+
+  /* Without live reconfiguration, region of interest nor specific        */
+  /* floating-point environment the specialized table is installed        */
+  /* directly, otherwise dispatchers follow ieee_active_ops                */
+  if (ctx->count_sample) {
+    ieee_count_sample_start(ctx->count_sample);
+  }
+  const ieee_ops_t *ops = _ieee_select_ops(ctx);
+  _ieee_publish_ops(ctx);
+  if (ctx->live_config_file != NULL) {
+    _ieee_live_config_start(ctx);
+    ops = &ieee_dispatch_ops;
+  }
+  if (ctx->roi) {
+    ops = &ieee_dispatch_ops;
+  }
+  /* Before --trap, whose SIGFPE handler forwards the signals which are */
+  /* not floating-point exceptions to the one of the flight recorder    */
+  if (ctx->flight_recorder && ieee_flight_start(ctx->flight_recorder) != 0) {
+    logger_error("cannot install the flight recorder handlers: %s\n",
+                 interflop_strerror(errno));
+  }
+  if (ctx->rounding != IEEE_ROUND_NEAREST || ctx->ftz_daz || ctx->trap) {
+    static const int fe_rounding[] = {FE_TONEAREST, FE_UPWARD, FE_DOWNWARD,
+                                      FE_TOWARDZERO};
+    if (ctx->trap && ieee_trap_start() != 0) {
+      logger_error("cannot install the SIGFPE handler: %s\n",
+                   interflop_strerror(errno));
+    }
+    ieee_fpenv_configure(fe_rounding[ctx->rounding], ctx->ftz_daz, ctx->trap);
+    ops = &ieee_fpenv_dispatch_ops;
+  }
+  if (ctx->overhead_profile) {
+    ieee_timed_ops = ops;
+    ops = &ieee_timed_table;
+    ieee_overhead_start();
+  }
+
   struct interflop_backend_interface_t interflop_backend_ieee = {
-    interflop_add_float : INTERFLOP_IEEE_API(add_float),
-    interflop_sub_float : INTERFLOP_IEEE_API(sub_float),
-    interflop_mul_float : INTERFLOP_IEEE_API(mul_float),
-    interflop_div_float : INTERFLOP_IEEE_API(div_float),
-    interflop_cmp_float : INTERFLOP_IEEE_API(cmp_float),
-    interflop_add_double : INTERFLOP_IEEE_API(add_double),
-    interflop_sub_double : INTERFLOP_IEEE_API(sub_double),
-    interflop_mul_double : INTERFLOP_IEEE_API(mul_double),
-    interflop_div_double : INTERFLOP_IEEE_API(div_double),
-    interflop_cmp_double : INTERFLOP_IEEE_API(cmp_double),
-    interflop_cast_double_to_float : INTERFLOP_IEEE_API(cast_double_to_float),
-    interflop_fma_float : INTERFLOP_IEEE_API(fma_float),
-    interflop_fma_double : INTERFLOP_IEEE_API(fma_double),
+    interflop_add_float : ops->add_float,
+    interflop_sub_float : ops->sub_float,
+    interflop_mul_float : ops->mul_float,
+    interflop_div_float : ops->div_float,
+    interflop_cmp_float : ops->cmp_float,
+    interflop_add_double : ops->add_double,
+    interflop_sub_double : ops->sub_double,
+    interflop_mul_double : ops->mul_double,
+    interflop_div_double : ops->div_double,
+    interflop_cmp_double : ops->cmp_double,
+    interflop_cast_double_to_float : ops->cast_double_to_float,
+    interflop_fma_float : ops->fma_float,
+    interflop_fma_double : ops->fma_double,
     interflop_enter_function : NULL,
     interflop_exit_function : NULL,
-    interflop_user_call : NULL,
+    interflop_user_call : INTERFLOP_IEEE_API(user_call),
     interflop_finalize : INTERFLOP_IEEE_API(finalize),
     vbackend : {
       scalar : interflop_vector_ieee_init_scalar (ctx),
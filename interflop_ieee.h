@@ -17,6 +17,14 @@
 
 #define INTERFLOP_IEEE_API(name) interflop_ieee_##name
 
+/* Rounding modes of the --rounding option */
+typedef enum {
+  IEEE_ROUND_NEAREST = 0,
+  IEEE_ROUND_UP,
+  IEEE_ROUND_DOWN,
+  IEEE_ROUND_ZERO,
+} ieee_rounding_mode_t;
+
 /* Interflop context */
 typedef struct {
   IUint64_t mul_count;
@@ -24,12 +32,60 @@ typedef struct {
   IUint64_t add_count;
   IUint64_t sub_count;
   IUint64_t fma_count;
+  /* results flushed to zero and subnormal operands read as zero */
+  IUint64_t ftz_count;
+  IUint64_t daz_count;
   IBool debug;
   IBool debug_binary;
+  IBool debug_hex;
   IBool no_backend_name;
   IBool print_new_line;
   IBool print_subnormal_normalized;
   IBool count_op;
+  /* mean gap between two counted operations of --count-sample, 0 if exact */
+  IUint64_t count_sample;
+  /* file re-read to reconfigure the backend at runtime, NULL if disabled */
+  const char *live_config_file;
+  /* name of the /dev/shm segment exporting the counters, NULL if disabled */
+  const char *shm_stats_name;
+  IBool shm_stats;
+  ieee_rounding_mode_t rounding;
+  IBool ftz_daz;
+  /* FE_* exceptions trapped by --trap, 0 if none */
+  int trap;
+  /* operations kept per thread by --flight-recorder, 0 if disabled */
+  IUint64_t flight_recorder;
+  /* instrument only between the ROI_BEGIN and ROI_END user calls */
+  IBool roi;
+  /* set between ROI_BEGIN and ROI_END */
+  IBool roi_active;
+  /* directory of the per-thread debug files, NULL for stderr */
+  const char *debug_dir;
+  /* file recording every operation, NULL if disabled */
+  const char *trace_file;
+  IBool trace;
+  /* ieee_trace_format_t of the trace file */
+  int trace_format;
+  /* operations representable in reduced precision, per call site */
+  IBool precision_profile;
+  /* tolerance of --precision-profile, in ulps of the source format */
+  IUint64_t precision_ulps;
+  struct ieee_site_table *precision_sites;
+  /* scalar and vector operations, per call site */
+  IBool vector_coverage;
+  struct ieee_site_table *vector_sites;
+  /* operations on subnormals and their cost, per call site */
+  IBool subnormal_profile;
+  struct ieee_site_table *subnormal_sites;
+  /* time a sample of the calls of the backend */
+  IBool overhead_profile;
+  /* directory of the per-process report files, NULL if disabled */
+  const char *report_dir;
+  /* file of the result fingerprints, NULL if disabled */
+  const char *fingerprint_file;
+  IBool fingerprint;
+  /* operations between two fingerprint checkpoints */
+  IUint64_t fingerprint_interval;
 } ieee_context_t;
 
 typedef ieee_context_t ieee_conf_t;
@@ -60,6 +116,8 @@ void INTERFLOP_IEEE_API(fma_float)(float a, float b, float c, float *res,
                                    void *context);
 void INTERFLOP_IEEE_API(fma_double)(double a, double b, double c, double *res,
                                     void *context);
+void INTERFLOP_IEEE_API(user_call)(void *context, interflop_call_id id,
+                                   va_list ap);
 void INTERFLOP_IEEE_API(finalize)(void *context);
 
 const char *INTERFLOP_IEEE_API(get_backend_name)(void);
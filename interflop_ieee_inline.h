@@ -0,0 +1,150 @@
+/*****************************************************************************\
+ *                                                                           *\
+ *  This file is part of the Verificarlo project,                            *\
+ *  under the Apache License v2.0 with LLVM Exceptions.                      *\
+ *  SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception.                 *\
+ *  See https://llvm.org/LICENSE.txt for license information.                *\
+ *                                                                           *\
+ *  Copyright (c) 2019-2023                                                  *\
+ *     Verificarlo Contributors                                              *\
+ *                                                                           *\
+ ****************************************************************************/
+
+#ifndef __INTERFLOP_IEEE_INLINE_H__
+#define __INTERFLOP_IEEE_INLINE_H__
+
+/* Inline bodies of the uninstrumented IEEE operations                      */
+/*                                                                          */
+/* They give the same results as the operations the shared library installs */
+/* when no option observes them. A wrapper linked statically against        */
+/* libinterflop_ieee.a can call them instead of going through the function  */
+/* pointers of interflop_backend_interface_t, so that the compiler inlines  */
+/* the operation and the IEEE baseline runs at uninstrumented speed.        */
+/* The context is unused, the options of the backend do not apply.         */
+
+#include <math.h>
+#include <stdbool.h>
+
+#include "interflop/interflop.h"
+#include "interflop_ieee.h"
+
+#define INTERFLOP_IEEE_INLINE_API(name) interflop_ieee_inline_##name
+
+/* Comparisons of interflop_ieee.c: the unordered predicates only test that */
+/* an operand is NaN                                                        */
+#define INTERFLOP_IEEE_INLINE_CMP(P, A, B)                                     \
+  do {                                                                         \
+    switch (P) {                                                               \
+    case FCMP_FALSE:                                                           \
+      return false;                                                            \
+    case FCMP_OEQ:                                                             \
+      return (A) == (B);                                                       \
+    case FCMP_OGT:                                                             \
+      return isgreater(A, B);                                                  \
+    case FCMP_OGE:                                                             \
+      return isgreaterequal(A, B);                                             \
+    case FCMP_OLT:                                                             \
+      return isless(A, B);                                                     \
+    case FCMP_OLE:                                                             \
+      return islessequal(A, B);                                                \
+    case FCMP_ONE:                                                             \
+      return islessgreater(A, B);                                              \
+    case FCMP_ORD:                                                             \
+      return !isunordered(A, B);                                               \
+    case FCMP_TRUE:                                                            \
+      return true;                                                             \
+    default:                                                                   \
+      return isunordered(A, B);                                                \
+    }                                                                          \
+  } while (0)
+
+static inline int _ieee_inline_cmp_float(const enum FCMP_PREDICATE p,
+                                         const float a, const float b) {
+  INTERFLOP_IEEE_INLINE_CMP(p, a, b);
+}
+
+static inline int _ieee_inline_cmp_double(const enum FCMP_PREDICATE p,
+                                          const double a, const double b) {
+  INTERFLOP_IEEE_INLINE_CMP(p, a, b);
+}
+
+static inline void INTERFLOP_IEEE_INLINE_API(add_float)(
+    const float a, const float b, float *c,
+    __attribute__((unused)) void *context) {
+  *c = a + b;
+}
+
+static inline void INTERFLOP_IEEE_INLINE_API(sub_float)(
+    const float a, const float b, float *c,
+    __attribute__((unused)) void *context) {
+  *c = a - b;
+}
+
+static inline void INTERFLOP_IEEE_INLINE_API(mul_float)(
+    const float a, const float b, float *c,
+    __attribute__((unused)) void *context) {
+  *c = a * b;
+}
+
+static inline void INTERFLOP_IEEE_INLINE_API(div_float)(
+    const float a, const float b, float *c,
+    __attribute__((unused)) void *context) {
+  *c = a / b;
+}
+
+static inline void INTERFLOP_IEEE_INLINE_API(cmp_float)(
+    const enum FCMP_PREDICATE p, const float a, const float b, int *c,
+    __attribute__((unused)) void *context) {
+  *c = _ieee_inline_cmp_float(p, a, b);
+}
+
+static inline void INTERFLOP_IEEE_INLINE_API(add_double)(
+    const double a, const double b, double *c,
+    __attribute__((unused)) void *context) {
+  *c = a + b;
+}
+
+static inline void INTERFLOP_IEEE_INLINE_API(sub_double)(
+    const double a, const double b, double *c,
+    __attribute__((unused)) void *context) {
+  *c = a - b;
+}
+
+static inline void INTERFLOP_IEEE_INLINE_API(mul_double)(
+    const double a, const double b, double *c,
+    __attribute__((unused)) void *context) {
+  *c = a * b;
+}
+
+static inline void INTERFLOP_IEEE_INLINE_API(div_double)(
+    const double a, const double b, double *c,
+    __attribute__((unused)) void *context) {
+  *c = a / b;
+}
+
+static inline void INTERFLOP_IEEE_INLINE_API(cmp_double)(
+    const enum FCMP_PREDICATE p, const double a, const double b, int *c,
+    __attribute__((unused)) void *context) {
+  *c = _ieee_inline_cmp_double(p, a, b);
+}
+
+static inline void INTERFLOP_IEEE_INLINE_API(cast_double_to_float)(
+    double a, float *b, __attribute__((unused)) void *context) {
+  *b = (float)a;
+}
+
+/* A single instruction with -mfma, a libm call otherwise, both correctly */
+/* rounded like the shared library                                        */
+static inline void INTERFLOP_IEEE_INLINE_API(fma_float)(
+    float a, float b, float c, float *res,
+    __attribute__((unused)) void *context) {
+  *res = __builtin_fmaf(a, b, c);
+}
+
+static inline void INTERFLOP_IEEE_INLINE_API(fma_double)(
+    double a, double b, double c, double *res,
+    __attribute__((unused)) void *context) {
+  *res = __builtin_fma(a, b, c);
+}
+
+#endif /* __INTERFLOP_IEEE_INLINE_H__ */
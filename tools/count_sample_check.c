@@ -0,0 +1,96 @@
+/*****************************************************************************\
+ *                                                                           *\
+ *  This file is part of the Verificarlo project,                            *\
+ *  under the Apache License v2.0 with LLVM Exceptions.                      *\
+ *  SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception.                 *\
+ *  See https://llvm.org/LICENSE.txt for license information.                *\
+ *                                                                           *\
+ *  Copyright (c) 2019-2023                                                  *\
+ *     Verificarlo Contributors                                              *\
+ *                                                                           *\
+ ****************************************************************************/
+
+/* Statistical checker of the sampled operation count (--count-sample).     */
+/*                                                                           */
+/* For each period N, many trials count the same number of operations with  */
+/* ieee_count_sample, as the sampled operations do, each counted one adding */
+/* N to the estimate. The mean of the estimates must be within 5 standard   */
+/* errors of the exact count (unbiased), and the 95% confidence interval    */
+/* the backend prints, ieee_count_sample_interval, must hold the exact      */
+/* count in 93% to 97% of the trials. The gaps are geometric, so that the   */
+/* trials of a thread are independent even if the countdown carries over.   */
+/*                                                                           */
+/* usage: interflop_ieee_count_sample_check [trials [operations]]           */
+/* Exit status is non-zero if a period fails.                               */
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "common/count_sample.h"
+
+#define DEFAULT_TRIALS 2000
+#define DEFAULT_OPERATIONS 20000
+#define MEAN_SIGMAS 5.0
+#define COVERAGE_MIN 0.93
+#define COVERAGE_MAX 0.97
+
+static const uint64_t periods[] = {2, 10, 100, 1000};
+
+/* Checks <trials> estimates of <operations> counted with <period>, */
+/* returns true if they pass                                        */
+static bool check_period(uint64_t period, uint64_t trials,
+                         uint64_t operations) {
+  ieee_count_sample_start(period);
+  double sum = 0;
+  uint64_t covered = 0;
+  for (uint64_t t = 0; t < trials; t++) {
+    uint64_t estimate = 0;
+    for (uint64_t i = 0; i < operations; i++) {
+      if (ieee_count_sample())
+        estimate += period;
+    }
+    sum += estimate;
+    const uint64_t interval = ieee_count_sample_interval(estimate, period);
+    const uint64_t error = (estimate > operations) ? estimate - operations
+                                                   : operations - estimate;
+    if (error <= interval)
+      covered++;
+  }
+
+  const double mean = sum / trials;
+  /* each estimate has the variance operations (period - 1) */
+  const double standard_error =
+      sqrt(operations * (period - 1.0) / (double)trials);
+  const double sigmas = fabs(mean - operations) / standard_error;
+  const double coverage = (double)covered / trials;
+  const bool ok = sigmas <= MEAN_SIGMAS && coverage >= COVERAGE_MIN &&
+                  coverage <= COVERAGE_MAX;
+  printf("period %-6" PRIu64 " mean %14.1f (%5.2f standard errors) "
+         "95%% interval coverage %6.2f%% %s\n",
+         period, mean, sigmas, 100 * coverage, ok ? "ok" : "FAILED");
+  return ok;
+}
+
+int main(int argc, char *argv[]) {
+  uint64_t trials = DEFAULT_TRIALS;
+  uint64_t operations = DEFAULT_OPERATIONS;
+  if (argc > 1)
+    trials = strtoull(argv[1], NULL, 0);
+  if (argc > 2)
+    operations = strtoull(argv[2], NULL, 0);
+  if (trials == 0 || operations == 0) {
+    fprintf(stderr, "usage: %s [trials [operations]]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  printf("%" PRIu64 " trials of %" PRIu64 " operations per period\n", trials,
+         operations);
+  bool ok = true;
+  for (unsigned int p = 0; p < sizeof(periods) / sizeof(periods[0]); p++)
+    ok = check_period(periods[p], trials, operations) && ok;
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
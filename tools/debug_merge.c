@@ -0,0 +1,260 @@
+/*****************************************************************************\
+ *                                                                           *\
+ *  This file is part of the Verificarlo project,                            *\
+ *  under the Apache License v2.0 with LLVM Exceptions.                      *\
+ *  SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception.                 *\
+ *  See https://llvm.org/LICENSE.txt for license information.                *\
+ *                                                                           *\
+ *  Copyright (c) 2019-2023                                                  *\
+ *     Verificarlo Contributors                                              *\
+ *                                                                           *\
+ ****************************************************************************/
+
+/* Merges the per-thread debug files written with --debug-dir=<dir> into a  */
+/* single log ordered by the global sequence number of the records.        */
+/* The files are named <pid>.<tid>.log. The sequence numbers are only      */
+/* ordered within a process, so the files of each process are merged       */
+/* separately, one process after another, each under a "process <pid>:"    */
+/* line when the directory holds several runs.                              */
+/*                                                                           */
+/* A record starts with a line "[<seq>] ..." and goes on until the next     */
+/* such line, as --print-new-line spreads a record over several lines. The  */
+/* records of one file are in increasing sequence order, so a k-way merge   */
+/* with a binary heap of the head record of each file gives the global      */
+/* order. The thread id, taken from the file name, is inserted after the    */
+/* sequence number.                                                          */
+/*                                                                           */
+/* usage: interflop_ieee_debug_merge <dir> [output]                         */
+
+#include <dirent.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+  FILE *file;
+  long pid;
+  long tid;
+  /* head record: sequence number and text without the "[<seq>] " prefix */
+  uint64_t seq;
+  char *text;
+  size_t text_len;
+  size_t text_cap;
+  /* first line of the next record, already read */
+  char *line;
+  size_t line_cap;
+  bool has_line;
+} stream_t;
+
+/* Parses "[<seq>] " at the start of <line>, returns the prefix length */
+static size_t parse_seq(const char *line, uint64_t *seq) {
+  if (line[0] != '[')
+    return 0;
+  char *end;
+  errno = 0;
+  const unsigned long long value = strtoull(line + 1, &end, 10);
+  if (end == line + 1 || errno != 0 || end[0] != ']' || end[1] != ' ')
+    return 0;
+  *seq = value;
+  return (size_t)(end + 2 - line);
+}
+
+static void append(stream_t *s, const char *str, size_t len) {
+  if (s->text_len + len + 1 > s->text_cap) {
+    s->text_cap = 2 * (s->text_len + len + 1);
+    s->text = realloc(s->text, s->text_cap);
+    if (s->text == NULL) {
+      fprintf(stderr, "out of memory\n");
+      exit(EXIT_FAILURE);
+    }
+  }
+  memcpy(s->text + s->text_len, str, len);
+  s->text_len += len;
+  s->text[s->text_len] = '\0';
+}
+
+static bool read_line(stream_t *s) {
+  s->has_line = getline(&s->line, &s->line_cap, s->file) != -1;
+  return s->has_line;
+}
+
+/* Loads the next record of <s> as its head, returns false at the end */
+static bool next_record(stream_t *s) {
+  uint64_t seq;
+  size_t prefix;
+  /* Skip anything before the first record */
+  while (s->has_line && (prefix = parse_seq(s->line, &seq)) == 0)
+    read_line(s);
+  if (!s->has_line)
+    return false;
+
+  s->seq = seq;
+  s->text_len = 0;
+  append(s, s->line + prefix, strlen(s->line + prefix));
+  while (read_line(s) && parse_seq(s->line, &seq) == 0)
+    append(s, s->line, strlen(s->line));
+  return true;
+}
+
+/* Binary min-heap of streams ordered by the sequence of their head */
+
+static void heap_swap(stream_t **heap, size_t i, size_t j) {
+  stream_t *tmp = heap[i];
+  heap[i] = heap[j];
+  heap[j] = tmp;
+}
+
+static void heap_down(stream_t **heap, size_t n, size_t i) {
+  for (;;) {
+    size_t min = i;
+    const size_t left = 2 * i + 1, right = 2 * i + 2;
+    if (left < n && heap[left]->seq < heap[min]->seq)
+      min = left;
+    if (right < n && heap[right]->seq < heap[min]->seq)
+      min = right;
+    if (min == i)
+      return;
+    heap_swap(heap, i, min);
+    i = min;
+  }
+}
+
+/* Parses "<pid>.<tid>.log", returns false for any other name */
+static bool parse_name(const char *name, long *pid, long *tid) {
+  char *end;
+  *pid = strtol(name, &end, 10);
+  if (end == name || *end != '.')
+    return false;
+  const char *start = end + 1;
+  *tid = strtol(start, &end, 10);
+  return end != start && strcmp(end, ".log") == 0;
+}
+
+static int compare_pid(const void *a, const void *b) {
+  const long pa = ((const stream_t *)a)->pid, pb = ((const stream_t *)b)->pid;
+  return (pa > pb) - (pa < pb);
+}
+
+/* Opens the <pid>.<tid>.log files of <dir> sorted by pid, returns their */
+/* number                                                                 */
+static size_t open_streams(const char *dir, stream_t **streams) {
+  DIR *d = opendir(dir);
+  if (d == NULL) {
+    fprintf(stderr, "cannot open %s: %s\n", dir, strerror(errno));
+    exit(EXIT_FAILURE);
+  }
+  size_t n = 0, cap = 0;
+  *streams = NULL;
+  for (struct dirent *e = readdir(d); e != NULL; e = readdir(d)) {
+    long pid, tid;
+    if (!parse_name(e->d_name, &pid, &tid))
+      continue;
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/%s", dir, e->d_name);
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+      fprintf(stderr, "cannot open %s: %s\n", path, strerror(errno));
+      exit(EXIT_FAILURE);
+    }
+    if (n == cap) {
+      cap = cap ? 2 * cap : 64;
+      *streams = realloc(*streams, cap * sizeof(stream_t));
+      if (*streams == NULL) {
+        fprintf(stderr, "out of memory\n");
+        exit(EXIT_FAILURE);
+      }
+    }
+    memset(&(*streams)[n], 0, sizeof(stream_t));
+    (*streams)[n].file = f;
+    (*streams)[n].pid = pid;
+    (*streams)[n].tid = tid;
+    n++;
+  }
+  closedir(d);
+  if (n > 0)
+    qsort(*streams, n, sizeof(stream_t), compare_pid);
+  return n;
+}
+
+/* Merges the <n_streams> streams of one process into <out> */
+static void merge(FILE *out, stream_t *streams, size_t n_streams,
+                  stream_t **heap, uint64_t *n_records, uint64_t *n_gaps) {
+  size_t n = 0;
+  for (size_t i = 0; i < n_streams; i++) {
+    read_line(&streams[i]);
+    if (next_record(&streams[i]))
+      heap[n++] = &streams[i];
+  }
+  for (size_t i = n / 2; i-- > 0;)
+    heap_down(heap, n, i);
+
+  bool first = true;
+  uint64_t expected = 0;
+  while (n > 0) {
+    stream_t *s = heap[0];
+    /* Gaps come from records lost in a thread that did not flush */
+    if (!first && s->seq != expected)
+      (*n_gaps)++;
+    fprintf(out, "[%" PRIu64 "] %ld: %s", s->seq, s->tid, s->text);
+    expected = s->seq + 1;
+    first = false;
+    (*n_records)++;
+    if (!next_record(s))
+      heap[0] = heap[--n];
+    heap_down(heap, n, 0);
+  }
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 2 || argc > 3) {
+    fprintf(stderr, "usage: %s <dir> [output]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  FILE *out = stdout;
+  if (argc == 3 && (out = fopen(argv[2], "w")) == NULL) {
+    fprintf(stderr, "cannot open %s: %s\n", argv[2], strerror(errno));
+    return EXIT_FAILURE;
+  }
+
+  stream_t *streams;
+  const size_t n_streams = open_streams(argv[1], &streams);
+  stream_t **heap = malloc((n_streams ? n_streams : 1) * sizeof(stream_t *));
+  if (heap == NULL) {
+    fprintf(stderr, "out of memory\n");
+    return EXIT_FAILURE;
+  }
+  const bool several = n_streams > 0 &&
+                       streams[0].pid != streams[n_streams - 1].pid;
+  uint64_t n_records = 0, n_gaps = 0;
+  size_t n_processes = 0;
+  for (size_t first = 0, last; first < n_streams; first = last) {
+    for (last = first + 1;
+         last < n_streams && streams[last].pid == streams[first].pid; last++)
+      ;
+    if (several)
+      fprintf(out, "process %ld:\n", streams[first].pid);
+    merge(out, &streams[first], last - first, heap, &n_records, &n_gaps);
+    n_processes++;
+  }
+
+  for (size_t i = 0; i < n_streams; i++) {
+    fclose(streams[i].file);
+    free(streams[i].text);
+    free(streams[i].line);
+  }
+  free(streams);
+  free(heap);
+  if (out != stdout)
+    fclose(out);
+  fprintf(stderr,
+          "merged %" PRIu64 " records from %zu threads of %zu processes",
+          n_records, n_streams, n_processes);
+  if (n_gaps > 0)
+    fprintf(stderr, ", %" PRIu64 " gaps in the sequence", n_gaps);
+  fprintf(stderr, "\n");
+  return EXIT_SUCCESS;
+}
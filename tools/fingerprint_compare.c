@@ -0,0 +1,197 @@
+/*****************************************************************************\
+ *                                                                           *\
+ *  This file is part of the Verificarlo project,                            *\
+ *  under the Apache License v2.0 with LLVM Exceptions.                      *\
+ *  SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception.                 *\
+ *  See https://llvm.org/LICENSE.txt for license information.                *\
+ *                                                                           *\
+ *  Copyright (c) 2019-2023                                                  *\
+ *     Verificarlo Contributors                                              *\
+ *                                                                           *\
+ ****************************************************************************/
+
+/* Compares the fingerprints written by two runs with --fingerprint=<file>  */
+/* and prints, for each stream of each thread which diverged, the first    */
+/* window of operations whose digest differs. The hashes are rolling, so   */
+/* every later window of the stream differs too: the divergence lies in    */
+/* the operations of the first one, which --debug or --trace can then      */
+/* examine alone. Streams are sorted by the start of their first differing */
+/* window. The exit status is 0 if the runs match, 1 if they diverged.     */
+/*                                                                           */
+/* usage: interflop_ieee_fingerprint_compare <file_a> <file_b>               */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common/fingerprint.h"
+
+typedef struct {
+  ieee_fingerprint_header_t header;
+  ieee_fingerprint_record_t *records;
+  size_t n;
+} fingerprint_t;
+
+typedef struct {
+  uint32_t thread;
+  uint16_t stream;
+  uint64_t checkpoint;
+  uint64_t start; /* operations of the stream before the window */
+  uint64_t end;   /* operations at the end of the window, in run a */
+  bool missing;   /* the window exists in one run only */
+} divergence_t;
+
+static int compare_records(const void *a, const void *b) {
+  const ieee_fingerprint_record_t *x = a, *y = b;
+  if (x->thread != y->thread)
+    return (x->thread > y->thread) - (x->thread < y->thread);
+  if (x->stream != y->stream)
+    return (x->stream > y->stream) - (x->stream < y->stream);
+  return (x->checkpoint > y->checkpoint) - (x->checkpoint < y->checkpoint);
+}
+
+static int compare_divergences(const void *a, const void *b) {
+  const divergence_t *x = a, *y = b;
+  if (x->start != y->start)
+    return (x->start > y->start) - (x->start < y->start);
+  if (x->thread != y->thread)
+    return (x->thread > y->thread) - (x->thread < y->thread);
+  return (x->stream > y->stream) - (x->stream < y->stream);
+}
+
+/* Loads the records of <path> sorted by thread, stream and checkpoint */
+static void load(const char *path, fingerprint_t *f) {
+  FILE *file = fopen(path, "rb");
+  if (file == NULL) {
+    fprintf(stderr, "cannot open %s: %s\n", path, strerror(errno));
+    exit(2);
+  }
+  if (fread(&f->header, sizeof(f->header), 1, file) != 1 ||
+      f->header.magic != IEEE_FINGERPRINT_MAGIC ||
+      f->header.version != IEEE_FINGERPRINT_VERSION ||
+      f->header.record_size < sizeof(ieee_fingerprint_record_t)) {
+    fprintf(stderr, "%s is not a fingerprint file\n", path);
+    exit(2);
+  }
+  fseek(file, 0, SEEK_END);
+  const long size = ftell(file) - f->header.header_size;
+  fseek(file, f->header.header_size, SEEK_SET);
+  f->n = (size > 0) ? size / f->header.record_size : 0;
+  f->records = malloc((f->n + 1) * sizeof(ieee_fingerprint_record_t));
+  char *record = malloc(f->header.record_size);
+  if (f->records == NULL || record == NULL) {
+    fprintf(stderr, "out of memory\n");
+    exit(2);
+  }
+  for (size_t i = 0; i < f->n; i++) {
+    if (fread(record, f->header.record_size, 1, file) != 1) {
+      f->n = i;
+      break;
+    }
+    memcpy(&f->records[i], record, sizeof(ieee_fingerprint_record_t));
+  }
+  free(record);
+  fclose(file);
+  qsort(f->records, f->n, sizeof(*f->records), compare_records);
+}
+
+static bool same_stream(const ieee_fingerprint_record_t *a,
+                        const ieee_fingerprint_record_t *b) {
+  return a->thread == b->thread && a->stream == b->stream;
+}
+
+static void print_stream(unsigned stream) {
+  const unsigned lanes = ieee_stream_lanes(stream);
+  if (lanes == 0)
+    printf("%-4s %-6s", ieee_trace_opcode_names[ieee_stream_opcode(stream)],
+           ieee_stream_precision(stream) ? "double" : "float");
+  else
+    printf("%-4s x%-5u", ieee_trace_opcode_names[ieee_stream_opcode(stream)],
+           lanes);
+}
+
+int main(int argc, char *argv[]) {
+  if (argc != 3) {
+    fprintf(stderr, "usage: %s <file_a> <file_b>\n", argv[0]);
+    return 2;
+  }
+  fingerprint_t a, b;
+  load(argv[1], &a);
+  load(argv[2], &b);
+  if (a.header.interval != b.header.interval) {
+    fprintf(stderr,
+            "the runs used different intervals (%" PRIu64 " and %" PRIu64
+            "), their windows cannot be compared\n",
+            a.header.interval, b.header.interval);
+    return 2;
+  }
+
+  divergence_t *divergences =
+      malloc((a.n + b.n + 1) * sizeof(divergence_t));
+  size_t n_divergences = 0, n_streams = 0;
+  size_t i = 0, j = 0;
+  /* Both arrays are sorted, streams are walked in step */
+  while (i < a.n || j < b.n) {
+    const ieee_fingerprint_record_t *first =
+        (j >= b.n || (i < a.n && compare_records(&a.records[i],
+                                                 &b.records[j]) <= 0))
+            ? &a.records[i]
+            : &b.records[j];
+    const uint32_t thread = first->thread;
+    const uint16_t stream = first->stream;
+    const ieee_fingerprint_record_t key = {.thread = thread, .stream = stream};
+    bool diverged = false;
+    uint64_t start = 0;
+    n_streams++;
+    for (;;) {
+      const bool in_a = i < a.n && same_stream(&a.records[i], &key);
+      const bool in_b = j < b.n && same_stream(&b.records[j], &key);
+      if (!in_a && !in_b)
+        break;
+      const ieee_fingerprint_record_t *ra = in_a ? &a.records[i] : NULL;
+      const ieee_fingerprint_record_t *rb = in_b ? &b.records[j] : NULL;
+      if (!diverged &&
+          (ra == NULL || rb == NULL || ra->checkpoint != rb->checkpoint ||
+           ra->ops != rb->ops || ra->digest != rb->digest)) {
+        diverged = true;
+        divergences[n_divergences++] = (divergence_t){
+            .thread = thread,
+            .stream = stream,
+            .checkpoint = ra ? ra->checkpoint : rb->checkpoint,
+            .start = start,
+            .end = ra ? ra->ops : rb->ops,
+            .missing = ra == NULL || rb == NULL,
+        };
+      }
+      if (ra != NULL)
+        start = ra->ops;
+      i += in_a;
+      j += in_b;
+    }
+  }
+
+  printf("%zu streams, %zu and %zu checkpoints, %" PRIu64
+         " operations per window\n",
+         n_streams, a.n, b.n, a.header.interval);
+  if (n_divergences == 0) {
+    printf("the runs match\n");
+    return 0;
+  }
+  qsort(divergences, n_divergences, sizeof(*divergences), compare_divergences);
+  printf("%zu streams diverged, first differing windows:\n", n_divergences);
+  for (size_t d = 0; d < n_divergences; d++) {
+    printf("\tthread %" PRIu32 " ", divergences[d].thread);
+    print_stream(divergences[d].stream);
+    printf(" window %" PRIu64 ": operations %" PRIu64 " to %" PRIu64 "%s\n",
+           divergences[d].checkpoint, divergences[d].start, divergences[d].end,
+           divergences[d].missing ? " (in one run only)" : "");
+  }
+  free(divergences);
+  free(a.records);
+  free(b.records);
+  return 1;
+}
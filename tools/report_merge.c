@@ -0,0 +1,281 @@
+/*****************************************************************************\
+ *                                                                           *\
+ *  This file is part of the Verificarlo project,                            *\
+ *  under the Apache License v2.0 with LLVM Exceptions.                      *\
+ *  SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception.                 *\
+ *  See https://llvm.org/LICENSE.txt for license information.                *\
+ *                                                                           *\
+ *  Copyright (c) 2019-2023                                                  *\
+ *     Verificarlo Contributors                                              *\
+ *                                                                           *\
+ ****************************************************************************/
+
+/* Aggregates the per-process reports written with --report-dir=<dir>.     */
+/*                                                                           */
+/* The reports are read by a pool of threads, then the tool prints the      */
+/* totals of the job, the distribution of each counter over the processes  */
+/* (min, median, mean, max, standard deviation and imbalance, i.e. max over */
+/* mean) and the outliers. A process is an outlier when its operations or   */
+/* its time are more than 3.5 median absolute deviations away from the      */
+/* median (modified z-score).                                                */
+/*                                                                           */
+/* usage: interflop_ieee_report_merge [-j threads] [-n outliers] <dir>       */
+
+#include <dirent.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "common/report.h"
+
+#define DEFAULT_OUTLIERS 10
+#define OUTLIER_SCORE 3.5
+
+/* Metrics compared between processes: the counters, the operations and */
+/* the time                                                             */
+#define METRIC_OPS IEEE_REPORT_N_COUNTERS
+#define METRIC_SECONDS (IEEE_REPORT_N_COUNTERS + 1)
+#define N_METRICS (IEEE_REPORT_N_COUNTERS + 2)
+
+typedef struct {
+  char **paths;
+  ieee_report_t *reports;
+  bool *valid;
+  size_t n;
+  size_t next; /* next report to read, taken with an atomic add */
+} job_t;
+
+static void usage(const char *argv0) {
+  fprintf(stderr, "usage: %s [-j threads] [-n outliers] <dir>\n", argv0);
+  exit(EXIT_FAILURE);
+}
+
+static void *xmalloc(size_t size) {
+  void *p = malloc(size);
+  if (p == NULL) {
+    fprintf(stderr, "out of memory\n");
+    exit(EXIT_FAILURE);
+  }
+  return p;
+}
+
+static void *read_reports(void *arg) {
+  job_t *job = arg;
+  for (;;) {
+    const size_t i = __atomic_fetch_add(&job->next, 1, __ATOMIC_RELAXED);
+    if (i >= job->n)
+      break;
+    job->valid[i] = ieee_report_read(job->paths[i], &job->reports[i]) == 0;
+  }
+  return NULL;
+}
+
+/* Lists the reports of <dir> in <paths>, returns their number */
+static size_t list_reports(const char *dir, char ***paths) {
+  DIR *d = opendir(dir);
+  if (d == NULL) {
+    fprintf(stderr, "cannot open %s: %s\n", dir, strerror(errno));
+    exit(EXIT_FAILURE);
+  }
+  size_t n = 0, cap = 1024;
+  *paths = xmalloc(cap * sizeof(char *));
+  const size_t suffix_len = strlen(IEEE_REPORT_SUFFIX);
+  struct dirent *entry;
+  while ((entry = readdir(d)) != NULL) {
+    const size_t len = strlen(entry->d_name);
+    if (len <= suffix_len ||
+        strcmp(entry->d_name + len - suffix_len, IEEE_REPORT_SUFFIX) != 0)
+      continue;
+    if (n == cap) {
+      cap *= 2;
+      *paths = realloc(*paths, cap * sizeof(char *));
+      if (*paths == NULL) {
+        fprintf(stderr, "out of memory\n");
+        exit(EXIT_FAILURE);
+      }
+    }
+    (*paths)[n] = xmalloc(strlen(dir) + len + 2);
+    sprintf((*paths)[n], "%s/%s", dir, entry->d_name);
+    n++;
+  }
+  closedir(d);
+  return n;
+}
+
+static double metric(const ieee_report_t *report, int m) {
+  if (m == METRIC_SECONDS)
+    return report->seconds;
+  if (m == METRIC_OPS) {
+    return (double)report->counters[IEEE_REPORT_MUL] +
+           report->counters[IEEE_REPORT_DIV] +
+           report->counters[IEEE_REPORT_ADD] +
+           report->counters[IEEE_REPORT_SUB] +
+           report->counters[IEEE_REPORT_FMA];
+  }
+  return (double)report->counters[m];
+}
+
+static const char *metric_name(int m) {
+  if (m == METRIC_SECONDS)
+    return "seconds";
+  if (m == METRIC_OPS)
+    return "ops";
+  return ieee_report_counter_names[m];
+}
+
+static int compare_doubles(const void *a, const void *b) {
+  const double x = *(const double *)a, y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+/* Returns the median of the <n> values of <v>, which are sorted */
+static double median(double *v, size_t n) {
+  qsort(v, n, sizeof(*v), compare_doubles);
+  return (n % 2) ? v[n / 2] : (v[n / 2 - 1] + v[n / 2]) / 2;
+}
+
+static void print_process(const ieee_report_t *report) {
+  if (report->rank >= 0)
+    printf("rank %" PRId64 " (%s:%" PRId32 ")", report->rank, report->host,
+           report->pid);
+  else
+    printf("%s:%" PRId32, report->host, report->pid);
+}
+
+typedef struct {
+  const ieee_report_t *report;
+  int metric;
+  double value;
+  double score;
+} outlier_t;
+
+static int compare_outliers(const void *a, const void *b) {
+  const double x = fabs(((const outlier_t *)a)->score);
+  const double y = fabs(((const outlier_t *)b)->score);
+  return (x < y) - (x > y);
+}
+
+int main(int argc, char *argv[]) {
+  long n_threads = sysconf(_SC_NPROCESSORS_ONLN);
+  long max_outliers = DEFAULT_OUTLIERS;
+  int opt;
+  while ((opt = getopt(argc, argv, "j:n:")) != -1) {
+    switch (opt) {
+    case 'j':
+      n_threads = strtol(optarg, NULL, 10);
+      break;
+    case 'n':
+      max_outliers = strtol(optarg, NULL, 10);
+      break;
+    default:
+      usage(argv[0]);
+    }
+  }
+  if (optind + 1 != argc)
+    usage(argv[0]);
+  if (n_threads < 1)
+    n_threads = 1;
+
+  job_t job = {0};
+  job.n = list_reports(argv[optind], &job.paths);
+  if (job.n == 0) {
+    fprintf(stderr, "no report in %s\n", argv[optind]);
+    return EXIT_FAILURE;
+  }
+  job.reports = xmalloc(job.n * sizeof(ieee_report_t));
+  job.valid = calloc(job.n, sizeof(bool));
+  if ((size_t)n_threads > job.n)
+    n_threads = job.n;
+  pthread_t *threads = xmalloc(n_threads * sizeof(pthread_t));
+  for (long t = 0; t < n_threads; t++)
+    pthread_create(&threads[t], NULL, read_reports, &job);
+  for (long t = 0; t < n_threads; t++)
+    pthread_join(threads[t], NULL);
+
+  /* Keeps the valid reports at the front */
+  size_t n = 0;
+  for (size_t i = 0; i < job.n; i++) {
+    if (job.valid[i])
+      job.reports[n++] = job.reports[i];
+    else
+      fprintf(stderr, "ignoring %s: not a report\n", job.paths[i]);
+  }
+  if (n == 0)
+    return EXIT_FAILURE;
+
+  uint64_t totals[IEEE_REPORT_N_COUNTERS] = {0};
+  for (size_t i = 0; i < n; i++)
+    for (int c = 0; c < IEEE_REPORT_N_COUNTERS; c++)
+      totals[c] += job.reports[i].counters[c];
+  printf("%zu processes\n", n);
+  printf("operations count:\n");
+  for (int c = 0; c < IEEE_REPORT_N_COUNTERS; c++)
+    printf("\t %s=%" PRIu64 "\n", ieee_report_counter_names[c], totals[c]);
+
+  printf("per process:\n");
+  printf("\t%-8s %14s %14s %14s %14s %14s %9s\n", "", "min", "median", "mean",
+         "max", "stddev", "imbalance");
+  double *values = xmalloc(n * sizeof(double));
+  outlier_t *outliers = xmalloc(2 * n * sizeof(outlier_t));
+  size_t n_outliers = 0;
+  for (int m = 0; m < N_METRICS; m++) {
+    double sum = 0, sum2 = 0;
+    for (size_t i = 0; i < n; i++) {
+      values[i] = metric(&job.reports[i], m);
+      sum += values[i];
+      sum2 += values[i] * values[i];
+    }
+    if (sum == 0 && m < METRIC_OPS)
+      continue;
+    const double mean = sum / n;
+    const double stddev = sqrt(fmax(sum2 / n - mean * mean, 0));
+    const double med = median(values, n);
+    const double min = values[0], max = values[n - 1];
+    printf("\t%-8s %14.6g %14.6g %14.6g %14.6g %14.6g %9.3f\n", metric_name(m),
+           min, med, mean, max, stddev, (mean > 0) ? max / mean : 1.0);
+
+    if (m != METRIC_OPS && m != METRIC_SECONDS)
+      continue;
+    for (size_t i = 0; i < n; i++)
+      values[i] = fabs(values[i] - med);
+    const double mad = median(values, n);
+    if (mad == 0)
+      continue;
+    for (size_t i = 0; i < n; i++) {
+      const double value = metric(&job.reports[i], m);
+      const double score = 0.6745 * (value - med) / mad;
+      if (fabs(score) > OUTLIER_SCORE) {
+        outliers[n_outliers++] =
+            (outlier_t){&job.reports[i], m, value, score};
+      }
+    }
+  }
+
+  qsort(outliers, n_outliers, sizeof(*outliers), compare_outliers);
+  printf("outliers (%zu, modified z-score above %.1f):\n", n_outliers,
+         OUTLIER_SCORE);
+  for (size_t i = 0; i < n_outliers && i < (size_t)max_outliers; i++) {
+    printf("\t%-8s %14.6g %+8.1f  ", metric_name(outliers[i].metric),
+           outliers[i].value, outliers[i].score);
+    print_process(outliers[i].report);
+    printf("\n");
+  }
+
+  for (size_t i = 0; i < job.n; i++)
+    free(job.paths[i]);
+  free(job.paths);
+  free(job.reports);
+  free(job.valid);
+  free(threads);
+  free(values);
+  free(outliers);
+  return EXIT_SUCCESS;
+}
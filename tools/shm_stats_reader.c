@@ -0,0 +1,203 @@
+/*****************************************************************************\
+ *                                                                           *\
+ *  This file is part of the Verificarlo project,                            *\
+ *  under the Apache License v2.0 with LLVM Exceptions.                      *\
+ *  SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception.                 *\
+ *  See https://llvm.org/LICENSE.txt for license information.                *\
+ *                                                                           *\
+ *  Copyright (c) 2019-2023                                                  *\
+ *     Verificarlo Contributors                                              *\
+ *                                                                           *\
+ ****************************************************************************/
+
+/* Samples the counters exported with --shm-stats=<name> and prints the      */
+/* operation rates of the whole process, and of each thread with -t.         */
+/* It stops when the backend is finalized or the process exits.              */
+/*                                                                           */
+/* usage: interflop_ieee_shm_stats [-t] <name> [interval_seconds]            */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "common/shm_stats.h"
+
+#define DEFAULT_INTERVAL 1.0
+
+static const char *counter_names[IEEE_SHM_STATS_N_COUNTERS] = {
+    "mul", "div", "add", "sub", "fma"};
+
+static void usage(const char *argv0) {
+  fprintf(stderr, "usage: %s [-t] <name> [interval_seconds]\n", argv0);
+  exit(EXIT_FAILURE);
+}
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static const ieee_shm_stats_header_t *map_segment(const char *name) {
+  char path[256];
+  snprintf(path, sizeof(path), "/%s", (name[0] == '/') ? name + 1 : name);
+
+  const int fd = shm_open(path, O_RDONLY, 0);
+  if (fd == -1) {
+    fprintf(stderr, "cannot open %s: %s\n", path, strerror(errno));
+    exit(EXIT_FAILURE);
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 ||
+      (size_t)st.st_size < sizeof(ieee_shm_stats_header_t)) {
+    fprintf(stderr, "%s: not an IEEE backend statistics segment\n", path);
+    exit(EXIT_FAILURE);
+  }
+  void *p = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (p == MAP_FAILED) {
+    fprintf(stderr, "cannot map %s: %s\n", path, strerror(errno));
+    exit(EXIT_FAILURE);
+  }
+
+  const ieee_shm_stats_header_t *header = p;
+  if (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) !=
+      IEEE_SHM_STATS_MAGIC) {
+    fprintf(stderr, "%s: bad magic, segment not initialized\n", path);
+    exit(EXIT_FAILURE);
+  }
+  if (header->version != IEEE_SHM_STATS_VERSION) {
+    fprintf(stderr, "%s: unsupported layout version %u (expected %u)\n", path,
+            header->version, IEEE_SHM_STATS_VERSION);
+    exit(EXIT_FAILURE);
+  }
+  if ((size_t)st.st_size < header->header_size + (size_t)header->max_threads *
+                                                      header->slot_size) {
+    fprintf(stderr, "%s: truncated segment\n", path);
+    exit(EXIT_FAILURE);
+  }
+  return header;
+}
+
+static const ieee_shm_stats_slot_t *
+get_slot(const ieee_shm_stats_header_t *header, uint32_t i) {
+  return (const ieee_shm_stats_slot_t *)((const char *)header +
+                                         header->header_size +
+                                         (size_t)i * header->slot_size);
+}
+
+/* Copies the counters of the <n> first slots into <sample> */
+static uint32_t take_sample(const ieee_shm_stats_header_t *header,
+                            uint64_t *sample) {
+  uint32_t n = __atomic_load_n(&header->n_threads, __ATOMIC_RELAXED);
+  if (n > header->max_threads)
+    n = header->max_threads;
+  for (uint32_t i = 0; i < n; i++) {
+    const ieee_shm_stats_slot_t *slot = get_slot(header, i);
+    for (int c = 0; c < IEEE_SHM_STATS_N_COUNTERS; c++) {
+      sample[i * IEEE_SHM_STATS_N_COUNTERS + c] =
+          __atomic_load_n(&slot->counters[c], __ATOMIC_RELAXED);
+    }
+  }
+  return n;
+}
+
+static void print_rates(const char *label, const uint64_t *cur,
+                        const uint64_t *prev, double dt) {
+  uint64_t total = 0, total_prev = 0;
+  printf("%-12s", label);
+  for (int c = 0; c < IEEE_SHM_STATS_N_COUNTERS; c++) {
+    printf(" %s=%10.4g/s", counter_names[c], (double)(cur[c] - prev[c]) / dt);
+    total += cur[c];
+    total_prev += prev[c];
+  }
+  printf(" all=%10.4g/s total=%" PRIu64 "\n",
+         (double)(total - total_prev) / dt, total);
+}
+
+int main(int argc, char *argv[]) {
+  bool per_thread = false;
+  int arg = 1;
+  if (arg < argc && strcmp(argv[arg], "-t") == 0) {
+    per_thread = true;
+    arg++;
+  }
+  if (arg >= argc)
+    usage(argv[0]);
+  const char *name = argv[arg++];
+  double interval = DEFAULT_INTERVAL;
+  if (arg < argc) {
+    interval = strtod(argv[arg], NULL);
+    if (interval <= 0)
+      usage(argv[0]);
+  }
+
+  const ieee_shm_stats_header_t *header = map_segment(name);
+  const size_t n_values =
+      (size_t)header->max_threads * IEEE_SHM_STATS_N_COUNTERS;
+  uint64_t *prev = calloc(n_values, sizeof(uint64_t));
+  uint64_t *cur = calloc(n_values, sizeof(uint64_t));
+  if (prev == NULL || cur == NULL) {
+    fprintf(stderr, "out of memory\n");
+    return EXIT_FAILURE;
+  }
+
+  printf("pid %d, layout version %u\n", header->pid, header->version);
+  take_sample(header, prev);
+  double prev_time = now();
+  const struct timespec pause = {(time_t)interval,
+                                 (long)((interval - (time_t)interval) * 1e9)};
+
+  for (;;) {
+    nanosleep(&pause, NULL);
+    const bool finished =
+        __atomic_load_n(&header->finished, __ATOMIC_ACQUIRE) != 0;
+    const bool alive = kill(header->pid, 0) == 0 || errno == EPERM;
+    const uint32_t n = take_sample(header, cur);
+    const double cur_time = now();
+    const double dt = cur_time - prev_time;
+
+    uint64_t sum_cur[IEEE_SHM_STATS_N_COUNTERS] = {0};
+    uint64_t sum_prev[IEEE_SHM_STATS_N_COUNTERS] = {0};
+    for (uint32_t i = 0; i < n; i++) {
+      for (int c = 0; c < IEEE_SHM_STATS_N_COUNTERS; c++) {
+        sum_cur[c] += cur[i * IEEE_SHM_STATS_N_COUNTERS + c];
+        sum_prev[c] += prev[i * IEEE_SHM_STATS_N_COUNTERS + c];
+      }
+    }
+    char label[32];
+    snprintf(label, sizeof(label), "%u threads", n);
+    print_rates(label, sum_cur, sum_prev, dt);
+    if (per_thread) {
+      for (uint32_t i = 0; i < n; i++) {
+        snprintf(label, sizeof(label), "  tid %d", get_slot(header, i)->tid);
+        print_rates(label, cur + i * IEEE_SHM_STATS_N_COUNTERS,
+                    prev + i * IEEE_SHM_STATS_N_COUNTERS, dt);
+      }
+    }
+    fflush(stdout);
+
+    if (finished || !alive) {
+      printf("%s\n", finished ? "backend finalized" : "process exited");
+      break;
+    }
+    uint64_t *tmp = prev;
+    prev = cur;
+    cur = tmp;
+    prev_time = cur_time;
+  }
+
+  free(prev);
+  free(cur);
+  return EXIT_SUCCESS;
+}
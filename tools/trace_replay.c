@@ -0,0 +1,547 @@
+/*****************************************************************************\
+ *                                                                           *\
+ *  This file is part of the Verificarlo project,                            *\
+ *  under the Apache License v2.0 with LLVM Exceptions.                      *\
+ *  SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception.                 *\
+ *  See https://llvm.org/LICENSE.txt for license information.                *\
+ *                                                                           *\
+ *  Copyright (c) 2019-2023                                                  *\
+ *     Verificarlo Contributors                                              *\
+ *                                                                           *\
+ ****************************************************************************/
+
+/* Replays a per-operation trace (common/trace.h) through the interface of  */
+/* an interflop backend, by default the IEEE one, and reports the replay    */
+/* rate. The result of each operation is compared bit for bit with the      */
+/* recorded one.                                                             */
+/*                                                                           */
+/* The trace is mapped by windows of WINDOW_RECORDS records. A reader thread */
+/* maps and faults in the next window while the current one is replayed,    */
+/* so the replay loop never waits on the disk once the first window is in.  */
+/* XOR-compressed traces (--trace) are mapped whole and the reader thread   */
+/* decodes the next block while the current one is replayed.                */
+/*                                                                           */
+/* usage: interflop_ieee_trace_replay [-b backend.so] <trace>               */
+/*                                    [-- backend options]                   */
+
+#include <dlfcn.h>
+#include <err.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "common/trace.h"
+#include "common/trace_codec.h"
+#include "interflop/interflop.h"
+#include "interflop/interflop_stdlib.h"
+
+#if defined(__GLIBC__)
+#include <argp.h>
+#include <printf.h>
+#endif
+
+#define DEFAULT_BACKEND "libinterflop_ieee.so"
+/* 1 Mi records, 40 MiB per window */
+#define WINDOW_RECORDS (1 << 20)
+/* Mismatches printed before only counting them */
+#define MAX_REPORTED_MISMATCHES 10
+
+typedef void (*pre_init_t)(interflop_panic_t, File *, void **);
+typedef void (*cli_t)(int, char **, void *);
+typedef struct interflop_backend_interface_t (*init_t)(void *);
+
+/* Handlers of the interflop standard library, as installed by the */
+/* verificarlo wrapper                                             */
+
+static void replay_panic(const char *msg) {
+  fprintf(stderr, "%s", msg);
+  exit(EXIT_FAILURE);
+}
+
+static File *replay_fopen(const char *path, const char *mode, int *error) {
+  FILE *f = fopen(path, mode);
+  if (f == NULL && error != NULL)
+    *error = errno;
+  return (File *)f;
+}
+
+static int replay_fprintf(File *stream, const char *fmt, ...) {
+  va_list ap;
+  va_start(ap, fmt);
+  const int n = vfprintf((FILE *)stream, fmt, ap);
+  va_end(ap);
+  return n;
+}
+
+static int replay_vfprintf(File *stream, const char *fmt, va_list ap) {
+  return vfprintf((FILE *)stream, fmt, ap);
+}
+
+static int replay_gettid(void) { return (int)syscall(SYS_gettid); }
+
+static void install_stdlib_handlers(void) {
+  interflop_set_handler("malloc", malloc);
+  interflop_set_handler("exit", exit);
+  interflop_set_handler("fopen", replay_fopen);
+  interflop_set_handler("fprintf", replay_fprintf);
+  interflop_set_handler("vfprintf", replay_vfprintf);
+  interflop_set_handler("getenv", getenv);
+  interflop_set_handler("gettid", replay_gettid);
+  interflop_set_handler("sprintf", sprintf);
+  interflop_set_handler("strcasecmp", strcasecmp);
+  interflop_set_handler("strerror", strerror);
+  interflop_set_handler("vwarnx", vwarnx);
+#if defined(__GLIBC__)
+  interflop_set_handler("argp_parse", argp_parse);
+  interflop_set_handler("register_printf_specifier", register_printf_specifier);
+#endif
+}
+
+/* Double-buffered windows of the trace */
+
+typedef struct {
+  void *map; /* NULL for a decoded block */
+  size_t map_size;
+  ieee_trace_record_t *records;
+  uint64_t n;
+} window_t;
+
+typedef struct {
+  int fd;
+  uint64_t n_records; /* 0 if unknown, for an unfinished compressed trace */
+  /* unfinished memory-mapped trace, whose unwritten records are skipped */
+  bool unfinished;
+  /* whole compressed trace and offset of the next block */
+  const uint8_t *data;
+  size_t size;
+  size_t pos;
+  uint64_t next; /* first record of the next window to map */
+  window_t slots[2];
+  int head;  /* slot consumed next */
+  int count; /* slots ready */
+  bool done; /* all windows were mapped or an error occurred */
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+} reader_t;
+
+static window_t map_window(int fd, uint64_t first, uint64_t n) {
+  const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+  const off_t start =
+      sizeof(ieee_trace_header_t) + first * sizeof(ieee_trace_record_t);
+  const off_t aligned = start & ~(off_t)(page - 1);
+  window_t w;
+  w.map_size = (start - aligned) + n * sizeof(ieee_trace_record_t);
+  /* MAP_POPULATE faults the pages in from the reader thread */
+  w.map = mmap(NULL, w.map_size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd,
+               aligned);
+  if (w.map == MAP_FAILED) {
+    w.map = NULL;
+    w.records = NULL;
+    w.n = 0;
+    return w;
+  }
+  madvise(w.map, w.map_size, MADV_SEQUENTIAL);
+  w.records = (ieee_trace_record_t *)((char *)w.map + (start - aligned));
+  w.n = n;
+  return w;
+}
+
+/* Decodes the next block of a compressed trace, returns false at the end */
+static bool decode_block(reader_t *r, window_t *w) {
+  ieee_trace_block_header_t block;
+  if (r->pos + sizeof(block) > r->size)
+    return false;
+  memcpy(&block, r->data + r->pos, sizeof(block));
+  if (block.n_bytes > r->size - r->pos - sizeof(block)) {
+    fprintf(stderr, "truncated block at offset %zu\n", r->pos);
+    return false;
+  }
+  w->map = NULL;
+  w->map_size = 0;
+  w->n = block.n_records;
+  w->records = malloc((block.n_records ? block.n_records : 1) *
+                      sizeof(ieee_trace_record_t));
+  if (w->records == NULL) {
+    fprintf(stderr, "out of memory\n");
+    return false;
+  }
+  if (ieee_trace_decode(r->data + r->pos + sizeof(block), block.n_bytes,
+                        w->records, block.n_records) != 0) {
+    fprintf(stderr, "corrupted block at offset %zu\n", r->pos);
+    free(w->records);
+    return false;
+  }
+  r->pos += sizeof(block) + block.n_bytes;
+  return true;
+}
+
+static void release_window(window_t *w) {
+  if (w->map != NULL)
+    munmap(w->map, w->map_size);
+  else
+    free(w->records);
+}
+
+static void *reader_thread(void *arg) {
+  reader_t *r = (reader_t *)arg;
+  while (r->data != NULL || r->next < r->n_records) {
+    window_t w;
+    if (r->data != NULL) {
+      if (!decode_block(r, &w))
+        break;
+    } else {
+      const uint64_t n = (r->n_records - r->next < WINDOW_RECORDS)
+                             ? r->n_records - r->next
+                             : WINDOW_RECORDS;
+      w = map_window(r->fd, r->next, n);
+      if (w.map == NULL) {
+        fprintf(stderr, "cannot map the trace: %s\n", strerror(errno));
+        break;
+      }
+    }
+    pthread_mutex_lock(&r->lock);
+    while (r->count == 2)
+      pthread_cond_wait(&r->cond, &r->lock);
+    r->slots[(r->head + r->count) % 2] = w;
+    r->count++;
+    r->next += w.n;
+    pthread_cond_broadcast(&r->cond);
+    pthread_mutex_unlock(&r->lock);
+  }
+  pthread_mutex_lock(&r->lock);
+  r->done = true;
+  pthread_cond_broadcast(&r->cond);
+  pthread_mutex_unlock(&r->lock);
+  return NULL;
+}
+
+/* Returns the next window, or false at the end of the trace */
+static bool reader_next(reader_t *r, window_t *w) {
+  pthread_mutex_lock(&r->lock);
+  while (r->count == 0 && !r->done)
+    pthread_cond_wait(&r->cond, &r->lock);
+  const bool ready = r->count > 0;
+  if (ready) {
+    *w = r->slots[r->head];
+    r->head = (r->head + 1) % 2;
+    r->count--;
+    pthread_cond_broadcast(&r->cond);
+  }
+  pthread_mutex_unlock(&r->lock);
+  return ready;
+}
+
+/* Replay */
+
+static inline float as_float(uint64_t bits) {
+  const uint32_t low = (uint32_t)bits;
+  float f;
+  memcpy(&f, &low, sizeof(f));
+  return f;
+}
+
+static inline double as_double(uint64_t bits) {
+  double d;
+  memcpy(&d, &bits, sizeof(d));
+  return d;
+}
+
+static inline uint64_t float_bits(float f) {
+  uint32_t bits;
+  memcpy(&bits, &f, sizeof(bits));
+  return bits;
+}
+
+static inline uint64_t double_bits(double d) {
+  uint64_t bits;
+  memcpy(&bits, &d, sizeof(bits));
+  return bits;
+}
+
+/* Runs the operation of <rec> through <backend>, returns the result bits */
+static inline uint64_t replay_record(
+    const struct interflop_backend_interface_t *backend, void *context,
+    const ieee_trace_record_t *rec) {
+  const uint64_t *op = rec->operands;
+  if (rec->precision == IEEE_TRACE_FLOAT) {
+    float res = 0;
+    int cmp = 0;
+    switch (rec->opcode) {
+    case IEEE_TRACE_ADD:
+      backend->interflop_add_float(as_float(op[0]), as_float(op[1]), &res,
+                                   context);
+      break;
+    case IEEE_TRACE_SUB:
+      backend->interflop_sub_float(as_float(op[0]), as_float(op[1]), &res,
+                                   context);
+      break;
+    case IEEE_TRACE_MUL:
+      backend->interflop_mul_float(as_float(op[0]), as_float(op[1]), &res,
+                                   context);
+      break;
+    case IEEE_TRACE_DIV:
+      backend->interflop_div_float(as_float(op[0]), as_float(op[1]), &res,
+                                   context);
+      break;
+    case IEEE_TRACE_CMP:
+      backend->interflop_cmp_float((enum FCMP_PREDICATE)rec->predicate,
+                                   as_float(op[0]), as_float(op[1]), &cmp,
+                                   context);
+      return (uint64_t)(uint32_t)cmp;
+    case IEEE_TRACE_FMA:
+      backend->interflop_fma_float(as_float(op[0]), as_float(op[1]),
+                                   as_float(op[2]), &res, context);
+      break;
+    }
+    return float_bits(res);
+  }
+
+  double res = 0;
+  float res_float = 0;
+  int cmp = 0;
+  switch (rec->opcode) {
+  case IEEE_TRACE_ADD:
+    backend->interflop_add_double(as_double(op[0]), as_double(op[1]), &res,
+                                  context);
+    break;
+  case IEEE_TRACE_SUB:
+    backend->interflop_sub_double(as_double(op[0]), as_double(op[1]), &res,
+                                  context);
+    break;
+  case IEEE_TRACE_MUL:
+    backend->interflop_mul_double(as_double(op[0]), as_double(op[1]), &res,
+                                  context);
+    break;
+  case IEEE_TRACE_DIV:
+    backend->interflop_div_double(as_double(op[0]), as_double(op[1]), &res,
+                                  context);
+    break;
+  case IEEE_TRACE_CMP:
+    backend->interflop_cmp_double((enum FCMP_PREDICATE)rec->predicate,
+                                  as_double(op[0]), as_double(op[1]), &cmp,
+                                  context);
+    return (uint64_t)(uint32_t)cmp;
+  case IEEE_TRACE_CAST:
+    backend->interflop_cast_double_to_float(as_double(op[0]), &res_float,
+                                            context);
+    return float_bits(res_float);
+  case IEEE_TRACE_FMA:
+    backend->interflop_fma_double(as_double(op[0]), as_double(op[1]),
+                                  as_double(op[2]), &res, context);
+    break;
+  }
+  return double_bits(res);
+}
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void usage(const char *argv0) {
+  fprintf(stderr, "usage: %s [-b backend.so] <trace> [-- backend options]\n",
+          argv0);
+  exit(EXIT_FAILURE);
+}
+
+/* Opens <path> for <r> and checks its header */
+static void open_trace(const char *path, reader_t *r) {
+  int *fd = &r->fd;
+  *fd = open(path, O_RDONLY);
+  if (*fd == -1) {
+    fprintf(stderr, "cannot open %s: %s\n", path, strerror(errno));
+    exit(EXIT_FAILURE);
+  }
+  ieee_trace_header_t header;
+  struct stat st;
+  if (fstat(*fd, &st) != 0 ||
+      pread(*fd, &header, sizeof(header), 0) != sizeof(header)) {
+    fprintf(stderr, "%s: not an IEEE backend trace\n", path);
+    exit(EXIT_FAILURE);
+  }
+  if (header.magic != IEEE_TRACE_MAGIC &&
+      header.magic != IEEE_TRACE_XOR_MAGIC) {
+    fprintf(stderr, "%s: bad magic\n", path);
+    exit(EXIT_FAILURE);
+  }
+  if (header.version != IEEE_TRACE_VERSION ||
+      header.header_size != sizeof(ieee_trace_header_t) ||
+      header.record_size != sizeof(ieee_trace_record_t)) {
+    fprintf(stderr, "%s: unsupported layout version %u (expected %u)\n", path,
+            header.version, IEEE_TRACE_VERSION);
+    exit(EXIT_FAILURE);
+  }
+
+  if (header.magic == IEEE_TRACE_XOR_MAGIC) {
+    r->size = st.st_size;
+    void *p = mmap(NULL, r->size, PROT_READ, MAP_PRIVATE, *fd, 0);
+    if (p == MAP_FAILED) {
+      fprintf(stderr, "cannot map %s: %s\n", path, strerror(errno));
+      exit(EXIT_FAILURE);
+    }
+    madvise(p, r->size, MADV_SEQUENTIAL);
+    r->data = (const uint8_t *)p;
+    r->pos = sizeof(header);
+    r->n_records = header.n_records;
+    return;
+  }
+
+  const uint64_t in_file =
+      ((uint64_t)st.st_size - sizeof(header)) / sizeof(ieee_trace_record_t);
+  if (header.n_records > in_file) {
+    fprintf(stderr, "%s: truncated trace\n", path);
+    exit(EXIT_FAILURE);
+  }
+  r->unfinished = header.n_records == 0;
+  r->n_records = r->unfinished ? in_file : header.n_records;
+}
+
+int main(int argc, char *argv[]) {
+  const char *backend_path = DEFAULT_BACKEND;
+  int arg = 1;
+  if (arg + 1 < argc && strcmp(argv[arg], "-b") == 0) {
+    backend_path = argv[arg + 1];
+    arg += 2;
+  }
+  if (arg >= argc)
+    usage(argv[0]);
+  const char *trace_path = argv[arg++];
+  /* Backend options follow "--", argv[arg - 1] becomes their argv[0] */
+  int backend_argc = 1;
+  char **backend_argv = &argv[arg - 1];
+  if (arg < argc) {
+    if (strcmp(argv[arg], "--") != 0)
+      usage(argv[0]);
+    backend_argv = &argv[arg];
+    backend_argc = argc - arg;
+  }
+  backend_argv[0] = (char *)backend_path;
+
+  void *handle = dlopen(backend_path, RTLD_NOW | RTLD_GLOBAL);
+  if (handle == NULL) {
+    fprintf(stderr, "cannot load backend %s: %s\n", backend_path, dlerror());
+    return EXIT_FAILURE;
+  }
+  const pre_init_t pre_init = (pre_init_t)dlsym(handle, "interflop_pre_init");
+  const cli_t cli = (cli_t)dlsym(handle, "interflop_cli");
+  const init_t init = (init_t)dlsym(handle, "interflop_init");
+  if (pre_init == NULL || init == NULL) {
+    fprintf(stderr, "%s is not an interflop backend\n", backend_path);
+    return EXIT_FAILURE;
+  }
+
+  install_stdlib_handlers();
+  void *context = NULL;
+  pre_init(replay_panic, (File *)stderr, &context);
+  if (cli != NULL)
+    cli(backend_argc, backend_argv, context);
+  const struct interflop_backend_interface_t backend = init(context);
+
+  reader_t reader;
+  memset(&reader, 0, sizeof(reader));
+  open_trace(trace_path, &reader);
+  pthread_mutex_init(&reader.lock, NULL);
+  pthread_cond_init(&reader.cond, NULL);
+  pthread_t thread;
+  if (pthread_create(&thread, NULL, reader_thread, &reader) != 0) {
+    fprintf(stderr, "cannot start the reader thread\n");
+    return EXIT_FAILURE;
+  }
+
+  uint64_t counts[IEEE_TRACE_N_OPCODES][2] = {{0}};
+  uint64_t replayed = 0, mismatches = 0, invalid = 0, padding = 0;
+  uint64_t unwritten = 0;
+  double replay_time = 0;
+  const double start = now();
+  window_t w;
+  while (reader_next(&reader, &w)) {
+    const double window_start = now();
+    for (uint64_t i = 0; i < w.n; i++) {
+      const ieee_trace_record_t *rec = &w.records[i];
+      if (rec->opcode == IEEE_TRACE_PAD) {
+        padding++;
+        continue;
+      }
+      if (reader.unfinished && !(rec->flags & IEEE_TRACE_WRITTEN)) {
+        unwritten++;
+        continue;
+      }
+      if (rec->opcode >= IEEE_TRACE_N_OPCODES || rec->precision > 1 ||
+          (rec->opcode == IEEE_TRACE_CAST &&
+           rec->precision != IEEE_TRACE_DOUBLE)) {
+        invalid++;
+        continue;
+      }
+      const uint64_t result = replay_record(&backend, context, rec);
+      counts[rec->opcode][rec->precision]++;
+      if (__builtin_expect(result != rec->result, 0)) {
+        if (mismatches < MAX_REPORTED_MISMATCHES) {
+          printf("mismatch at record %" PRIu64 ": %s %s got 0x%" PRIx64
+                 " expected 0x%" PRIx64 "\n",
+                 replayed + i, ieee_trace_opcode_names[rec->opcode],
+                 rec->precision == IEEE_TRACE_FLOAT ? "float" : "double",
+                 result, rec->result);
+        }
+        mismatches++;
+      }
+    }
+    replay_time += now() - window_start;
+    replayed += w.n;
+    release_window(&w);
+  }
+  const double total_time = now() - start;
+  pthread_join(thread, NULL);
+  if (reader.data != NULL)
+    munmap((void *)reader.data, reader.size);
+  close(reader.fd);
+
+  if (backend.interflop_finalize != NULL)
+    backend.interflop_finalize(context);
+
+  printf("backend %s\n", backend_path);
+  for (int op = 0; op < IEEE_TRACE_N_OPCODES; op++) {
+    if (counts[op][IEEE_TRACE_FLOAT] + counts[op][IEEE_TRACE_DOUBLE] == 0)
+      continue;
+    printf("  %-5s float=%" PRIu64 " double=%" PRIu64 "\n",
+           ieee_trace_opcode_names[op], counts[op][IEEE_TRACE_FLOAT],
+           counts[op][IEEE_TRACE_DOUBLE]);
+  }
+  const uint64_t n_ops = replayed - invalid - padding - unwritten;
+  printf("replayed %" PRIu64 " operations in %.3f s", n_ops, replay_time);
+  /* An empty trace has no rate */
+  if (n_ops > 0 && replay_time > 0 && total_time > 0) {
+    printf(" (%.4g ops/s, %.4g ops/s with reads)",
+           (double)n_ops / replay_time, (double)n_ops / total_time);
+  }
+  printf("\n");
+  if (padding > 0)
+    printf("%" PRIu64 " padding records skipped\n", padding);
+  if (unwritten > 0)
+    printf("%" PRIu64 " unwritten records of an unfinished trace skipped\n",
+           unwritten);
+  printf("%" PRIu64 " mismatches, %" PRIu64 " invalid records\n", mismatches,
+         invalid);
+
+  /* A compressed trace must be decoded up to the end of the file */
+  const bool complete = (reader.data == NULL) || reader.pos == reader.size;
+  if (!complete || (reader.n_records != 0 && replayed != reader.n_records)) {
+    fprintf(stderr, "replay stopped after %" PRIu64 " of %" PRIu64 " records\n",
+            replayed, reader.n_records);
+    return EXIT_FAILURE;
+  }
+  return (mismatches == 0 && invalid == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,253 @@
+/*****************************************************************************\
+ *                                                                           *\
+ *  This file is part of the Verificarlo project,                            *\
+ *  under the Apache License v2.0 with LLVM Exceptions.                      *\
+ *  SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception.                 *\
+ *  See https://llvm.org/LICENSE.txt for license information.                *\
+ *                                                                           *\
+ *  Copyright (c) 2019-2023                                                  *\
+ *     Verificarlo Contributors                                              *\
+ *                                                                           *\
+ ****************************************************************************/
+
+/* Throughput benchmark for the vbackend tables of the IEEE backend.         */
+/*                                                                           */
+/* Every op_vector_float_{1,4,8,16} kernel of the scalar, sse, avx and       */
+/* avx512 tables is run over an in-cache and an out-of-cache working set.    */
+/* Each measure is compared against a native intrinsic loop of the same      */
+/* width, so the difference is the cost of going through the table.         */
+/* Tables and native loops the host CPU cannot run are skipped.              */
+/*                                                                           */
+/* usage: interflop_ieee_vector_bench [min_seconds_per_measure]              */
+/* The duration defaults to VECTOR_BENCH_MIN_SECONDS when it is set, which  */
+/* make check uses to run the benchmark as a short smoke test.              */
+
+#include <immintrin.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "interflop_vinterface.h"
+
+struct interflop_vector_type_t interflop_vector_ieee_init_scalar(void *context);
+struct interflop_vector_type_t interflop_vector_ieee_init_sse(void *context);
+struct interflop_vector_type_t interflop_vector_ieee_init_avx(void *context);
+struct interflop_vector_type_t interflop_vector_ieee_init_avx512(void *context);
+
+typedef void (*vector_op_t)(float *a, float *b, float *c, void *context);
+
+/* In-cache set: three arrays of 16 KiB, fits in L2 on every x86 target */
+#define IN_CACHE_SIZE (4 * 1024)
+/* Out-of-cache set: three arrays of 64 MiB, larger than any LLC */
+#define OUT_OF_CACHE_SIZE (16 * 1024 * 1024)
+
+#define DEFAULT_MIN_TIME 0.2
+
+static const char *op_names[] = {"add", "sub", "mul", "div"};
+static const int widths[] = {1, 4, 8, 16};
+
+#define N_OPS (sizeof(op_names) / sizeof(op_names[0]))
+#define N_WIDTHS (sizeof(widths) / sizeof(widths[0]))
+
+typedef struct {
+  const char *name;
+  struct interflop_vector_type_t (*init)(void *context);
+  bool (*supported)(void);
+} table_desc_t;
+
+static bool cpu_any(void) { return true; }
+static bool cpu_sse2(void) { return __builtin_cpu_supports("sse2"); }
+static bool cpu_avx2(void) { return __builtin_cpu_supports("avx2"); }
+static bool cpu_avx512f(void) { return __builtin_cpu_supports("avx512f"); }
+
+static const table_desc_t tables[] = {
+    {"scalar", interflop_vector_ieee_init_scalar, cpu_any},
+    {"sse", interflop_vector_ieee_init_sse, cpu_sse2},
+    {"avx", interflop_vector_ieee_init_avx, cpu_avx2},
+    {"avx512", interflop_vector_ieee_init_avx512, cpu_avx512f},
+};
+
+/* Returns the kernel of width <width> for op <op> in <vt> */
+static vector_op_t get_kernel(const struct interflop_vector_type_t *vt,
+                              unsigned int op, int width) {
+  const struct interflop_vector_op_t *vop = (op == 0)   ? &vt->add
+                                            : (op == 1) ? &vt->sub
+                                            : (op == 2) ? &vt->mul
+                                                        : &vt->div;
+  switch (width) {
+  case 1:
+    return vop->op_vector_float_1;
+  case 4:
+    return vop->op_vector_float_4;
+  case 8:
+    return vop->op_vector_float_8;
+  default:
+    return vop->op_vector_float_16;
+  }
+}
+
+/* Native loops: same loads/op/stores than the kernels, without the call */
+#define NATIVE_LOOP(NAME, TARGET, TYPE, WIDTH, LOAD, STORE, OP)                \
+  __attribute__((target(TARGET), noinline)) static void NAME(                  \
+      float *a, float *b, float *c, size_t n) {                                \
+    for (size_t i = 0; i < n; i += WIDTH) {                                    \
+      TYPE reg_a = LOAD(a + i);                                                \
+      TYPE reg_b = LOAD(b + i);                                                \
+      STORE(c + i, OP(reg_a, reg_b));                                          \
+    }                                                                          \
+  }
+
+#define NATIVE_LOOPS(OPNAME)                                                   \
+  NATIVE_LOOP(native_##OPNAME##_1, "sse2", __m128, 1, _mm_load_ss,             \
+              _mm_store_ss, _mm_##OPNAME##_ss)                                 \
+  NATIVE_LOOP(native_##OPNAME##_4, "sse2", __m128, 4, _mm_loadu_ps,            \
+              _mm_storeu_ps, _mm_##OPNAME##_ps)                                \
+  NATIVE_LOOP(native_##OPNAME##_8, "avx2", __m256, 8, _mm256_loadu_ps,         \
+              _mm256_storeu_ps, _mm256_##OPNAME##_ps)                          \
+  NATIVE_LOOP(native_##OPNAME##_16, "avx512f", __m512, 16, _mm512_loadu_ps,    \
+              _mm512_storeu_ps, _mm512_##OPNAME##_ps)
+
+NATIVE_LOOPS(add)
+NATIVE_LOOPS(sub)
+NATIVE_LOOPS(mul)
+NATIVE_LOOPS(div)
+
+typedef void (*native_loop_t)(float *a, float *b, float *c, size_t n);
+
+static const native_loop_t native_loops[N_OPS][N_WIDTHS] = {
+    {native_add_1, native_add_4, native_add_8, native_add_16},
+    {native_sub_1, native_sub_4, native_sub_8, native_sub_16},
+    {native_mul_1, native_mul_4, native_mul_8, native_mul_16},
+    {native_div_1, native_div_4, native_div_8, native_div_16},
+};
+
+static bool native_supported(int width) {
+  switch (width) {
+  case 1:
+  case 4:
+    return cpu_sse2();
+  case 8:
+    return cpu_avx2();
+  default:
+    return cpu_avx512f();
+  }
+}
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+typedef struct {
+  double seconds;
+  uint64_t calls;
+  uint64_t flops;
+} measure_t;
+
+/* Runs the table kernel over the whole set until <min_time> is reached */
+static measure_t run_kernel(vector_op_t kernel, int width, float *a, float *b,
+                            float *c, size_t n, double min_time) {
+  measure_t m = {0, 0, 0};
+  const double start = now();
+  do {
+    for (size_t i = 0; i < n; i += width) {
+      kernel(a + i, b + i, c + i, NULL);
+    }
+    m.calls += n / width;
+    m.flops += n;
+    m.seconds = now() - start;
+  } while (m.seconds < min_time);
+  return m;
+}
+
+static measure_t run_native(native_loop_t loop, int width, float *a, float *b,
+                            float *c, size_t n, double min_time) {
+  measure_t m = {0, 0, 0};
+  const double start = now();
+  do {
+    loop(a, b, c, n);
+    m.calls += n / width;
+    m.flops += n;
+    m.seconds = now() - start;
+  } while (m.seconds < min_time);
+  return m;
+}
+
+static float *alloc_set(size_t n) {
+  float *p = aligned_alloc(64, n * sizeof(float));
+  if (p == NULL) {
+    fprintf(stderr, "cannot allocate %zu floats\n", n);
+    exit(EXIT_FAILURE);
+  }
+  /* Values in [1, 2) keep every op away from subnormals and overflows */
+  for (size_t i = 0; i < n; i++) {
+    p[i] = 1.0f + (float)(i % 1024) / 1024.0f;
+  }
+  return p;
+}
+
+static void bench_set(const char *set_name, size_t n, double min_time) {
+  float *a = alloc_set(n);
+  float *b = alloc_set(n);
+  float *c = alloc_set(n);
+
+  printf("\n%s set: %zu floats per operand (%zu KiB)\n", set_name, n,
+         n * sizeof(float) / 1024);
+  printf("%-8s %-4s %5s %14s %10s %10s %10s %10s\n", "table", "op", "width",
+         "calls/s", "GFLOP/s", "ns/call", "native", "overhead");
+
+  for (unsigned int t = 0; t < sizeof(tables) / sizeof(tables[0]); t++) {
+    if (!tables[t].supported()) {
+      printf("%-8s skipped: not supported by this CPU\n", tables[t].name);
+      continue;
+    }
+    const struct interflop_vector_type_t vt = tables[t].init(NULL);
+    for (unsigned int op = 0; op < N_OPS; op++) {
+      for (unsigned int w = 0; w < N_WIDTHS; w++) {
+        const int width = widths[w];
+        const vector_op_t kernel = get_kernel(&vt, op, width);
+        const measure_t m = run_kernel(kernel, width, a, b, c, n, min_time);
+        const double gflops = (double)m.flops / m.seconds * 1e-9;
+        const double calls = (double)m.calls / m.seconds;
+        printf("%-8s %-4s %5d %14.4g %10.3f %10.3f", tables[t].name,
+               op_names[op], width, calls, gflops, 1e9 / calls);
+        if (native_supported(width)) {
+          const measure_t nm =
+              run_native(native_loops[op][w], width, a, b, c, n, min_time);
+          /* Dispatch overhead: extra ns per call relative to native */
+          const double overhead =
+              (m.seconds / m.calls - nm.seconds / nm.calls) * 1e9;
+          printf(" %10.3f %10.3f\n", (double)nm.flops / nm.seconds * 1e-9,
+                 overhead);
+        } else {
+          printf(" %10s %10s\n", "-", "-");
+        }
+      }
+    }
+  }
+
+  free(a);
+  free(b);
+  free(c);
+}
+
+int main(int argc, char *argv[]) {
+  double min_time = DEFAULT_MIN_TIME;
+  const char *min_time_env = getenv("VECTOR_BENCH_MIN_SECONDS");
+  if (argc > 1 || min_time_env != NULL) {
+    min_time = strtod(argc > 1 ? argv[1] : min_time_env, NULL);
+    if (min_time <= 0) {
+      fprintf(stderr, "usage: %s [min_seconds_per_measure]\n", argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  __builtin_cpu_init();
+  bench_set("in-cache", IN_CACHE_SIZE, min_time);
+  bench_set("out-of-cache", OUT_OF_CACHE_SIZE, min_time);
+  return EXIT_SUCCESS;
+}
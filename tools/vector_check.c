@@ -0,0 +1,384 @@
+/*****************************************************************************\
+ *                                                                           *\
+ *  This file is part of the Verificarlo project,                            *\
+ *  under the Apache License v2.0 with LLVM Exceptions.                      *\
+ *  SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception.                 *\
+ *  See https://llvm.org/LICENSE.txt for license information.                *\
+ *                                                                           *\
+ *  Copyright (c) 2019-2023                                                  *\
+ *     Verificarlo Contributors                                              *\
+ *                                                                           *\
+ ****************************************************************************/
+
+/* Bit-exact differential checker for the vbackend tables.                   */
+/*                                                                           */
+/* Every op_vector_float_{1,4,8,16} kernel of the scalar, sse, avx and       */
+/* avx512 tables, and every <op>_float_n kernel for n in [1, 16], is fed     */
+/* with random bit patterns mixed with special values                        */
+/* (+-0, +-Inf, quiet and signaling NaNs with payloads, subnormals, extreme  */
+/* normals) and each lane is compared bit for bit against the scalar SSE     */
+/* instruction, which is the IEEE-754 reference of the host. The operands of */
+/* the <op>_float_n kernels end right before a PROT_NONE page and the lanes  */
+/* past n of the result must be left untouched, so any out-of-bounds access  */
+/* either faults or is reported.                                             */
+/* Tables the host CPU cannot run are skipped.                               */
+/*                                                                           */
+/* When both operands are NaNs, IEEE-754 leaves the choice of the propagated */
+/* payload open and compilers freely commute add and mul, so any of the two  */
+/* quieted operands is accepted. Those lanes are counted apart and become    */
+/* errors with VECTOR_CHECK_STRICT_NAN=1.                                    */
+/*                                                                           */
+/* usage: interflop_ieee_vector_check [lanes_per_kernel [seed]]              */
+/* Exit status is non-zero if any lane differs.                              */
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "interflop_vinterface.h"
+
+struct interflop_vector_type_t interflop_vector_ieee_init_scalar(void *context);
+struct interflop_vector_type_t interflop_vector_ieee_init_sse(void *context);
+struct interflop_vector_type_t interflop_vector_ieee_init_avx(void *context);
+struct interflop_vector_type_t interflop_vector_ieee_init_avx512(void *context);
+
+#define DECLARE_FLOAT_N_KERNELS(ISA)                                           \
+  void interflop_vector_ieee_add_float_n_##ISA(float *a, float *b, float *c,   \
+                                               int n, void *context);          \
+  void interflop_vector_ieee_sub_float_n_##ISA(float *a, float *b, float *c,   \
+                                               int n, void *context);          \
+  void interflop_vector_ieee_mul_float_n_##ISA(float *a, float *b, float *c,   \
+                                               int n, void *context);          \
+  void interflop_vector_ieee_div_float_n_##ISA(float *a, float *b, float *c,   \
+                                               int n, void *context);
+
+DECLARE_FLOAT_N_KERNELS(scalar)
+DECLARE_FLOAT_N_KERNELS(sse)
+DECLARE_FLOAT_N_KERNELS(avx)
+DECLARE_FLOAT_N_KERNELS(avx512)
+
+typedef void (*vector_op_t)(float *a, float *b, float *c, void *context);
+typedef void (*vector_op_n_t)(float *a, float *b, float *c, int n,
+                              void *context);
+
+#define DEFAULT_LANES (1 << 22)
+#define DEFAULT_SEED 0x9e3779b97f4a7c15ULL
+/* Number of lanes checked per kernel call batch */
+#define BATCH 4096
+/* Stop reporting a kernel after that many mismatches */
+#define MAX_REPORTED 8
+/* Largest lane count checked for the <op>_float_n kernels */
+#define MAX_N 16
+/* Bit pattern stored past the n lanes, must survive the kernel */
+#define CANARY 0xdeadbeef
+
+static const char *op_names[] = {"add", "sub", "mul", "div"};
+static const int widths[] = {1, 4, 8, 16};
+
+#define N_OPS (sizeof(op_names) / sizeof(op_names[0]))
+#define N_WIDTHS (sizeof(widths) / sizeof(widths[0]))
+
+typedef struct {
+  const char *name;
+  struct interflop_vector_type_t (*init)(void *context);
+  bool (*supported)(void);
+  vector_op_n_t n_kernels[4];
+} table_desc_t;
+
+static bool cpu_any(void) { return true; }
+static bool cpu_sse2(void) { return __builtin_cpu_supports("sse2"); }
+static bool cpu_avx2(void) { return __builtin_cpu_supports("avx2"); }
+static bool cpu_avx512f(void) { return __builtin_cpu_supports("avx512f"); }
+
+#define FLOAT_N_KERNELS(ISA)                                                   \
+  {                                                                            \
+    interflop_vector_ieee_add_float_n_##ISA,                                   \
+        interflop_vector_ieee_sub_float_n_##ISA,                               \
+        interflop_vector_ieee_mul_float_n_##ISA,                               \
+        interflop_vector_ieee_div_float_n_##ISA                                \
+  }
+
+static const table_desc_t tables[] = {
+    {"scalar", interflop_vector_ieee_init_scalar, cpu_any,
+     FLOAT_N_KERNELS(scalar)},
+    {"sse", interflop_vector_ieee_init_sse, cpu_sse2, FLOAT_N_KERNELS(sse)},
+    {"avx", interflop_vector_ieee_init_avx, cpu_avx2, FLOAT_N_KERNELS(avx)},
+    {"avx512", interflop_vector_ieee_init_avx512, cpu_avx512f,
+     FLOAT_N_KERNELS(avx512)},
+};
+
+static vector_op_t get_kernel(const struct interflop_vector_type_t *vt,
+                              unsigned int op, int width) {
+  const struct interflop_vector_op_t *vop = (op == 0)   ? &vt->add
+                                            : (op == 1) ? &vt->sub
+                                            : (op == 2) ? &vt->mul
+                                                        : &vt->div;
+  switch (width) {
+  case 1:
+    return vop->op_vector_float_1;
+  case 4:
+    return vop->op_vector_float_4;
+  case 8:
+    return vop->op_vector_float_8;
+  default:
+    return vop->op_vector_float_16;
+  }
+}
+
+/* Scalar references. The instruction is pinned with inline assembly so the */
+/* compiler cannot commute the operands, which would change the propagated  */
+/* NaN payload when both operands are NaNs.                                 */
+#define SCALAR_REFERENCE(NAME, INSN)                                           \
+  static float ref_##NAME(float a, float b) {                                  \
+    __asm__(INSN " %1, %0" : "+x"(a) : "x"(b));                                \
+    return a;                                                                  \
+  }
+
+SCALAR_REFERENCE(add, "addss")
+SCALAR_REFERENCE(sub, "subss")
+SCALAR_REFERENCE(mul, "mulss")
+SCALAR_REFERENCE(div, "divss")
+
+static float (*const references[N_OPS])(float, float) = {ref_add, ref_sub,
+                                                         ref_mul, ref_div};
+
+static const uint32_t special_values[] = {
+    0x00000000, /* +0 */
+    0x80000000, /* -0 */
+    0x7f800000, /* +Inf */
+    0xff800000, /* -Inf */
+    0x7fc00000, /* default quiet NaN */
+    0xffc00000, /* negative quiet NaN */
+    0x7fc12345, /* quiet NaN with payload */
+    0xffd5a5a5, /* negative quiet NaN with payload */
+    0x7f800001, /* signaling NaN */
+    0x7fa00bad, /* signaling NaN with payload */
+    0x00000001, /* smallest subnormal */
+    0x807fffff, /* largest negative subnormal */
+    0x00400000, /* mid subnormal */
+    0x00800000, /* smallest normal */
+    0x80800000, /* negative smallest normal */
+    0x7f7fffff, /* largest normal */
+    0xff7fffff, /* negative largest normal */
+    0x3f800000, /* 1 */
+    0xbf800000, /* -1 */
+    0x3f800001, /* 1 + ulp */
+    0x34000000, /* 2^-23 */
+};
+
+#define N_SPECIALS (sizeof(special_values) / sizeof(special_values[0]))
+
+static uint64_t rng_state;
+
+static uint64_t xorshift64(void) {
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 7;
+  rng_state ^= rng_state << 17;
+  return rng_state;
+}
+
+/* 1/4 special values, 1/4 subnormals, 1/4 around 1, 1/4 any bit pattern */
+static uint32_t random_operand(void) {
+  const uint64_t r = xorshift64();
+  const uint32_t bits = (uint32_t)(r >> 32);
+  switch (r & 3) {
+  case 0:
+    return special_values[(r >> 2) % N_SPECIALS];
+  case 1:
+    return (bits & 0x807fffff);
+  case 2:
+    return (bits & 0x807fffff) | 0x3f000000;
+  default:
+    return bits;
+  }
+}
+
+static float from_bits(uint32_t u) {
+  float f;
+  memcpy(&f, &u, sizeof(f));
+  return f;
+}
+
+static uint32_t to_bits(float f) {
+  uint32_t u;
+  memcpy(&u, &f, sizeof(u));
+  return u;
+}
+
+#define QUIET_BIT 0x00400000
+
+static bool is_nan(uint32_t u) { return (u & 0x7fffffff) > 0x7f800000; }
+
+/* True if <got> is the other quieted NaN operand when both are NaNs */
+static bool is_swapped_nan(uint32_t a, uint32_t b, uint32_t got) {
+  return is_nan(a) && is_nan(b) &&
+         (got == (a | QUIET_BIT) || got == (b | QUIET_BIT));
+}
+
+static bool strict_nan = false;
+
+/* Checks one kernel on <lanes> lanes, returns the number of mismatches */
+/* and adds the lanes that only differ by NaN payload to <nan_swaps>     */
+static uint64_t check_kernel(const char *table, unsigned int op, int width,
+                             vector_op_t kernel, uint64_t lanes,
+                             uint64_t *nan_swaps) {
+  /* +1 so that operands are also read from addresses not 64-byte aligned */
+  static float a[BATCH + 1] __attribute__((aligned(64)));
+  static float b[BATCH + 1] __attribute__((aligned(64)));
+  static float c[BATCH + 1] __attribute__((aligned(64)));
+  uint64_t mismatches = 0;
+
+  for (uint64_t done = 0; done < lanes; done += BATCH) {
+    const size_t shift = (done / BATCH) & 1;
+    float *pa = a + shift, *pb = b + shift, *pc = c + shift;
+    for (size_t i = 0; i < BATCH; i++) {
+      pa[i] = from_bits(random_operand());
+      pb[i] = from_bits(random_operand());
+      pc[i] = from_bits(CANARY);
+    }
+    for (size_t i = 0; i < BATCH; i += width) {
+      kernel(pa + i, pb + i, pc + i, NULL);
+    }
+    for (size_t i = 0; i < BATCH; i++) {
+      const uint32_t expected = to_bits(references[op](pa[i], pb[i]));
+      const uint32_t got = to_bits(pc[i]);
+      if (expected == got)
+        continue;
+      if (!strict_nan && is_swapped_nan(to_bits(pa[i]), to_bits(pb[i]), got)) {
+        (*nan_swaps)++;
+        continue;
+      }
+      if (mismatches < MAX_REPORTED) {
+        fprintf(stderr,
+                "%s %s_float_%d lane %zu: 0x%08x %s 0x%08x -> 0x%08x "
+                "(expected 0x%08x)\n",
+                table, op_names[op], width, i % width, to_bits(pa[i]),
+                op_names[op], to_bits(pb[i]), got, expected);
+      }
+      mismatches++;
+    }
+  }
+  return mismatches;
+}
+
+/* Returns a page of memory followed by an inaccessible page */
+static float *alloc_guarded_page(void) {
+  const long page = sysconf(_SC_PAGESIZE);
+  char *p = mmap(NULL, 2 * page, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (p == MAP_FAILED || mprotect(p + page, page, PROT_NONE) != 0) {
+    perror("mmap");
+    exit(EXIT_FAILURE);
+  }
+  return (float *)(p + page);
+}
+
+/* Checks an <op>_float_n kernel for every n in [1, MAX_N], the n lanes */
+/* must match the reference and the lanes past n must keep the canary   */
+static uint64_t check_kernel_n(const char *table, unsigned int op,
+                               vector_op_n_t kernel, uint64_t lanes,
+                               uint64_t *nan_swaps) {
+  /* End of the readable memory, operands are placed right before it */
+  static float *a_end = NULL, *b_end = NULL;
+  float c[2 * MAX_N];
+  uint64_t mismatches = 0;
+  uint64_t done = 0;
+
+  if (a_end == NULL) {
+    a_end = alloc_guarded_page();
+    b_end = alloc_guarded_page();
+  }
+
+  while (done < lanes) {
+    for (int n = 1; n <= MAX_N; n++) {
+      float *a = a_end - n;
+      float *b = b_end - n;
+      done += n;
+      for (int i = 0; i < n; i++) {
+        a[i] = from_bits(random_operand());
+        b[i] = from_bits(random_operand());
+      }
+      for (int i = 0; i < 2 * MAX_N; i++) {
+        c[i] = from_bits(CANARY);
+      }
+      kernel(a, b, c, n, NULL);
+      for (int i = 0; i < 2 * MAX_N; i++) {
+        const uint32_t expected =
+            (i < n) ? to_bits(references[op](a[i], b[i])) : CANARY;
+        const uint32_t got = to_bits(c[i]);
+        if (expected == got)
+          continue;
+        if (i < n && !strict_nan &&
+            is_swapped_nan(to_bits(a[i]), to_bits(b[i]), got)) {
+          (*nan_swaps)++;
+          continue;
+        }
+        if (mismatches < MAX_REPORTED) {
+          fprintf(stderr,
+                  "%s %s_float_n n=%d lane %d: 0x%08x %s 0x%08x -> 0x%08x "
+                  "(expected 0x%08x)\n",
+                  table, op_names[op], n, i, (i < n) ? to_bits(a[i]) : 0,
+                  op_names[op], (i < n) ? to_bits(b[i]) : 0, got, expected);
+        }
+        mismatches++;
+      }
+    }
+  }
+  return mismatches;
+}
+
+int main(int argc, char *argv[]) {
+  uint64_t lanes = DEFAULT_LANES;
+  rng_state = DEFAULT_SEED;
+  if (argc > 1)
+    lanes = strtoull(argv[1], NULL, 0);
+  if (argc > 2)
+    rng_state = strtoull(argv[2], NULL, 0);
+  if (lanes == 0 || rng_state == 0) {
+    fprintf(stderr, "usage: %s [lanes_per_kernel [seed]]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  const char *strict_env = getenv("VECTOR_CHECK_STRICT_NAN");
+  strict_nan = (strict_env != NULL && strcmp(strict_env, "1") == 0);
+
+  __builtin_cpu_init();
+  uint64_t total_mismatches = 0;
+
+  for (unsigned int t = 0; t < sizeof(tables) / sizeof(tables[0]); t++) {
+    if (!tables[t].supported()) {
+      printf("%-8s skipped: not supported by this CPU\n", tables[t].name);
+      continue;
+    }
+    const struct interflop_vector_type_t vt = tables[t].init(NULL);
+    for (unsigned int op = 0; op < N_OPS; op++) {
+      for (unsigned int w = 0; w < N_WIDTHS; w++) {
+        const vector_op_t kernel = get_kernel(&vt, op, widths[w]);
+        uint64_t nan_swaps = 0;
+        const uint64_t mismatches = check_kernel(tables[t].name, op, widths[w],
+                                                 kernel, lanes, &nan_swaps);
+        printf("%-8s %s_float_%-2d %10" PRIu64 " lanes %10" PRIu64
+               " mismatches %8" PRIu64 " NaN payload swaps %s\n",
+               tables[t].name, op_names[op], widths[w], lanes, mismatches,
+               nan_swaps, mismatches ? "FAILED" : "ok");
+        total_mismatches += mismatches;
+      }
+      uint64_t nan_swaps = 0;
+      const uint64_t mismatches =
+          check_kernel_n(tables[t].name, op, tables[t].n_kernels[op], lanes,
+                         &nan_swaps);
+      printf("%-8s %s_float_n  %10" PRIu64 " lanes %10" PRIu64
+             " mismatches %8" PRIu64 " NaN payload swaps %s\n",
+             tables[t].name, op_names[op], lanes, mismatches, nan_swaps,
+             mismatches ? "FAILED" : "ok");
+      total_mismatches += mismatches;
+    }
+  }
+
+  return total_mismatches ? EXIT_FAILURE : EXIT_SUCCESS;
+}
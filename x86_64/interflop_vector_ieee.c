@@ -18,7 +18,10 @@
  *                                                                           *\
  ****************************************************************************/
 
+#include <limits.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 #include "interflop_vinterface.h"
 
 #if defined(__x86_64__)
@@ -42,7 +45,18 @@
 #include <arm_sve.h>
 #endif
 
+#include "interflop/interflop.h"
+#include "interflop/interflop_stdlib.h"
 #include "interflop/iostream/logger.h"
+#include "../common/call_sites.h"
+#include "../common/fingerprint.h"
+#include "../common/overhead.h"
+#include "../common/fpenv.h"
+#include "../common/precision.h"
+#include "../common/probes.h"
+#include "../common/subnormal.h"
+#include "../common/trace.h"
+#include "../interflop_ieee.h"
 
 static File *logger_stderr;
 
@@ -98,14 +112,12 @@ static File *logger_stderr;
 
 void INTERFLOP_VECTOR_IEEE_API(add_float_1)(float *a, float *b, float *c,
                                           void *context) {
-#if defined(__x86_64__)
 #if defined (__AVX512F__) || defined (__AVX2__) || defined (__SSE2__)
   __m128 reg_a = _mm_load_ss (a);
   __m128 reg_b = _mm_load_ss (b);
   __m128 reg_c = _mm_add_ss (reg_a, reg_b);
 
   _mm_store_ss (c, reg_c);
-#endif
 #elif defined(__ARM_ARCH)
   svfloat32_t reg_a = svld1_f32(a);
   svfloat32_t reg_b = svld1_f32(b);
@@ -115,36 +127,35 @@ void INTERFLOP_VECTOR_IEEE_API(add_float_1)(float *a, float *b, float *c,
 #else
   *c = (*a) + (*b);
 #endif
+  IEEE_PROBE_VECTOR(IEEE_TRACE_ADD, 1, a, b, c);
 }
 
 void INTERFLOP_VECTOR_IEEE_API(add_float_4)(float *a, float *b, float *c,
                                           void *context) {
-#if defined(__x86_64__)
 #if defined (__AVX512F__) || defined (__AVX2__) || defined (__SSE2__)
   __m128 reg_a = _mm_loadu_ps (a);
   __m128 reg_b = _mm_loadu_ps (b);
   __m128 reg_c = _mm_add_ps (reg_a, reg_b);
 
   _mm_storeu_ps (c, reg_c);
-#endif
 #else
   c[0] = a[0] + b[0];
   c[1] = a[1] + b[1];
   c[2] = a[2] + b[2];
   c[3] = a[3] + b[3];
 #endif
+  IEEE_PROBE_VECTOR(IEEE_TRACE_ADD, 4, a, b, c);
 }
 
 void INTERFLOP_VECTOR_IEEE_API(add_float_8)(float *a, float *b, float *c,
                                           void *context) {
-#if defined(__x86_64__)
 #if defined (__AVX512F__) || defined (__AVX2__)
   __m256 reg_a = _mm256_loadu_ps (a);
   __m256 reg_b = _mm256_loadu_ps (b);
   __m256 reg_c = _mm256_add_ps (reg_a, reg_b);
 
   _mm256_storeu_ps (c, reg_c);
-#elif defined(__SSE4_2__)
+#elif defined(__SSE2__)
   for (size_t i = 0; i < 2; i++)
   {
     __m128 reg_a = _mm_loadu_ps (a + i*4);
@@ -154,7 +165,6 @@ void INTERFLOP_VECTOR_IEEE_API(add_float_8)(float *a, float *b, float *c,
     _mm_storeu_ps (c + i*4, reg_c);
   }
   
-#endif
 #else
   for (size_t i = 0; i < 2; i++)
   {
@@ -164,11 +174,11 @@ void INTERFLOP_VECTOR_IEEE_API(add_float_8)(float *a, float *b, float *c,
     c[3 + i*4] = a[3 + i*4] + b[3 + i*4];
   }
 #endif
+  IEEE_PROBE_VECTOR(IEEE_TRACE_ADD, 8, a, b, c);
 }
 
 void INTERFLOP_VECTOR_IEEE_API(add_float_16)(float *a, float *b, float *c,
                                           void *context) {
-#if defined(__x86_64__)
 #if defined (__AVX512F__)
   __m512 reg_a = _mm512_loadu_ps (a);
   __m512 reg_b = _mm512_loadu_ps (b);
@@ -184,7 +194,7 @@ void INTERFLOP_VECTOR_IEEE_API(add_float_16)(float *a, float *b, float *c,
 
   _mm256_storeu_ps (c+i*8, reg_c);
   }
-#elif defined(__SSE4_2__)
+#elif defined(__SSE2__)
   for (size_t i = 0; i < 4; i++)
   {
     __m128 reg_a = _mm_loadu_ps (a + i*4);
@@ -194,7 +204,6 @@ void INTERFLOP_VECTOR_IEEE_API(add_float_16)(float *a, float *b, float *c,
     _mm_storeu_ps (c + i*4, reg_c);
   }
   
-#endif
 #else
   for (size_t i = 0; i < 4; i++)
   {
@@ -204,6 +213,7 @@ void INTERFLOP_VECTOR_IEEE_API(add_float_16)(float *a, float *b, float *c,
     c[3 + i*4] = a[3 + i*4] + b[3 + i*4];
   }
 #endif
+  IEEE_PROBE_VECTOR(IEEE_TRACE_ADD, 16, a, b, c);
 }
 
 void INTERFLOP_VECTOR_IEEE_API(sub_float_1)(float *a, float *b, float *c,
@@ -217,36 +227,35 @@ void INTERFLOP_VECTOR_IEEE_API(sub_float_1)(float *a, float *b, float *c,
 #else
   *c = (*a) - (*b);
 #endif
+  IEEE_PROBE_VECTOR(IEEE_TRACE_SUB, 1, a, b, c);
 }
 
 void INTERFLOP_VECTOR_IEEE_API(sub_float_4)(float *a, float *b, float *c,
                                           void *context) {
-#if defined(__x86_64__)
 #if defined (__AVX512F__) || defined (__AVX2__) || defined (__SSE2__)
   __m128 reg_a = _mm_loadu_ps (a);
   __m128 reg_b = _mm_loadu_ps (b);
   __m128 reg_c = _mm_sub_ps (reg_a, reg_b);
 
   _mm_storeu_ps (c, reg_c);
-#endif
 #else
   c[0] = a[0] - b[0];
   c[1] = a[1] - b[1];
   c[2] = a[2] - b[2];
   c[3] = a[3] - b[3];
 #endif
+  IEEE_PROBE_VECTOR(IEEE_TRACE_SUB, 4, a, b, c);
 }
 
 void INTERFLOP_VECTOR_IEEE_API(sub_float_8)(float *a, float *b, float *c,
                                           void *context) {
-#if defined(__x86_64__)
 #if defined (__AVX512F__) || defined (__AVX2__)
   __m256 reg_a = _mm256_loadu_ps (a);
   __m256 reg_b = _mm256_loadu_ps (b);
   __m256 reg_c = _mm256_sub_ps (reg_a, reg_b);
 
   _mm256_storeu_ps (c, reg_c);
-#elif defined(__SSE4_2__)
+#elif defined(__SSE2__)
   for (size_t i = 0; i < 2; i++)
   {
     __m128 reg_a = _mm_loadu_ps (a + i*4);
@@ -256,7 +265,6 @@ void INTERFLOP_VECTOR_IEEE_API(sub_float_8)(float *a, float *b, float *c,
     _mm_storeu_ps (c + i*4, reg_c);
   }
   
-#endif
 #else
   for (size_t i = 0; i < 2; i++)
   {
@@ -266,11 +274,11 @@ void INTERFLOP_VECTOR_IEEE_API(sub_float_8)(float *a, float *b, float *c,
     c[3 + i*4] = a[3 + i*4] - b[3 + i*4];
   }
 #endif
+  IEEE_PROBE_VECTOR(IEEE_TRACE_SUB, 8, a, b, c);
 }
 
 void INTERFLOP_VECTOR_IEEE_API(sub_float_16)(float *a, float *b, float *c,
                                           void *context) {
-#if defined(__x86_64__)
 #if defined (__AVX512F__)
   __m512 reg_a = _mm512_loadu_ps (a);
   __m512 reg_b = _mm512_loadu_ps (b);
@@ -286,7 +294,7 @@ void INTERFLOP_VECTOR_IEEE_API(sub_float_16)(float *a, float *b, float *c,
 
   _mm256_storeu_ps (c+i*8, reg_c);
   }
-#elif defined(__SSE4_2__)
+#elif defined(__SSE2__)
   for (size_t i = 0; i < 4; i++)
   {
     __m128 reg_a = _mm_loadu_ps (a + i*4);
@@ -296,7 +304,6 @@ void INTERFLOP_VECTOR_IEEE_API(sub_float_16)(float *a, float *b, float *c,
     _mm_storeu_ps (c + i*4, reg_c);
   }
   
-#endif
 #else
   for (size_t i = 0; i < 4; i++)
   {
@@ -306,6 +313,7 @@ void INTERFLOP_VECTOR_IEEE_API(sub_float_16)(float *a, float *b, float *c,
     c[3 + i*4] = a[3 + i*4] - b[3 + i*4];
   }
 #endif
+  IEEE_PROBE_VECTOR(IEEE_TRACE_SUB, 16, a, b, c);
 }
 
 void INTERFLOP_VECTOR_IEEE_API(mul_float_1)(float *a, float *b, float *c,
@@ -319,36 +327,35 @@ void INTERFLOP_VECTOR_IEEE_API(mul_float_1)(float *a, float *b, float *c,
 #else
   *c = (*a) * (*b);
 #endif
+  IEEE_PROBE_VECTOR(IEEE_TRACE_MUL, 1, a, b, c);
 }
 
 void INTERFLOP_VECTOR_IEEE_API(mul_float_4)(float *a, float *b, float *c,
                                           void *context) {
-#if defined(__x86_64__)
 #if defined (__AVX512F__) || defined (__AVX2__) || defined (__SSE2__)
   __m128 reg_a = _mm_loadu_ps (a);
   __m128 reg_b = _mm_loadu_ps (b);
   __m128 reg_c = _mm_mul_ps (reg_a, reg_b);
 
   _mm_storeu_ps (c, reg_c);
-#endif
 #else
   c[0] = a[0] * b[0];
   c[1] = a[1] * b[1];
   c[2] = a[2] * b[2];
   c[3] = a[3] * b[3];
 #endif
+  IEEE_PROBE_VECTOR(IEEE_TRACE_MUL, 4, a, b, c);
 }
 
 void INTERFLOP_VECTOR_IEEE_API(mul_float_8)(float *a, float *b, float *c,
                                           void *context) {
-#if defined(__x86_64__)
 #if defined (__AVX512F__) || defined (__AVX2__)
   __m256 reg_a = _mm256_loadu_ps (a);
   __m256 reg_b = _mm256_loadu_ps (b);
   __m256 reg_c = _mm256_mul_ps (reg_a, reg_b);
 
   _mm256_storeu_ps (c, reg_c);
-#elif defined(__SSE4_2__)
+#elif defined(__SSE2__)
   for (size_t i = 0; i < 2; i++)
   {
     __m128 reg_a = _mm_loadu_ps (a + i*4);
@@ -358,7 +365,6 @@ void INTERFLOP_VECTOR_IEEE_API(mul_float_8)(float *a, float *b, float *c,
     _mm_storeu_ps (c + i*4, reg_c);
   }
   
-#endif
 #else
   for (size_t i = 0; i < 2; i++)
   {
@@ -368,11 +374,11 @@ void INTERFLOP_VECTOR_IEEE_API(mul_float_8)(float *a, float *b, float *c,
     c[3 + i*4] = a[3 + i*4] * b[3 + i*4];
   }
 #endif
+  IEEE_PROBE_VECTOR(IEEE_TRACE_MUL, 8, a, b, c);
 }
 
 void INTERFLOP_VECTOR_IEEE_API(mul_float_16)(float *a, float *b, float *c,
                                           void *context) {
-#if defined(__x86_64__)
 #if defined (__AVX512F__)
   __m512 reg_a = _mm512_loadu_ps (a);
   __m512 reg_b = _mm512_loadu_ps (b);
@@ -388,7 +394,7 @@ void INTERFLOP_VECTOR_IEEE_API(mul_float_16)(float *a, float *b, float *c,
 
   _mm256_storeu_ps (c+i*8, reg_c);
   }
-#elif defined(__SSE4_2__)
+#elif defined(__SSE2__)
   for (size_t i = 0; i < 4; i++)
   {
     __m128 reg_a = _mm_loadu_ps (a + i*4);
@@ -398,7 +404,6 @@ void INTERFLOP_VECTOR_IEEE_API(mul_float_16)(float *a, float *b, float *c,
     _mm_storeu_ps (c + i*4, reg_c);
   }
   
-#endif
 #else
   for (size_t i = 0; i < 4; i++)
   {
@@ -408,6 +413,7 @@ void INTERFLOP_VECTOR_IEEE_API(mul_float_16)(float *a, float *b, float *c,
     c[3 + i*4] = a[3 + i*4] * b[3 + i*4];
   }
 #endif
+  IEEE_PROBE_VECTOR(IEEE_TRACE_MUL, 16, a, b, c);
 }
 
 void INTERFLOP_VECTOR_IEEE_API(div_float_1)(float *a, float *b, float *c,
@@ -421,36 +427,35 @@ void INTERFLOP_VECTOR_IEEE_API(div_float_1)(float *a, float *b, float *c,
 #else
   *c = (*a) / (*b);
 #endif
+  IEEE_PROBE_VECTOR(IEEE_TRACE_DIV, 1, a, b, c);
 }
 
 void INTERFLOP_VECTOR_IEEE_API(div_float_4)(float *a, float *b, float *c,
                                           void *context) {
-#if defined(__x86_64__)
 #if defined (__AVX512F__) || defined (__AVX2__) || defined (__SSE2__)
   __m128 reg_a = _mm_loadu_ps (a);
   __m128 reg_b = _mm_loadu_ps (b);
   __m128 reg_c = _mm_div_ps (reg_a, reg_b);
 
   _mm_storeu_ps (c, reg_c);
-#endif
 #else
   c[0] = a[0] / b[0];
   c[1] = a[1] / b[1];
   c[2] = a[2] / b[2];
   c[3] = a[3] / b[3];
 #endif
+  IEEE_PROBE_VECTOR(IEEE_TRACE_DIV, 4, a, b, c);
 }
 
 void INTERFLOP_VECTOR_IEEE_API(div_float_8)(float *a, float *b, float *c,
                                           void *context) {
-#if defined(__x86_64__)
 #if defined (__AVX512F__) || defined (__AVX2__)
   __m256 reg_a = _mm256_loadu_ps (a);
   __m256 reg_b = _mm256_loadu_ps (b);
   __m256 reg_c = _mm256_div_ps (reg_a, reg_b);
 
   _mm256_storeu_ps (c, reg_c);
-#elif defined(__SSE4_2__)
+#elif defined(__SSE2__)
   for (size_t i = 0; i < 2; i++)
   {
     __m128 reg_a = _mm_loadu_ps (a + i*4);
@@ -460,7 +465,6 @@ void INTERFLOP_VECTOR_IEEE_API(div_float_8)(float *a, float *b, float *c,
     _mm_storeu_ps (c + i*4, reg_c);
   }
   
-#endif
 #else
   for (size_t i = 0; i < 2; i++)
   {
@@ -470,11 +474,11 @@ void INTERFLOP_VECTOR_IEEE_API(div_float_8)(float *a, float *b, float *c,
     c[3 + i*4] = a[3 + i*4] / b[3 + i*4];
   }
 #endif
+  IEEE_PROBE_VECTOR(IEEE_TRACE_DIV, 8, a, b, c);
 }
 
 void INTERFLOP_VECTOR_IEEE_API(div_float_16)(float *a, float *b, float *c,
                                           void *context) {
-#if defined(__x86_64__)
 #if defined (__AVX512F__)
   __m512 reg_a = _mm512_loadu_ps (a);
   __m512 reg_b = _mm512_loadu_ps (b);
@@ -490,7 +494,7 @@ void INTERFLOP_VECTOR_IEEE_API(div_float_16)(float *a, float *b, float *c,
 
   _mm256_storeu_ps (c+i*8, reg_c);
   }
-#elif defined(__SSE4_2__)
+#elif defined(__SSE2__)
   for (size_t i = 0; i < 4; i++)
   {
     __m128 reg_a = _mm_loadu_ps (a + i*4);
@@ -500,7 +504,6 @@ void INTERFLOP_VECTOR_IEEE_API(div_float_16)(float *a, float *b, float *c,
     _mm_storeu_ps (c + i*4, reg_c);
   }
   
-#endif
 #else
   for (size_t i = 0; i < 4; i++)
   {
@@ -510,9 +513,861 @@ void INTERFLOP_VECTOR_IEEE_API(div_float_16)(float *a, float *b, float *c,
     c[3 + i*4] = a[3 + i*4] / b[3 + i*4];
   }
 #endif
+  IEEE_PROBE_VECTOR(IEEE_TRACE_DIV, 16, a, b, c);
 }
-struct interflop_vector_type_t INTERFLOP_VECTOR_IEEE_API(init)(void *context)
-{
+/* Kernels for an arbitrary number of lanes <n>, used for the <2 x float>, */
+/* <3 x float> and other odd-width vectors that do not fit the 1/4/8/16    */
+/* slots. Whole registers are processed first, the remaining lanes go      */
+/* through a masked load/op/store so no memory outside [0, n) is touched.  */
+/* With AVX2 the inactive lanes are set to 1.0 so they raise no exception. */
+#if defined (__AVX2__) && !defined (__AVX512F__)
+static const int32_t lane_mask_table[16] = {-1, -1, -1, -1, -1, -1, -1, -1,
+                                            0,  0,  0,  0,  0,  0,  0,  0};
+#endif
+
+#if defined (__AVX512F__)
+#define DEFINE_FLOAT_N_KERNEL(NAME, OP)                                        \
+  static inline void _vieee_##NAME##_float_n(float *a, float *b, float *c,    \
+                                             int n) {                          \
+    for (; n >= 16; n -= 16, a += 16, b += 16, c += 16) {                      \
+      __m512 reg_a = _mm512_loadu_ps (a);                                      \
+      __m512 reg_b = _mm512_loadu_ps (b);                                      \
+      _mm512_storeu_ps (c, _mm512_##NAME##_ps (reg_a, reg_b));                 \
+    }                                                                          \
+    if (n > 0) {                                                               \
+      const __mmask16 mask = (__mmask16)((1U << n) - 1);                       \
+      __m512 reg_a = _mm512_maskz_loadu_ps (mask, a);                          \
+      __m512 reg_b = _mm512_maskz_loadu_ps (mask, b);                          \
+      __m512 reg_c = _mm512_maskz_##NAME##_ps (mask, reg_a, reg_b);            \
+      _mm512_mask_storeu_ps (c, mask, reg_c);                                  \
+    }                                                                          \
+  }
+#elif defined (__AVX2__)
+#define DEFINE_FLOAT_N_KERNEL(NAME, OP)                                        \
+  static inline void _vieee_##NAME##_float_n(float *a, float *b, float *c,    \
+                                             int n) {                          \
+    for (; n >= 8; n -= 8, a += 8, b += 8, c += 8) {                           \
+      __m256 reg_a = _mm256_loadu_ps (a);                                      \
+      __m256 reg_b = _mm256_loadu_ps (b);                                      \
+      _mm256_storeu_ps (c, _mm256_##NAME##_ps (reg_a, reg_b));                 \
+    }                                                                          \
+    if (n > 0) {                                                               \
+      const __m256i mask =                                                     \
+          _mm256_loadu_si256 ((const __m256i *)(lane_mask_table + 8 - n));     \
+      const __m256 fmask = _mm256_castsi256_ps (mask);                         \
+      const __m256 ones = _mm256_set1_ps (1.0f);                               \
+      __m256 reg_a = _mm256_blendv_ps (ones, _mm256_maskload_ps (a, mask),     \
+                                       fmask);                                 \
+      __m256 reg_b = _mm256_blendv_ps (ones, _mm256_maskload_ps (b, mask),     \
+                                       fmask);                                 \
+      _mm256_maskstore_ps (c, mask, _mm256_##NAME##_ps (reg_a, reg_b));        \
+    }                                                                          \
+  }
+#elif defined (__SSE2__)
+#define DEFINE_FLOAT_N_KERNEL(NAME, OP)                                        \
+  static inline void _vieee_##NAME##_float_n(float *a, float *b, float *c,    \
+                                             int n) {                          \
+    for (; n >= 4; n -= 4, a += 4, b += 4, c += 4) {                           \
+      __m128 reg_a = _mm_loadu_ps (a);                                         \
+      __m128 reg_b = _mm_loadu_ps (b);                                         \
+      _mm_storeu_ps (c, _mm_##NAME##_ps (reg_a, reg_b));                       \
+    }                                                                          \
+    for (; n > 0; n--, a++, b++, c++) {                                        \
+      __m128 reg_a = _mm_load_ss (a);                                          \
+      __m128 reg_b = _mm_load_ss (b);                                          \
+      _mm_store_ss (c, _mm_##NAME##_ss (reg_a, reg_b));                        \
+    }                                                                          \
+  }
+#else
+#define DEFINE_FLOAT_N_KERNEL(NAME, OP)                                        \
+  static inline void _vieee_##NAME##_float_n(float *a, float *b, float *c,    \
+                                             int n) {                          \
+    for (int i = 0; i < n; i++) {                                              \
+      c[i] = a[i] OP b[i];                                                     \
+    }                                                                          \
+  }
+#endif
+
+DEFINE_FLOAT_N_KERNEL(add, +)
+DEFINE_FLOAT_N_KERNEL(sub, -)
+DEFINE_FLOAT_N_KERNEL(mul, *)
+DEFINE_FLOAT_N_KERNEL(div, /)
+
+/* Lanes of the largest vector of the <op>_float_n entry points */
+#define IEEE_VECTOR_N_MAX 16
+
+/* Table returned by init, and whether it wraps the plain kernels in the */
+/* kernels of the floating-point environment or of the profiling options */
+static struct interflop_vector_type_t vieee_n_table;
+static bool vieee_n_wrapped = false;
+
+/* With a wrapped table, the <n> lanes are split into calls of its 8, 4 */
+/* and 1 lanes kernels, so that they run under the same options and are */
+/* observed as the same operations on fixed widths, at the call site of */
+/* the entry point                                                       */
+#define DEFINE_FLOAT_N_ENTRY(NAME, OPCODE)                                     \
+  void INTERFLOP_VECTOR_IEEE_API(NAME##_float_n)(float *a, float *b, float *c, \
+                                                 int n, void *context) {       \
+    if (__builtin_expect (n < 0 || n > IEEE_VECTOR_N_MAX, 0))                  \
+      interflop_panic ("interflop_vector_ieee: " #NAME "_float_n takes "       \
+                       "at most 16 lanes\n");                                  \
+    if (!vieee_n_wrapped) {                                                    \
+      _vieee_##NAME##_float_n (a, b, c, n);                                    \
+      IEEE_PROBE_VECTOR(OPCODE, n, a, b, c);                                   \
+      return;                                                                  \
+    }                                                                          \
+    const void *outer = ieee_site_caller;                                      \
+    ieee_site_caller = IEEE_CALL_SITE ();                                      \
+    int i = 0;                                                                 \
+    if (n == 16) {                                                             \
+      vieee_n_table.NAME.op_vector_float_16 (a, b, c, context);                \
+      i = 16;                                                                  \
+    }                                                                          \
+    for (; i + 8 <= n; i += 8)                                                 \
+      vieee_n_table.NAME.op_vector_float_8 (a + i, b + i, c + i, context);     \
+    for (; i + 4 <= n; i += 4)                                                 \
+      vieee_n_table.NAME.op_vector_float_4 (a + i, b + i, c + i, context);     \
+    for (; i < n; i++)                                                         \
+      vieee_n_table.NAME.op_vector_float_1 (a + i, b + i, c + i, context);     \
+    ieee_site_caller = outer;                                                  \
+  }
+
+DEFINE_FLOAT_N_ENTRY(add, IEEE_TRACE_ADD)
+DEFINE_FLOAT_N_ENTRY(sub, IEEE_TRACE_SUB)
+DEFINE_FLOAT_N_ENTRY(mul, IEEE_TRACE_MUL)
+DEFINE_FLOAT_N_ENTRY(div, IEEE_TRACE_DIV)
+
+/* Kernels used with --rounding other than nearest or --ftz-daz. They    */
+/* install the MXCSR the first time a thread enters the backend. The       */
+/* probe is the one of the entry point they run.                           */
+#define DEFINE_FPENV_KERNEL(NAME)                                              \
+  static void _vieee_##NAME##_fpenv(float *a, float *b, float *c,              \
+                                    void *context) {                           \
+    ieee_fpenv_enter();                                                        \
+    INTERFLOP_VECTOR_IEEE_API(NAME)(a, b, c, context);                         \
+  }
+
+#define DEFINE_FPENV_KERNELS(OP)                                               \
+  DEFINE_FPENV_KERNEL(OP##_float_1)                                            \
+  DEFINE_FPENV_KERNEL(OP##_float_4)                                            \
+  DEFINE_FPENV_KERNEL(OP##_float_8)                                            \
+  DEFINE_FPENV_KERNEL(OP##_float_16)
+
+DEFINE_FPENV_KERNELS(add)
+DEFINE_FPENV_KERNELS(sub)
+DEFINE_FPENV_KERNELS(mul)
+DEFINE_FPENV_KERNELS(div)
+
+#define FPENV_OP(OP)                                                           \
+  {                                                                            \
+    op_vector_float_1 : _vieee_##OP##_float_1_fpenv,                           \
+    op_vector_float_4 : _vieee_##OP##_float_4_fpenv,                           \
+    op_vector_float_8 : _vieee_##OP##_float_8_fpenv,                           \
+    op_vector_float_16 : _vieee_##OP##_float_16_fpenv                          \
+  }
+
+#if defined (__AVX512F__)
+/* 16 lanes kernels with AVX-512 embedded rounding, they do not depend on  */
+/* the MXCSR. Embedded rounding implies suppress-all-exceptions.           */
+#define DEFINE_ROUND_KERNEL_16(OP, OPCODE, MODE, ROUNDING)                     \
+  static void _vieee_##OP##_float_16_##MODE(                                   \
+      float *a, float *b, float *c, __attribute__((unused)) void *context) {   \
+    __m512 reg_a = _mm512_loadu_ps (a);                                        \
+    __m512 reg_b = _mm512_loadu_ps (b);                                        \
+    __m512 reg_c = _mm512_##OP##_round_ps (reg_a, reg_b,                       \
+                                           ROUNDING | _MM_FROUND_NO_EXC);      \
+    _mm512_storeu_ps (c, reg_c);                                               \
+    IEEE_PROBE_VECTOR(OPCODE, 16, a, b, c);                                    \
+  }
+
+#define DEFINE_ROUND_KERNELS_16(OP, OPCODE)                                    \
+  DEFINE_ROUND_KERNEL_16(OP, OPCODE, up, _MM_FROUND_TO_POS_INF)                \
+  DEFINE_ROUND_KERNEL_16(OP, OPCODE, down, _MM_FROUND_TO_NEG_INF)              \
+  DEFINE_ROUND_KERNEL_16(OP, OPCODE, zero, _MM_FROUND_TO_ZERO)
+
+DEFINE_ROUND_KERNELS_16(add, IEEE_TRACE_ADD)
+DEFINE_ROUND_KERNELS_16(sub, IEEE_TRACE_SUB)
+DEFINE_ROUND_KERNELS_16(mul, IEEE_TRACE_MUL)
+DEFINE_ROUND_KERNELS_16(div, IEEE_TRACE_DIV)
+
+#define ROUND_OP(OP, MODE)                                                     \
+  {                                                                            \
+    op_vector_float_1 : _vieee_##OP##_float_1_fpenv,                           \
+    op_vector_float_4 : _vieee_##OP##_float_4_fpenv,                           \
+    op_vector_float_8 : _vieee_##OP##_float_8_fpenv,                           \
+    op_vector_float_16 : _vieee_##OP##_float_16_##MODE                         \
+  }
+
+#define ROUND_TABLE(MODE)                                                      \
+  {                                                                            \
+    add : ROUND_OP(add, MODE),                                                 \
+    sub : ROUND_OP(sub, MODE),                                                 \
+    mul : ROUND_OP(mul, MODE),                                                 \
+    div : ROUND_OP(div, MODE)                                                  \
+  }
+#endif
+
+/* Returns the table for a non-default floating-point environment */
+static struct interflop_vector_type_t
+_vieee_init_fpenv(__attribute__((unused)) const ieee_context_t *ctx) {
+#if defined (__AVX512F__)
+  /* Embedded rounding overrides the MXCSR rounding bits but not FTZ/DAZ, */
+  /* the 16 lanes kernels must install the MXCSR too with --ftz-daz. It   */
+  /* also suppresses the exceptions, which --trap must see                */
+  if (!ctx->ftz_daz && !ctx->trap) {
+    static const struct interflop_vector_type_t up = ROUND_TABLE(up);
+    static const struct interflop_vector_type_t down = ROUND_TABLE(down);
+    static const struct interflop_vector_type_t zero = ROUND_TABLE(zero);
+    switch (ctx->rounding) {
+    case IEEE_ROUND_UP:
+      return up;
+    case IEEE_ROUND_DOWN:
+      return down;
+    default:
+      return zero;
+    }
+  }
+#endif
+  struct interflop_vector_type_t vbackend = {
+    add : FPENV_OP(add),
+    sub : FPENV_OP(sub),
+    mul : FPENV_OP(mul),
+    div : FPENV_OP(div)
+  };
+  return vbackend;
+}
+
+/* Kernels used with --precision-profile. They run the kernels of the      */
+/* table they replace, then count per call site the lanes whose operands   */
+/* and result fit fp16 and bf16 (see common/precision.h), with the same    */
+/* exponent-range and dropped-bits tests as the scalar operations, on      */
+/* whole registers. The budget is compared as a signed 32-bit integer.     */
+static struct interflop_vector_type_t vieee_profiled;
+
+#if defined (__AVX512F__)
+/* Returns the mask of the lanes of <x> which fit <format> */
+static inline uint32_t _vieee_fits_16(__m512i x,
+                                      const ieee_format_desc_t *format,
+                                      __m512i budget) {
+  const __m512i one = _mm512_set1_epi32 (1);
+  const __m512i abs = _mm512_and_si512 (x, _mm512_set1_epi32 (0x7fffffff));
+  const __m512i exp = _mm512_srli_epi32 (abs, 23);
+  const __m512i zero = _mm512_setzero_si512 ();
+  const __mmask16 special =
+      _mm512_cmpeq_epi32_mask (exp, _mm512_set1_epi32 (0xff)) |
+      _mm512_cmpeq_epi32_mask (abs, zero);
+  const __mmask16 normal = _mm512_cmpgt_epi32_mask (exp, zero);
+  __m512i sig = _mm512_and_si512 (abs, _mm512_set1_epi32 (0x7fffff));
+  sig = _mm512_mask_or_epi32 (sig, normal, sig, _mm512_set1_epi32 (0x800000));
+  const __m512i e = _mm512_sub_epi32 (_mm512_max_epi32 (exp, one),
+                                      _mm512_set1_epi32 (127));
+  const __mmask16 over =
+      _mm512_cmpgt_epi32_mask (e, _mm512_set1_epi32 (format->emax));
+  __m512i d = _mm512_sub_epi32 (_mm512_set1_epi32 (format->emin), e);
+  d = _mm512_max_epi32 (d, zero);
+  d = _mm512_add_epi32 (d, _mm512_set1_epi32 (23 - (format->p - 1)));
+  d = _mm512_min_epi32 (d, _mm512_set1_epi32 (30));
+  const __m512i unit = _mm512_sllv_epi32 (one, d);
+  const __m512i rem = _mm512_and_si512 (sig, _mm512_sub_epi32 (unit, one));
+  const __m512i dist = _mm512_min_epi32 (rem, _mm512_sub_epi32 (unit, rem));
+  const __mmask16 near = _mm512_cmple_epi32_mask (dist, budget);
+  return special | (near & ~over);
+}
+#endif
+
+#if defined (__AVX2__)
+static inline uint32_t _vieee_fits_8(__m256i x,
+                                     const ieee_format_desc_t *format,
+                                     __m256i budget) {
+  const __m256i one = _mm256_set1_epi32 (1);
+  const __m256i zero = _mm256_setzero_si256 ();
+  const __m256i abs = _mm256_and_si256 (x, _mm256_set1_epi32 (0x7fffffff));
+  const __m256i exp = _mm256_srli_epi32 (abs, 23);
+  const __m256i special = _mm256_or_si256 (
+      _mm256_cmpeq_epi32 (exp, _mm256_set1_epi32 (0xff)),
+      _mm256_cmpeq_epi32 (abs, zero));
+  const __m256i normal = _mm256_cmpgt_epi32 (exp, zero);
+  const __m256i sig = _mm256_or_si256 (
+      _mm256_and_si256 (abs, _mm256_set1_epi32 (0x7fffff)),
+      _mm256_and_si256 (normal, _mm256_set1_epi32 (0x800000)));
+  const __m256i e = _mm256_sub_epi32 (_mm256_max_epi32 (exp, one),
+                                      _mm256_set1_epi32 (127));
+  const __m256i over =
+      _mm256_cmpgt_epi32 (e, _mm256_set1_epi32 (format->emax));
+  __m256i d = _mm256_sub_epi32 (_mm256_set1_epi32 (format->emin), e);
+  d = _mm256_max_epi32 (d, zero);
+  d = _mm256_add_epi32 (d, _mm256_set1_epi32 (23 - (format->p - 1)));
+  d = _mm256_min_epi32 (d, _mm256_set1_epi32 (30));
+  const __m256i unit = _mm256_sllv_epi32 (one, d);
+  const __m256i rem = _mm256_and_si256 (sig, _mm256_sub_epi32 (unit, one));
+  const __m256i dist = _mm256_min_epi32 (rem, _mm256_sub_epi32 (unit, rem));
+  const __m256i far = _mm256_or_si256 (_mm256_cmpgt_epi32 (dist, budget), over);
+  const __m256i fits =
+      _mm256_or_si256 (special, _mm256_xor_si256 (far, _mm256_set1_epi32 (-1)));
+  return _mm256_movemask_ps (_mm256_castsi256_ps (fits));
+}
+#endif
+
+#if defined (__SSE2__)
+/* SSE2 has no 32-bit min/max nor variable shifts: a <= b ? a : b is built */
+/* from a comparison, and 2^d comes from the exponent field of a float     */
+static inline __m128i _vieee_select_sse2(__m128i mask, __m128i a, __m128i b) {
+  return _mm_or_si128 (_mm_and_si128 (mask, a), _mm_andnot_si128 (mask, b));
+}
+
+static inline uint32_t _vieee_fits_4(__m128i x,
+                                     const ieee_format_desc_t *format,
+                                     __m128i budget) {
+  const __m128i one = _mm_set1_epi32 (1);
+  const __m128i zero = _mm_setzero_si128 ();
+  const __m128i abs = _mm_and_si128 (x, _mm_set1_epi32 (0x7fffffff));
+  const __m128i exp = _mm_srli_epi32 (abs, 23);
+  const __m128i special =
+      _mm_or_si128 (_mm_cmpeq_epi32 (exp, _mm_set1_epi32 (0xff)),
+                    _mm_cmpeq_epi32 (abs, zero));
+  const __m128i normal = _mm_cmpgt_epi32 (exp, zero);
+  const __m128i sig = _mm_or_si128 (
+      _mm_and_si128 (abs, _mm_set1_epi32 (0x7fffff)),
+      _mm_and_si128 (normal, _mm_set1_epi32 (0x800000)));
+  const __m128i e = _mm_sub_epi32 (_vieee_select_sse2 (normal, exp, one),
+                                   _mm_set1_epi32 (127));
+  const __m128i over = _mm_cmpgt_epi32 (e, _mm_set1_epi32 (format->emax));
+  __m128i d = _mm_sub_epi32 (_mm_set1_epi32 (format->emin), e);
+  d = _mm_and_si128 (_mm_cmpgt_epi32 (d, zero), d);
+  d = _mm_add_epi32 (d, _mm_set1_epi32 (23 - (format->p - 1)));
+  const __m128i max_d = _mm_set1_epi32 (30);
+  d = _vieee_select_sse2 (_mm_cmpgt_epi32 (d, max_d), max_d, d);
+  const __m128i unit = _mm_cvttps_epi32 (_mm_castsi128_ps (
+      _mm_slli_epi32 (_mm_add_epi32 (d, _mm_set1_epi32 (127)), 23)));
+  const __m128i rem = _mm_and_si128 (sig, _mm_sub_epi32 (unit, one));
+  const __m128i other = _mm_sub_epi32 (unit, rem);
+  const __m128i dist =
+      _vieee_select_sse2 (_mm_cmplt_epi32 (rem, other), rem, other);
+  const __m128i far = _mm_or_si128 (_mm_cmpgt_epi32 (dist, budget), over);
+  const __m128i fits =
+      _mm_or_si128 (special, _mm_xor_si128 (far, _mm_set1_epi32 (-1)));
+  return _mm_movemask_ps (_mm_castsi128_ps (fits));
+}
+#endif
+
+/* Sets in fits[f] the bits of the lanes of <x> which fit format f, for */
+/* f in fp16 and bf16                                                    */
+static inline void _vieee_fit_lanes(const float *x, int n, uint64_t ulps,
+                                    uint32_t fits[IEEE_N_FORMATS]) {
+  int i = 0;
+#if defined (__SSE2__)
+  /* Every SIMD width below implies SSE2 */
+  const int32_t budget = (ulps > INT32_MAX) ? INT32_MAX : (int32_t)ulps;
+#endif
+#if defined (__AVX512F__)
+  for (; i + 16 <= n; i += 16) {
+    const __m512i v = _mm512_loadu_si512 (x + i);
+    const __m512i b = _mm512_set1_epi32 (budget);
+    for (int f = IEEE_FORMAT_FP16; f < IEEE_N_FORMATS; f++)
+      fits[f] |= _vieee_fits_16 (v, &ieee_formats[f], b) << i;
+  }
+#endif
+#if defined (__AVX2__)
+  for (; i + 8 <= n; i += 8) {
+    const __m256i v = _mm256_loadu_si256 ((const __m256i *)(x + i));
+    const __m256i b = _mm256_set1_epi32 (budget);
+    for (int f = IEEE_FORMAT_FP16; f < IEEE_N_FORMATS; f++)
+      fits[f] |= _vieee_fits_8 (v, &ieee_formats[f], b) << i;
+  }
+#endif
+#if defined (__SSE2__)
+  for (; i + 4 <= n; i += 4) {
+    const __m128i v = _mm_loadu_si128 ((const __m128i *)(x + i));
+    const __m128i b = _mm_set1_epi32 (budget);
+    for (int f = IEEE_FORMAT_FP16; f < IEEE_N_FORMATS; f++)
+      fits[f] |= _vieee_fits_4 (v, &ieee_formats[f], b) << i;
+  }
+#endif
+  for (; i < n; i++) {
+    uint32_t bits;
+    memcpy (&bits, x + i, sizeof (bits));
+    const unsigned mask = ieee_precision_fits_binary32 (bits, ulps);
+    for (int f = IEEE_FORMAT_FP16; f < IEEE_N_FORMATS; f++)
+      fits[f] |= ((mask >> f) & 1) << i;
+  }
+}
+
+#define DEFINE_PROFILE_KERNEL(OP, OPCODE, N)                                   \
+  static void _vieee_##OP##_float_##N##_profile(float *a, float *b, float *c,  \
+                                                void *context) {               \
+    const void *site = IEEE_CALL_SITE ();                                      \
+    ieee_context_t *ctx = (ieee_context_t *)context;                           \
+    uint32_t fits_a[IEEE_N_FORMATS] = {0}, fits_b[IEEE_N_FORMATS] = {0};       \
+    uint32_t fits_c[IEEE_N_FORMATS] = {0};                                     \
+    /* c may alias a or b */                                                   \
+    _vieee_fit_lanes (a, N, ctx->precision_ulps, fits_a);                      \
+    _vieee_fit_lanes (b, N, ctx->precision_ulps, fits_b);                      \
+    vieee_profiled.OP.op_vector_float_##N (a, b, c, context);                  \
+    _vieee_fit_lanes (c, N, ctx->precision_ulps, fits_c);                      \
+    ieee_site_t *entry = ieee_site_lookup (                                    \
+        ctx->precision_sites, ieee_site_key (site, OPCODE, IEEE_TRACE_FLOAT)); \
+    ieee_site_add (entry, 0, N);                                               \
+    ieee_site_add (entry, IEEE_PRECISION_COUNTER (IEEE_FORMAT_FP32), N);       \
+    for (int f = IEEE_FORMAT_FP16; f < IEEE_N_FORMATS; f++) {                  \
+      const uint32_t fits = fits_a[f] & fits_b[f] & fits_c[f];                 \
+      if (fits)                                                                \
+        ieee_site_add (entry, IEEE_PRECISION_COUNTER (f),                      \
+                       __builtin_popcount (fits));                             \
+    }                                                                          \
+  }
+
+#define DEFINE_PROFILE_KERNELS(OP, OPCODE)                                     \
+  DEFINE_PROFILE_KERNEL(OP, OPCODE, 1)                                         \
+  DEFINE_PROFILE_KERNEL(OP, OPCODE, 4)                                         \
+  DEFINE_PROFILE_KERNEL(OP, OPCODE, 8)                                         \
+  DEFINE_PROFILE_KERNEL(OP, OPCODE, 16)
+
+DEFINE_PROFILE_KERNELS(add, IEEE_TRACE_ADD)
+DEFINE_PROFILE_KERNELS(sub, IEEE_TRACE_SUB)
+DEFINE_PROFILE_KERNELS(mul, IEEE_TRACE_MUL)
+DEFINE_PROFILE_KERNELS(div, IEEE_TRACE_DIV)
+
+#define PROFILE_OP(OP)                                                         \
+  {                                                                            \
+    op_vector_float_1 : _vieee_##OP##_float_1_profile,                         \
+    op_vector_float_4 : _vieee_##OP##_float_4_profile,                         \
+    op_vector_float_8 : _vieee_##OP##_float_8_profile,                         \
+    op_vector_float_16 : _vieee_##OP##_float_16_profile                        \
+  }
+
+/* Returns the profiling table wrapping <vbackend> */
+static struct interflop_vector_type_t
+_vieee_init_profile(struct interflop_vector_type_t vbackend) {
+  vieee_profiled = vbackend;
+  struct interflop_vector_type_t profile = {
+    add : PROFILE_OP(add),
+    sub : PROFILE_OP(sub),
+    mul : PROFILE_OP(mul),
+    div : PROFILE_OP(div)
+  };
+  return profile;
+}
+
+/* Kernels used with --subnormal-profile. They OR the masks of the lanes  */
+/* whose operands or result are subnormal (see common/subnormal.h) and    */
+/* only look the call site up when it is not empty. The kernels they wrap */
+/* are run with the call site set in ieee_site_caller for the profiling   */
+/* kernels under them. Sampled calls are replayed into a scratch result   */
+/* with the kernels of the floating-point environment, below the other    */
+/* wrappers, so that replays are neither hashed nor profiled.             */
+static struct interflop_vector_type_t vieee_subnormal;
+static struct interflop_vector_type_t vieee_subnormal_base;
+
+typedef void (*vieee_kernel_t) (float *, float *, float *, void *);
+
+/* Returns the mask of the subnormal lanes of the <n> floats of <x>: the */
+/* magnitude minus one is in [0, 0x7fffff), compared as signed integers  */
+static inline uint32_t _vieee_subnormal_lanes(const float *x, int n) {
+  uint32_t mask = 0;
+  int i = 0;
+#if defined (__AVX512F__)
+  for (; i + 16 <= n; i += 16) {
+    const __m512i v = _mm512_loadu_si512 (x + i);
+    const __m512i m = _mm512_sub_epi32 (
+        _mm512_and_si512 (v, _mm512_set1_epi32 (0x7fffffff)),
+        _mm512_set1_epi32 (1));
+    mask |= (uint32_t)_mm512_cmplt_epu32_mask (m, _mm512_set1_epi32 (0x7fffff))
+            << i;
+  }
+#endif
+#if defined (__AVX2__)
+  for (; i + 8 <= n; i += 8) {
+    const __m256i v = _mm256_loadu_si256 ((const __m256i *)(x + i));
+    const __m256i m = _mm256_sub_epi32 (
+        _mm256_and_si256 (v, _mm256_set1_epi32 (0x7fffffff)),
+        _mm256_set1_epi32 (1));
+    const __m256i sub = _mm256_and_si256 (
+        _mm256_cmpgt_epi32 (_mm256_set1_epi32 (0x7fffff), m),
+        _mm256_cmpgt_epi32 (m, _mm256_set1_epi32 (-1)));
+    mask |= (uint32_t)_mm256_movemask_ps (_mm256_castsi256_ps (sub)) << i;
+  }
+#endif
+#if defined (__SSE2__)
+  for (; i + 4 <= n; i += 4) {
+    const __m128i v = _mm_loadu_si128 ((const __m128i *)(x + i));
+    const __m128i m = _mm_sub_epi32 (
+        _mm_and_si128 (v, _mm_set1_epi32 (0x7fffffff)), _mm_set1_epi32 (1));
+    const __m128i sub =
+        _mm_and_si128 (_mm_cmpgt_epi32 (_mm_set1_epi32 (0x7fffff), m),
+                       _mm_cmpgt_epi32 (m, _mm_set1_epi32 (-1)));
+    mask |= (uint32_t)_mm_movemask_ps (_mm_castsi128_ps (sub)) << i;
+  }
+#endif
+  for (; i < n; i++) {
+    uint32_t bits;
+    memcpy (&bits, x + i, sizeof (bits));
+    mask |= (uint32_t)ieee_subnormal_binary32 (bits) << i;
+  }
+  return mask;
+}
+
+/* Returns the cycles of <kernel> on <a> and <b>, the least of two runs */
+static uint64_t _vieee_subnormal_time(vieee_kernel_t kernel, float *a,
+                                      float *b, void *context) {
+  float r[16];
+  uint64_t best = UINT64_MAX;
+  for (int i = 0; i < 2; i++) {
+    const uint64_t start = ieee_overhead_clock ();
+    kernel (a, b, r, context);
+    const uint64_t stop = ieee_overhead_clock ();
+    if (stop - start < best)
+      best = stop - start;
+  }
+  return best;
+}
+
+/* Counts a call of <n> lanes with subnormal operands (<in>) or result */
+/* (<out>) at <site>, and replays it if the thread takes a sample       */
+static void _vieee_subnormal_record(void *context, const void *site,
+                                    unsigned opcode, uint32_t in, uint32_t out,
+                                    float *a, float *b, const float *c, int n,
+                                    vieee_kernel_t kernel) {
+  ieee_context_t *ctx = (ieee_context_t *)context;
+  ieee_site_t *entry = ieee_site_lookup (
+      ctx->subnormal_sites, ieee_site_key (site, opcode, IEEE_TRACE_FLOAT));
+  ieee_site_add (entry, IEEE_SUBNORMAL_OPS, __builtin_popcount (in | out));
+  ieee_site_add (entry, IEEE_SUBNORMAL_INPUTS, __builtin_popcount (in));
+  ieee_site_add (entry, IEEE_SUBNORMAL_OUTPUTS, __builtin_popcount (out));
+  ieee_site_add (entry, IEEE_SUBNORMAL_CALLS, 1);
+  /* The operands are lost if the result overwrote them */
+  if (c == a || c == b || !ieee_subnormal_sample ())
+    return;
+  float ones[16];
+  for (int i = 0; i < n; i++)
+    ones[i] = 1.0f;
+  ieee_site_add (entry, IEEE_SUBNORMAL_SAMPLES, 1);
+  ieee_site_add (entry, IEEE_SUBNORMAL_CYCLES,
+                 _vieee_subnormal_time (kernel, a, b, context));
+  ieee_site_add (entry, IEEE_SUBNORMAL_REFERENCE_CYCLES,
+                 _vieee_subnormal_time (kernel, ones, ones, context));
+}
+
+#define DEFINE_SUBNORMAL_KERNEL(OP, OPCODE, N)                                 \
+  static void _vieee_##OP##_float_##N##_subnormal(                             \
+      float *a, float *b, float *c, void *context) {                           \
+    const void *site = IEEE_CALL_SITE ();                                      \
+    const void *outer = ieee_site_caller;                                      \
+    /* c may alias a or b */                                                   \
+    const uint32_t in =                                                        \
+        _vieee_subnormal_lanes (a, N) | _vieee_subnormal_lanes (b, N);         \
+    ieee_site_caller = site;                                                   \
+    vieee_subnormal.OP.op_vector_float_##N (a, b, c, context);                 \
+    ieee_site_caller = outer;                                                  \
+    const uint32_t out = _vieee_subnormal_lanes (c, N);                        \
+    if (__builtin_expect ((in | out) != 0, 0))                                 \
+      _vieee_subnormal_record (context, site, OPCODE, in, out, a, b, c, N,     \
+                               vieee_subnormal_base.OP.op_vector_float_##N);   \
+  }
+
+#define DEFINE_SUBNORMAL_KERNELS(OP, OPCODE)                                   \
+  DEFINE_SUBNORMAL_KERNEL(OP, OPCODE, 1)                                       \
+  DEFINE_SUBNORMAL_KERNEL(OP, OPCODE, 4)                                       \
+  DEFINE_SUBNORMAL_KERNEL(OP, OPCODE, 8)                                       \
+  DEFINE_SUBNORMAL_KERNEL(OP, OPCODE, 16)
+
+DEFINE_SUBNORMAL_KERNELS(add, IEEE_TRACE_ADD)
+DEFINE_SUBNORMAL_KERNELS(sub, IEEE_TRACE_SUB)
+DEFINE_SUBNORMAL_KERNELS(mul, IEEE_TRACE_MUL)
+DEFINE_SUBNORMAL_KERNELS(div, IEEE_TRACE_DIV)
+
+#define SUBNORMAL_OP(OP)                                                       \
+  {                                                                            \
+    op_vector_float_1 : _vieee_##OP##_float_1_subnormal,                       \
+    op_vector_float_4 : _vieee_##OP##_float_4_subnormal,                       \
+    op_vector_float_8 : _vieee_##OP##_float_8_subnormal,                       \
+    op_vector_float_16 : _vieee_##OP##_float_16_subnormal                      \
+  }
+
+/* Returns the subnormal profiling table wrapping <vbackend>, sampled */
+/* calls being replayed with the kernels of <base>                     */
+static struct interflop_vector_type_t
+_vieee_init_subnormal(struct interflop_vector_type_t vbackend,
+                      struct interflop_vector_type_t base) {
+  vieee_subnormal = vbackend;
+  vieee_subnormal_base = base;
+  struct interflop_vector_type_t subnormal = {
+    add : SUBNORMAL_OP(add),
+    sub : SUBNORMAL_OP(sub),
+    mul : SUBNORMAL_OP(mul),
+    div : SUBNORMAL_OP(div)
+  };
+  return subnormal;
+}
+
+/* Kernels used with --vector-coverage. They count the call and its lanes   */
+/* per call site, then run the kernel of the table they replace as a tail  */
+/* call, so that the profiling kernels under them see the same call site.  */
+static struct interflop_vector_type_t vieee_covered;
+
+#define DEFINE_COVERAGE_KERNEL(OP, OPCODE, N)                                  \
+  static void _vieee_##OP##_float_##N##_coverage(float *a, float *b, float *c, \
+                                                 void *context) {              \
+    ieee_context_t *ctx = (ieee_context_t *)context;                           \
+    ieee_site_t *entry = ieee_site_lookup (                                    \
+        ctx->vector_sites,                                                     \
+        ieee_site_key (IEEE_CALL_SITE (), OPCODE, IEEE_TRACE_FLOAT));          \
+    ieee_site_add (entry, IEEE_COVERAGE_OPS, N);                               \
+    ieee_site_add (entry, IEEE_COVERAGE_VECTOR_##N, 1);                        \
+    vieee_covered.OP.op_vector_float_##N (a, b, c, context);                   \
+  }
+
+#define DEFINE_COVERAGE_KERNELS(OP, OPCODE)                                    \
+  DEFINE_COVERAGE_KERNEL(OP, OPCODE, 1)                                        \
+  DEFINE_COVERAGE_KERNEL(OP, OPCODE, 4)                                        \
+  DEFINE_COVERAGE_KERNEL(OP, OPCODE, 8)                                        \
+  DEFINE_COVERAGE_KERNEL(OP, OPCODE, 16)
+
+DEFINE_COVERAGE_KERNELS(add, IEEE_TRACE_ADD)
+DEFINE_COVERAGE_KERNELS(sub, IEEE_TRACE_SUB)
+DEFINE_COVERAGE_KERNELS(mul, IEEE_TRACE_MUL)
+DEFINE_COVERAGE_KERNELS(div, IEEE_TRACE_DIV)
+
+#define COVERAGE_OP(OP)                                                        \
+  {                                                                            \
+    op_vector_float_1 : _vieee_##OP##_float_1_coverage,                        \
+    op_vector_float_4 : _vieee_##OP##_float_4_coverage,                        \
+    op_vector_float_8 : _vieee_##OP##_float_8_coverage,                        \
+    op_vector_float_16 : _vieee_##OP##_float_16_coverage                       \
+  }
+
+/* Returns the coverage table wrapping <vbackend> */
+static struct interflop_vector_type_t
+_vieee_init_coverage(struct interflop_vector_type_t vbackend) {
+  vieee_covered = vbackend;
+  struct interflop_vector_type_t coverage = {
+    add : COVERAGE_OP(add),
+    sub : COVERAGE_OP(sub),
+    mul : COVERAGE_OP(mul),
+    div : COVERAGE_OP(div)
+  };
+  return coverage;
+}
+
+/* Kernels used with --roi. Outside the region of interest they run the */
+/* kernels of the floating-point environment, as the scalar dispatchers  */
+/* follow the bare table, so that the wrappers under them cost nothing  */
+static struct interflop_vector_type_t vieee_roi;
+static struct interflop_vector_type_t vieee_roi_base;
+
+#define DEFINE_ROI_KERNEL(OP, N)                                               \
+  static void _vieee_##OP##_float_##N##_roi(float *a, float *b, float *c,      \
+                                            void *context) {                   \
+    const ieee_context_t *ctx = (const ieee_context_t *)context;               \
+    if (__atomic_load_n (&ctx->roi_active, __ATOMIC_RELAXED))                  \
+      vieee_roi.OP.op_vector_float_##N (a, b, c, context);                     \
+    else                                                                       \
+      vieee_roi_base.OP.op_vector_float_##N (a, b, c, context);                \
+  }
+
+#define DEFINE_ROI_KERNELS(OP)                                                 \
+  DEFINE_ROI_KERNEL(OP, 1)                                                     \
+  DEFINE_ROI_KERNEL(OP, 4)                                                     \
+  DEFINE_ROI_KERNEL(OP, 8)                                                     \
+  DEFINE_ROI_KERNEL(OP, 16)
+
+DEFINE_ROI_KERNELS(add)
+DEFINE_ROI_KERNELS(sub)
+DEFINE_ROI_KERNELS(mul)
+DEFINE_ROI_KERNELS(div)
+
+#define ROI_OP(OP)                                                             \
+  {                                                                            \
+    op_vector_float_1 : _vieee_##OP##_float_1_roi,                             \
+    op_vector_float_4 : _vieee_##OP##_float_4_roi,                             \
+    op_vector_float_8 : _vieee_##OP##_float_8_roi,                             \
+    op_vector_float_16 : _vieee_##OP##_float_16_roi                            \
+  }
+
+/* Returns the region of interest table running <vbackend> in the region */
+/* and <base> elsewhere                                                  */
+static struct interflop_vector_type_t
+_vieee_init_roi(struct interflop_vector_type_t vbackend,
+                struct interflop_vector_type_t base) {
+  vieee_roi = vbackend;
+  vieee_roi_base = base;
+  struct interflop_vector_type_t roi = {
+    add : ROI_OP(add),
+    sub : ROI_OP(sub),
+    mul : ROI_OP(mul),
+    div : ROI_OP(div)
+  };
+  return roi;
+}
+
+/* Kernels used with --overhead-profile. They time the sampled calls of */
+/* the kernels of the table they replace, see common/overhead.h         */
+static struct interflop_vector_type_t vieee_timed;
+
+#define DEFINE_TIMED_KERNEL(OP, OPCODE, N)                                     \
+  static void _vieee_##OP##_float_##N##_timed(float *a, float *b, float *c,    \
+                                              void *context) {                 \
+    if (!ieee_overhead_sample ()) {                                            \
+      vieee_timed.OP.op_vector_float_##N (a, b, c, context);                   \
+      return;                                                                  \
+    }                                                                          \
+    ieee_site_caller = IEEE_CALL_SITE ();                                      \
+    const uint64_t start = ieee_overhead_clock ();                             \
+    vieee_timed.OP.op_vector_float_##N (a, b, c, context);                     \
+    const uint64_t stop = ieee_overhead_clock ();                              \
+    ieee_site_caller = NULL;                                                   \
+    ieee_overhead_record (ieee_stream_vector (OPCODE, N), stop - start);       \
+  }
+
+#define DEFINE_TIMED_KERNELS(OP, OPCODE)                                       \
+  DEFINE_TIMED_KERNEL(OP, OPCODE, 1)                                           \
+  DEFINE_TIMED_KERNEL(OP, OPCODE, 4)                                           \
+  DEFINE_TIMED_KERNEL(OP, OPCODE, 8)                                           \
+  DEFINE_TIMED_KERNEL(OP, OPCODE, 16)
+
+DEFINE_TIMED_KERNELS(add, IEEE_TRACE_ADD)
+DEFINE_TIMED_KERNELS(sub, IEEE_TRACE_SUB)
+DEFINE_TIMED_KERNELS(mul, IEEE_TRACE_MUL)
+DEFINE_TIMED_KERNELS(div, IEEE_TRACE_DIV)
+
+#define TIMED_OP(OP)                                                           \
+  {                                                                            \
+    op_vector_float_1 : _vieee_##OP##_float_1_timed,                           \
+    op_vector_float_4 : _vieee_##OP##_float_4_timed,                           \
+    op_vector_float_8 : _vieee_##OP##_float_8_timed,                           \
+    op_vector_float_16 : _vieee_##OP##_float_16_timed                          \
+  }
+
+/* Returns the timing table wrapping <vbackend> */
+static struct interflop_vector_type_t
+_vieee_init_timed(struct interflop_vector_type_t vbackend) {
+  vieee_timed = vbackend;
+  struct interflop_vector_type_t timed = {
+    add : TIMED_OP(add),
+    sub : TIMED_OP(sub),
+    mul : TIMED_OP(mul),
+    div : TIMED_OP(div)
+  };
+  return timed;
+}
+
+/* Kernels used with --fingerprint. They run the kernels of the table they  */
+/* replace, then fold the result of each lane in the hash of the lane (see */
+/* common/fingerprint.h), 8, 4 or 2 64-bit lanes per instruction.          */
+static struct interflop_vector_type_t vieee_fingerprinted;
+
+/* Hashes the lanes [i, n) of <c> one by one */
+static inline void _vieee_hash_tail(uint64_t *lanes, const float *c, int i,
+                                    int n) {
+  for (; i < n; i++) {
+    uint32_t bits;
+    memcpy(&bits, &c[i], sizeof(bits));
+    lanes[i] = (lanes[i] ^ bits) * IEEE_FINGERPRINT_MULTIPLIER;
+  }
+}
+
+#if defined (__AVX2__) && !defined (__AVX512F__)
+/* Low 64 bits of the products of the lanes of <a> and <m> */
+static inline __m256i _vieee_mul64_4(__m256i a, __m256i m) {
+  const __m256i lo = _mm256_mul_epu32(a, m);
+  const __m256i cross =
+      _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(a, 32), m),
+                       _mm256_mul_epu32(a, _mm256_srli_epi64(m, 32)));
+  return _mm256_add_epi64(lo, _mm256_slli_epi64(cross, 32));
+}
+#elif defined (__SSE2__) && !defined (__AVX512F__)
+static inline __m128i _vieee_mul64_2(__m128i a, __m128i m) {
+  const __m128i lo = _mm_mul_epu32(a, m);
+  const __m128i cross = _mm_add_epi64(_mm_mul_epu32(_mm_srli_epi64(a, 32), m),
+                                      _mm_mul_epu32(a, _mm_srli_epi64(m, 32)));
+  return _mm_add_epi64(lo, _mm_slli_epi64(cross, 32));
+}
+#endif
+
+/* Hashes the <n> lanes of <c> in <lanes>, aligned on 64 bytes */
+static inline void _vieee_hash_lanes(uint64_t *lanes, const float *c, int n) {
+  int i = 0;
+#if defined (__AVX512F__)
+  const __m512i m = _mm512_set1_epi64(IEEE_FINGERPRINT_MULTIPLIER);
+  for (; i + 8 <= n; i += 8) {
+    const __m512i x =
+        _mm512_cvtepu32_epi64(_mm256_loadu_si256((const __m256i *)(c + i)));
+    const __m512i h = _mm512_load_si512(lanes + i);
+    _mm512_store_si512(lanes + i,
+                       _mm512_mullox_epi64(_mm512_xor_si512(h, x), m));
+  }
+#elif defined (__AVX2__)
+  const __m256i m = _mm256_set1_epi64x(IEEE_FINGERPRINT_MULTIPLIER);
+  for (; i + 4 <= n; i += 4) {
+    const __m256i x =
+        _mm256_cvtepu32_epi64(_mm_loadu_si128((const __m128i *)(c + i)));
+    const __m256i h = _mm256_load_si256((const __m256i *)(lanes + i));
+    _mm256_store_si256((__m256i *)(lanes + i),
+                       _vieee_mul64_4(_mm256_xor_si256(h, x), m));
+  }
+#elif defined (__SSE2__)
+  const __m128i m = _mm_set1_epi64x(IEEE_FINGERPRINT_MULTIPLIER);
+  for (; i + 2 <= n; i += 2) {
+    const __m128i x = _mm_unpacklo_epi32(
+        _mm_loadl_epi64((const __m128i *)(c + i)), _mm_setzero_si128());
+    const __m128i h = _mm_load_si128((const __m128i *)(lanes + i));
+    _mm_store_si128((__m128i *)(lanes + i),
+                    _vieee_mul64_2(_mm_xor_si128(h, x), m));
+  }
+#endif
+  _vieee_hash_tail(lanes, c, i, n);
+}
+
+#define DEFINE_FINGERPRINT_KERNEL(OP, OPCODE, N)                               \
+  static void _vieee_##OP##_float_##N##_fingerprint(                           \
+      float *a, float *b, float *c, void *context) {                           \
+    vieee_fingerprinted.OP.op_vector_float_##N (a, b, c, context);             \
+    const unsigned stream = ieee_stream_vector (OPCODE, N);                    \
+    ieee_fingerprint_thread_t *thread;                                         \
+    ieee_fingerprint_stream_t *s = ieee_fingerprint_stream (&thread, stream);  \
+    _vieee_hash_lanes (s->lanes, c, N);                                        \
+    ieee_fingerprint_count (thread, stream, N);                                \
+  }
+
+#define DEFINE_FINGERPRINT_KERNELS(OP, OPCODE)                                 \
+  DEFINE_FINGERPRINT_KERNEL(OP, OPCODE, 1)                                     \
+  DEFINE_FINGERPRINT_KERNEL(OP, OPCODE, 4)                                     \
+  DEFINE_FINGERPRINT_KERNEL(OP, OPCODE, 8)                                     \
+  DEFINE_FINGERPRINT_KERNEL(OP, OPCODE, 16)
+
+DEFINE_FINGERPRINT_KERNELS(add, IEEE_TRACE_ADD)
+DEFINE_FINGERPRINT_KERNELS(sub, IEEE_TRACE_SUB)
+DEFINE_FINGERPRINT_KERNELS(mul, IEEE_TRACE_MUL)
+DEFINE_FINGERPRINT_KERNELS(div, IEEE_TRACE_DIV)
+
+#define FINGERPRINT_OP(OP)                                                     \
+  {                                                                            \
+    op_vector_float_1 : _vieee_##OP##_float_1_fingerprint,                     \
+    op_vector_float_4 : _vieee_##OP##_float_4_fingerprint,                     \
+    op_vector_float_8 : _vieee_##OP##_float_8_fingerprint,                     \
+    op_vector_float_16 : _vieee_##OP##_float_16_fingerprint                    \
+  }
+
+/* Returns the fingerprint table wrapping <vbackend> */
+static struct interflop_vector_type_t
+_vieee_init_fingerprint(struct interflop_vector_type_t vbackend) {
+  vieee_fingerprinted = vbackend;
+  struct interflop_vector_type_t fingerprint = {
+    add : FINGERPRINT_OP(add),
+    sub : FINGERPRINT_OP(sub),
+    mul : FINGERPRINT_OP(mul),
+    div : FINGERPRINT_OP(div)
+  };
+  return fingerprint;
+}
+
+/* Returns the table of the floating-point environment of the options */
+static struct interflop_vector_type_t
+_vieee_init_table(const ieee_context_t *ctx) {
+  if (ctx != NULL &&
+      (ctx->rounding != IEEE_ROUND_NEAREST || ctx->ftz_daz || ctx->trap)) {
+    return _vieee_init_fpenv(ctx);
+  }
+
   struct interflop_vector_type_t vbackend = {
     add : {
       op_vector_float_1 : INTERFLOP_VECTOR_IEEE_API(add_float_1),
@@ -540,4 +1395,37 @@ struct interflop_vector_type_t INTERFLOP_VECTOR_IEEE_API(init)(void *context)
     }
   };
   return vbackend;
-}
\ No newline at end of file
+}
+
+struct interflop_vector_type_t INTERFLOP_VECTOR_IEEE_API(init)(void *context)
+{
+  const ieee_context_t *ctx = (const ieee_context_t *)context;
+  const struct interflop_vector_type_t base = _vieee_init_table(ctx);
+  struct interflop_vector_type_t vbackend = base;
+  vieee_n_wrapped =
+      ctx != NULL &&
+      (ctx->rounding != IEEE_ROUND_NEAREST || ctx->ftz_daz || ctx->trap ||
+       ctx->fingerprint || ctx->precision_profile || ctx->subnormal_profile ||
+       ctx->vector_coverage || ctx->roi || ctx->overhead_profile);
+  /* Innermost, it does not tail-call the kernel it wraps */
+  if (ctx != NULL && ctx->fingerprint) {
+    vbackend = _vieee_init_fingerprint(vbackend);
+  }
+  if (ctx != NULL && ctx->precision_profile) {
+    vbackend = _vieee_init_profile(vbackend);
+  }
+  if (ctx != NULL && ctx->subnormal_profile) {
+    vbackend = _vieee_init_subnormal(vbackend, base);
+  }
+  if (ctx != NULL && ctx->vector_coverage) {
+    vbackend = _vieee_init_coverage(vbackend);
+  }
+  if (ctx != NULL && ctx->roi) {
+    vbackend = _vieee_init_roi(vbackend, base);
+  }
+  if (ctx != NULL && ctx->overhead_profile) {
+    vbackend = _vieee_init_timed(vbackend);
+  }
+  vieee_n_table = vbackend;
+  return vbackend;
+}
@@ -41,6 +41,16 @@ void INTERFLOP_VECTOR_IEEE_API(div_float_8)(float *a, float *b, float *c,
                                           void *context);
 void INTERFLOP_VECTOR_IEEE_API(div_float_16)(float *a, float *b, float *c,
                                           void *context);
+
+/* Any number of lanes <n> up to 16, no access outside [0, n) */
+void INTERFLOP_VECTOR_IEEE_API(add_float_n)(float *a, float *b, float *c,
+                                            int n, void *context);
+void INTERFLOP_VECTOR_IEEE_API(sub_float_n)(float *a, float *b, float *c,
+                                            int n, void *context);
+void INTERFLOP_VECTOR_IEEE_API(mul_float_n)(float *a, float *b, float *c,
+                                            int n, void *context);
+void INTERFLOP_VECTOR_IEEE_API(div_float_n)(float *a, float *b, float *c,
+                                            int n, void *context);
 /*
 void INTERFLOP_VECTOR_IEEE_API(add_double_1)(double *a, double *b, double *c,
                                           void *context);